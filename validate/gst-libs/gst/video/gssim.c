@@ -23,11 +23,33 @@
 #include <glib.h>
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "gssim.h"
 
+#if defined (__GNUC__) && (defined (__x86_64__) || defined (__i386__))
+#define GSSIM_HAVE_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
 typedef gfloat (*SSimWeightFunc) (Gssim * self, gint y, gint x);
 
+/* dst[i] += a * src[i] for i in [0, n) */
+typedef void (*SSimAxpyFunc) (gfloat * dst, const gfloat * src, gfloat a,
+    gint n);
+
+/* Planes filtered by the separable engine, all centered on 128 so that the
+ * squares stay small enough for single precision accumulation */
+enum
+{
+  SSIM_PLANE_ORG,
+  SSIM_PLANE_MOD,
+  SSIM_PLANE_ORG2,
+  SSIM_PLANE_MOD2,
+  SSIM_PLANE_ORGMOD,
+  SSIM_N_PLANES
+};
+
 typedef struct _SSimWindowCache
 {
   gint x_window_start;
@@ -53,6 +75,16 @@ struct _GssimPrivate
 
   gfloat *orgmu;
 
+  /* Separable engine */
+  GssimEngine engine;
+  SSimAxpyFunc axpy;
+  gint half;
+  gfloat *kernel;
+  gfloat *x_used, *x_summ;
+  gfloat *y_used, *y_summ;
+  gfloat *filtered;
+  gfloat *rows;
+
   GstVideoConverter *converter;
   GstVideoInfo in_info, out_info;
 };
@@ -233,16 +265,11 @@ gssim_regenerate_windows (Gssim * self)
     }
   }
 
-  /* FIXME: while 0.01 and 0.03 are pretty much static, the 255 implies that
-   * we're working with 8-bit-per-color-component format, which may not be true
-   */
-  self->priv->const1 = 0.01 * 255 * 0.01 * 255;
-  self->priv->const2 = 0.03 * 255 * 0.03 * 255;
   return TRUE;
 }
 
-void
-gssim_compare (Gssim * self, guint8 * org, guint8 * mod,
+static void
+gssim_compare_reference (Gssim * self, guint8 * org, guint8 * mod,
     guint8 * out, gfloat * mean, gfloat * lowest, gfloat * highest)
 {
   gint oy, ox, iy, ix;
@@ -364,6 +391,336 @@ gssim_compare (Gssim * self, guint8 * org, guint8 * mod,
   *mean = cumulative_ssim / (self->priv->width * self->priv->height);
 }
 
+static void
+ssim_axpy_scalar (gfloat * dst, const gfloat * src, gfloat a, gint n)
+{
+  gint i;
+
+  for (i = 0; i < n; i++)
+    dst[i] += a * src[i];
+}
+
+#ifdef GSSIM_HAVE_X86_DISPATCH
+__attribute__ ((target ("sse4.1")))
+static void
+ssim_axpy_sse4_1 (gfloat * dst, const gfloat * src, gfloat a, gint n)
+{
+  gint i = 0;
+  __m128 va = _mm_set1_ps (a);
+
+  for (; i + 4 <= n; i += 4) {
+    __m128 d = _mm_loadu_ps (dst + i);
+
+    d = _mm_add_ps (d, _mm_mul_ps (va, _mm_loadu_ps (src + i)));
+    _mm_storeu_ps (dst + i, d);
+  }
+
+  for (; i < n; i++)
+    dst[i] += a * src[i];
+}
+
+__attribute__ ((target ("avx2,fma")))
+static void
+ssim_axpy_avx2 (gfloat * dst, const gfloat * src, gfloat a, gint n)
+{
+  gint i = 0;
+  __m256 va = _mm256_set1_ps (a);
+
+  for (; i + 8 <= n; i += 8)
+    _mm256_storeu_ps (dst + i, _mm256_fmadd_ps (va, _mm256_loadu_ps (src + i),
+            _mm256_loadu_ps (dst + i)));
+
+  for (; i < n; i++)
+    dst[i] += a * src[i];
+}
+#endif
+
+static SSimAxpyFunc
+gssim_engine_get_axpy (GssimEngine engine)
+{
+  switch (engine) {
+    case GSSIM_ENGINE_SCALAR:
+      return ssim_axpy_scalar;
+#ifdef GSSIM_HAVE_X86_DISPATCH
+    case GSSIM_ENGINE_SSE4_1:
+      if (__builtin_cpu_supports ("sse4.1"))
+        return ssim_axpy_sse4_1;
+      break;
+    case GSSIM_ENGINE_AVX2:
+      if (__builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("fma"))
+        return ssim_axpy_avx2;
+      break;
+#endif
+    default:
+      break;
+  }
+
+  return NULL;
+}
+
+/* Sums of the 1D kernel for each position along one axis: @used only
+ * accounts for the taps that fall inside the image, @summ reproduces the
+ * reference engine normalisation, which sums from the first valid tap up to
+ * the end of the kernel. */
+static void
+gssim_compute_kernel_summs (Gssim * self, gint length, gfloat * used,
+    gfloat * summ)
+{
+  gint i, k;
+
+  for (i = 0; i < length; i++) {
+    used[i] = summ[i] = 0;
+
+    for (k = 0; k < self->priv->windowsize; k++) {
+      gint pos = i + k - self->priv->half;
+
+      if (pos >= 0 && pos < length)
+        used[i] += self->priv->kernel[k];
+      if (pos >= 0)
+        summ[i] += self->priv->kernel[k];
+    }
+  }
+}
+
+/* The 2D weights of the reference engine are the product of two 1D
+ * gaussians (times a constant which cancels out), so the window sums can be
+ * computed with one horizontal and one vertical pass of the 1D kernel. */
+static void
+gssim_regenerate_kernel (Gssim * self)
+{
+  GssimPrivate *priv = self->priv;
+  gint windowiseven = (priv->windowsize / 2) * 2 == priv->windowsize ? 1 : 0;
+  gint k;
+
+  priv->half = priv->windowsize / 2 - windowiseven;
+
+  g_free (priv->kernel);
+  priv->kernel = g_new (gfloat, priv->windowsize);
+  for (k = 0; k < priv->windowsize; k++) {
+    gfloat coord = k - priv->half;
+
+    if (priv->windowtype == 0)
+      priv->kernel[k] = 1;
+    else
+      priv->kernel[k] = exp (-1 * (coord * coord) / (2 * priv->sigma *
+              priv->sigma));
+  }
+
+  g_free (priv->x_used);
+  priv->x_used = g_new (gfloat, 2 * priv->width);
+  priv->x_summ = priv->x_used + priv->width;
+  gssim_compute_kernel_summs (self, priv->width, priv->x_used, priv->x_summ);
+
+  g_free (priv->y_used);
+  priv->y_used = g_new (gfloat, 2 * priv->height);
+  priv->y_summ = priv->y_used + priv->height;
+  gssim_compute_kernel_summs (self, priv->height, priv->y_used, priv->y_summ);
+
+  g_free (priv->filtered);
+  priv->filtered = g_new (gfloat, SSIM_N_PLANES * priv->width * priv->height);
+
+  g_free (priv->rows);
+  priv->rows = g_new (gfloat, SSIM_N_PLANES * priv->width);
+}
+
+static gfloat
+gssim_filter_clipped (Gssim * self, const gfloat * src, gint x)
+{
+  gint k;
+  gfloat res = 0;
+
+  for (k = 0; k < self->priv->windowsize; k++) {
+    gint pos = x + k - self->priv->half;
+
+    if (pos >= 0 && pos < self->priv->width)
+      res += self->priv->kernel[k] * src[pos];
+  }
+
+  return res;
+}
+
+static void
+gssim_filter_row (Gssim * self, gfloat * dst, const gfloat * src)
+{
+  GssimPrivate *priv = self->priv;
+  gint first = priv->half;
+  gint last = priv->width - priv->windowsize + priv->half;
+  gint x, k;
+
+  if (last < first) {
+    for (x = 0; x < priv->width; x++)
+      dst[x] = gssim_filter_clipped (self, src, x);
+
+    return;
+  }
+
+  for (x = 0; x < first; x++)
+    dst[x] = gssim_filter_clipped (self, src, x);
+
+  memset (dst + first, 0, (last - first + 1) * sizeof (gfloat));
+  for (k = 0; k < priv->windowsize; k++)
+    priv->axpy (dst + first, src + first + k - priv->half, priv->kernel[k],
+        last - first + 1);
+
+  for (x = last + 1; x < priv->width; x++)
+    dst[x] = gssim_filter_clipped (self, src, x);
+}
+
+static void
+gssim_compare_separable (Gssim * self, guint8 * org, guint8 * mod,
+    guint8 * out, gfloat * mean, gfloat * lowest, gfloat * highest)
+{
+  GssimPrivate *priv = self->priv;
+  gint width = priv->width, height = priv->height;
+  gsize plane_size = (gsize) width * height;
+  gfloat *rows;
+  gdouble cumulative_ssim = 0;
+  gint x, y, k, i;
+
+  *lowest = G_MAXFLOAT;
+  *highest = -G_MAXFLOAT;
+
+  if (priv->kernel == NULL)
+    gssim_regenerate_kernel (self);
+  rows = priv->rows;
+
+  /* Horizontal pass */
+  for (y = 0; y < height; y++) {
+    guint8 *org_row = &org[y * width], *mod_row = &mod[y * width];
+
+    for (x = 0; x < width; x++) {
+      gfloat o = org_row[x] - 128.f, m = mod_row[x] - 128.f;
+
+      rows[SSIM_PLANE_ORG * width + x] = o;
+      rows[SSIM_PLANE_MOD * width + x] = m;
+      rows[SSIM_PLANE_ORG2 * width + x] = o * o;
+      rows[SSIM_PLANE_MOD2 * width + x] = m * m;
+      rows[SSIM_PLANE_ORGMOD * width + x] = o * m;
+    }
+
+    for (i = 0; i < SSIM_N_PLANES; i++)
+      gssim_filter_row (self, &priv->filtered[i * plane_size + y * width],
+          &rows[i * width]);
+  }
+
+  /* Vertical pass, one output row at a time, and SSIM of that row */
+  for (y = 0; y < height; y++) {
+    memset (rows, 0, SSIM_N_PLANES * width * sizeof (gfloat));
+
+    for (k = 0; k < priv->windowsize; k++) {
+      gint pos = y + k - priv->half;
+
+      if (pos < 0 || pos >= height)
+        continue;
+
+      for (i = 0; i < SSIM_N_PLANES; i++)
+        priv->axpy (&rows[i * width],
+            &priv->filtered[i * plane_size + pos * width], priv->kernel[k],
+            width);
+    }
+
+    for (x = 0; x < width; x++) {
+      gfloat elsumm = priv->x_summ[x] * priv->y_summ[y];
+      gfloat used = priv->x_used[x] * priv->y_used[y];
+      gfloat f_o = rows[SSIM_PLANE_ORG * width + x];
+      gfloat f_m = rows[SSIM_PLANE_MOD * width + x];
+      gfloat mu_o, mu_m, d_o, d_m;
+      gfloat sigma_o, sigma_m, sigma_om, res;
+
+      mu_o = (f_o + 128.f * used) / elsumm;
+      mu_m = (f_m + 128.f * used) / elsumm;
+
+      /* Means in the centered domain, to expand sum (w * (v - mu)^2) */
+      d_o = mu_o - 128.f;
+      d_m = mu_m - 128.f;
+
+      sigma_o = (rows[SSIM_PLANE_ORG2 * width + x] - 2 * d_o * f_o +
+          d_o * d_o * used) / elsumm;
+      sigma_m = (rows[SSIM_PLANE_MOD2 * width + x] - 2 * d_m * f_m +
+          d_m * d_m * used) / elsumm;
+      sigma_om = (rows[SSIM_PLANE_ORGMOD * width + x] - d_m * f_o -
+          d_o * f_m + d_o * d_m * used) / elsumm;
+
+      /* Rounding can make a flat area slightly negative */
+      sigma_o = MAX (sigma_o, 0);
+      sigma_m = MAX (sigma_m, 0);
+
+      res = (2 * mu_o * mu_m + priv->const1) * (2 * sigma_om +
+          priv->const2) / ((mu_o * mu_o + mu_m * mu_m + priv->const1) *
+          (sigma_o + sigma_m + priv->const2));
+
+      if (out)
+        out[y * width + x] = 127 + res * 128;
+      *lowest = MIN (*lowest, res);
+      *highest = MAX (*highest, res);
+      cumulative_ssim += res;
+    }
+  }
+
+  *mean = cumulative_ssim / plane_size;
+}
+
+void
+gssim_compare (Gssim * self, guint8 * org, guint8 * mod,
+    guint8 * out, gfloat * mean, gfloat * lowest, gfloat * highest)
+{
+  if (self->priv->engine == GSSIM_ENGINE_REFERENCE)
+    gssim_compare_reference (self, org, mod, out, mean, lowest, highest);
+  else
+    gssim_compare_separable (self, org, mod, out, mean, lowest, highest);
+}
+
+/**
+ * gssim_set_engine:
+ * @self: a #Gssim
+ * @engine: the #GssimEngine to use
+ *
+ * Selects the implementation used by gssim_compare().
+ * #GSSIM_ENGINE_AUTO picks the fastest one supported by the running CPU.
+ *
+ * Returns: %FALSE if @engine is not supported on this machine, in which case
+ * the current engine is kept.
+ */
+gboolean
+gssim_set_engine (Gssim * self, GssimEngine engine)
+{
+  SSimAxpyFunc axpy = NULL;
+
+  if (engine == GSSIM_ENGINE_AUTO) {
+    GssimEngine candidates[] = { GSSIM_ENGINE_AVX2, GSSIM_ENGINE_SSE4_1,
+      GSSIM_ENGINE_SCALAR
+    };
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (candidates) && !axpy; i++) {
+      engine = candidates[i];
+      axpy = gssim_engine_get_axpy (engine);
+    }
+  } else if (engine != GSSIM_ENGINE_REFERENCE) {
+    axpy = gssim_engine_get_axpy (engine);
+    if (!axpy)
+      return FALSE;
+  }
+
+  self->priv->engine = engine;
+  self->priv->axpy = axpy;
+
+  return TRUE;
+}
+
+/**
+ * gssim_get_engine:
+ * @self: a #Gssim
+ *
+ * Returns: The #GssimEngine used by gssim_compare(), never
+ * #GSSIM_ENGINE_AUTO.
+ */
+GssimEngine
+gssim_get_engine (Gssim * self)
+{
+  return self->priv->engine;
+}
+
 gboolean
 gssim_configure (Gssim * self, gint width, gint height)
 {
@@ -376,6 +733,9 @@ gssim_configure (Gssim * self, gint width, gint height)
   g_free (self->priv->windows);
   self->priv->windows = NULL;
 
+  g_free (self->priv->kernel);
+  self->priv->kernel = NULL;
+
   g_free (self->priv->orgmu);
   self->priv->orgmu = g_new (gfloat, width * height);
 
@@ -417,6 +777,12 @@ gssim_finalize (GObject * object)
 
   g_free (self->priv->orgmu);
   g_free (self->priv->windows);
+  g_free (self->priv->weights);
+  g_free (self->priv->kernel);
+  g_free (self->priv->x_used);
+  g_free (self->priv->y_used);
+  g_free (self->priv->filtered);
+  g_free (self->priv->rows);
 
   chain_up (object);
 }
@@ -440,6 +806,14 @@ gssim_init (Gssim * self)
   self->priv->windowtype = 1;
   self->priv->windows = NULL;
   self->priv->sigma = 1.5;
+
+  /* FIXME: while 0.01 and 0.03 are pretty much static, the 255 implies that
+   * we're working with 8-bit-per-color-component format, which may not be true
+   */
+  self->priv->const1 = 0.01 * 255 * 0.01 * 255;
+  self->priv->const2 = 0.03 * 255 * 0.03 * 255;
+
+  gssim_set_engine (self, GSSIM_ENGINE_AUTO);
 }
 
 Gssim *
@@ -32,6 +32,23 @@ G_BEGIN_DECLS
 
 typedef struct _GssimPrivate GssimPrivate;
 
+/**
+ * GssimEngine:
+ * @GSSIM_ENGINE_AUTO: Use the fastest engine supported by the CPU
+ * @GSSIM_ENGINE_REFERENCE: Naive implementation computing every window
+ * independently, slow but kept as a reference
+ * @GSSIM_ENGINE_SCALAR: Separable filtering engine, portable C
+ * @GSSIM_ENGINE_SSE4_1: Separable filtering engine, SSE4.1 row kernels
+ * @GSSIM_ENGINE_AVX2: Separable filtering engine, AVX2/FMA row kernels
+ */
+typedef enum {
+  GSSIM_ENGINE_AUTO,
+  GSSIM_ENGINE_REFERENCE,
+  GSSIM_ENGINE_SCALAR,
+  GSSIM_ENGINE_SSE4_1,
+  GSSIM_ENGINE_AVX2,
+} GssimEngine;
+
 typedef struct {
   GstObject parent;
 
@@ -56,6 +73,8 @@ void gssim_compare       (Gssim * self, guint8 * org, guint8 * mod,
                           guint8 * out, gfloat * mean, gfloat * lowest,
                           gfloat * highest);
 gboolean gssim_configure (Gssim * self, gint width, gint height);
+gboolean gssim_set_engine (Gssim * self, GssimEngine engine);
+GssimEngine gssim_get_engine (Gssim * self);
 
 G_END_DECLS
 
@@ -30,6 +30,7 @@
 
 #include <cairo.h>
 #include <gio/gio.h>
+#include <glib/gstdio.h>
 #include <gst/gst.h>
 #include <gst/video/video.h>
 
@@ -41,6 +42,10 @@ GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
 #define GENERAL_INPUT_ERROR g_quark_from_static_string ("ssim::general-file-error")
 #define WRONG_FORMAT g_quark_from_static_string ("ssim::wrong-format")
 
+/* Sidecar file caching the timestamps of the frames of a reference folder */
+#define REF_INDEX_NAME ".gst-validate-ssim-index"
+#define REF_INDEX_HEADER "# GstValidateSsim reference index 1"
+
 enum
 {
   PROP_FIRST_PROP = 1,
@@ -70,6 +75,8 @@ struct _GstValidateSsimPrivate
   gfloat min_avg_similarity;
   gfloat min_lowest_similarity;
 
+  guint jobs;
+
   GHashTable *ref_frames_cache;
 };
 
@@ -514,12 +521,14 @@ _sort_frames (Frame * a, Frame * b)
   return 1;
 }
 
+/* @frames is sorted by timestamp. Returns the last frame with a timestamp
+ * lower or equal to @ts, or the one right after it if @get_next is %TRUE.
+ * When @ts is outside of the covered range the last frame is used. */
 static Frame *
 _find_frame (GstValidateSsim * self, GArray * frames, GstClockTime ts,
     gboolean get_next)
 {
-  guint i;
-  Frame *lframe = &g_array_index (frames, Frame, 0);
+  guint low = 0, high = frames->len;
 
   if (frames->len == 1) {
     Frame *iframe = &g_array_index (frames, Frame, 0);
@@ -530,22 +539,152 @@ _find_frame (GstValidateSsim * self, GArray * frames, GstClockTime ts,
     return NULL;
   }
 
-  for (i = 1; i < frames->len; i++) {
-    Frame *iframe = &g_array_index (frames, Frame, i);
+  if (ts < g_array_index (frames, Frame, 0).ts)
+    return &g_array_index (frames, Frame, frames->len - 1);
 
-    if (ts >= lframe->ts && iframe->ts > ts) {
-      if (get_next)
-        return iframe;
+  /* Find the first frame after @ts */
+  while (low < high) {
+    guint mid = low + (high - low) / 2;
 
-      return lframe;
-    } else if (i + 1 == frames->len) {
-      return iframe;
+    if (g_array_index (frames, Frame, mid).ts > ts)
+      high = mid;
+    else
+      low = mid + 1;
+  }
+
+  if (low == frames->len)
+    return &g_array_index (frames, Frame, frames->len - 1);
+
+  if (get_next)
+    return &g_array_index (frames, Frame, low);
+
+  return &g_array_index (frames, Frame, low - 1);
+}
+
+static GArray *
+_new_frames_array (void)
+{
+  GArray *frames = g_array_new (TRUE, TRUE, sizeof (Frame));
+
+  g_array_set_clear_func (frames, (GDestroyNotify) _free_frame);
+
+  return frames;
+}
+
+static guint64
+_get_modification_time (GFile * file)
+{
+  guint64 mtime = 0;
+  GFileInfo *info = g_file_query_info (file,
+      G_FILE_ATTRIBUTE_TIME_MODIFIED "," G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC,
+      G_FILE_QUERY_INFO_NONE, NULL, NULL);
+
+  if (info) {
+    mtime = g_file_info_get_attribute_uint64 (info,
+        G_FILE_ATTRIBUTE_TIME_MODIFIED) * G_USEC_PER_SEC +
+        g_file_info_get_attribute_uint32 (info,
+        G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+    g_object_unref (info);
+  }
+
+  return mtime;
+}
+
+/* The index is only used if it has been written after the last change in
+ * the folder, adding or removing a frame invalidates it */
+static GArray *
+_load_ref_index (GstValidateSsim * self, const gchar * ref_dir,
+    GFile * ref_dir_file)
+{
+  guint i;
+  gchar *contents = NULL, **lines = NULL;
+  GArray *frames = NULL;
+  gchar *index_path = g_build_filename (ref_dir, REF_INDEX_NAME, NULL);
+  GFile *index_file = g_file_new_for_path (index_path);
+  guint64 index_mtime = _get_modification_time (index_file);
+
+  if (!index_mtime || index_mtime < _get_modification_time (ref_dir_file))
+    goto done;
+
+  if (!g_file_get_contents (index_path, &contents, NULL, NULL))
+    goto done;
+
+  lines = g_strsplit (contents, "\n", -1);
+  if (g_strcmp0 (lines[0], REF_INDEX_HEADER)) {
+    GST_INFO_OBJECT (self, "Ignoring %s, unknown format", index_path);
+    goto done;
+  }
+
+  frames = _new_frames_array ();
+  for (i = 1; lines[i]; i++) {
+    Frame iframe;
+    gchar *end, *name;
+
+    if (!*lines[i])
+      continue;
+
+    iframe.ts = g_ascii_strtoull (lines[i], &end, 10);
+    if (*end != '\t' || !*(name = end + 1)) {
+      GST_INFO_OBJECT (self, "Ignoring %s, invalid line: %s", index_path,
+          lines[i]);
+      g_array_unref (frames);
+      frames = NULL;
+
+      goto done;
     }
 
-    lframe = iframe;
+    iframe.path = g_build_path (G_DIR_SEPARATOR_S, ref_dir, name, NULL);
+    g_array_append_val (frames, iframe);
   }
 
-  return NULL;
+  if (!frames->len) {
+    g_array_unref (frames);
+    frames = NULL;
+  }
+
+done:
+  g_strfreev (lines);
+  g_free (contents);
+  g_free (index_path);
+  g_object_unref (index_file);
+
+  return frames;
+}
+
+static void
+_save_ref_index (GstValidateSsim * self, const gchar * ref_dir,
+    GArray * frames)
+{
+  guint i;
+  GError *err = NULL;
+  gchar *index_path;
+  GString *contents;
+
+  if (!g_getenv ("GST_VALIDATE_SSIM_WRITE_REF_INDEX"))
+    return;
+
+  contents = g_string_new (REF_INDEX_HEADER "\n");
+  for (i = 0; i < frames->len; i++) {
+    Frame *iframe = &g_array_index (frames, Frame, i);
+    gchar *name = g_path_get_basename (iframe->path);
+
+    g_string_append_printf (contents, "%" G_GUINT64_FORMAT "\t%s\n",
+        iframe->ts, name);
+    g_free (name);
+  }
+
+  index_path = g_build_filename (ref_dir, REF_INDEX_NAME, NULL);
+  if (!g_file_set_contents (index_path, contents->str, contents->len, &err)) {
+    GST_INFO_OBJECT (self, "Could not write %s: %s", index_path,
+        err->message);
+    g_clear_error (&err);
+  } else {
+    /* Writing the index touched the folder, make sure the index is newer */
+    g_utime (index_path, NULL);
+  }
+
+  g_free (index_path);
+  g_string_free (contents, TRUE);
 }
 
 static GArray *
@@ -559,11 +698,15 @@ _get_ref_frame_cache (GstValidateSsim * self, const gchar * ref_file)
 
   ref_dir = g_path_get_dirname (ref_file);
 
-  frames = g_hash_table_lookup (self->priv->ref_frames_cache, ref_file);
+  frames = g_hash_table_lookup (self->priv->ref_frames_cache, ref_dir);
   if (frames)
     goto done;
 
   ref_dir_file = g_file_new_for_path (ref_dir);
+  frames = _load_ref_index (self, ref_dir, ref_dir_file);
+  if (frames)
+    goto insert;
+
   if (!(fenum = g_file_enumerate_children (ref_dir_file,
               "standard::*", G_FILE_QUERY_INFO_NONE, NULL, NULL))) {
     GST_INFO ("%s is not a folder", ref_dir);
@@ -586,20 +729,21 @@ _get_ref_frame_cache (GstValidateSsim * self, const gchar * ref_file)
 
     g_object_unref (info);
 
-    if (!frames) {
-      frames = g_array_new (TRUE, TRUE, sizeof (Frame));
-
-      g_array_set_clear_func (frames, (GDestroyNotify) _free_frame);
-    }
+    if (!frames)
+      frames = _new_frames_array ();
     g_array_append_val (frames, iframe);
   }
+  g_object_unref (fenum);
 
-  if (frames) {
-    g_array_sort (frames, (GCompareFunc) _sort_frames);
+  if (!frames)
+    goto done;
 
-    g_hash_table_insert (self->priv->ref_frames_cache, g_strdup (ref_dir),
-        frames);
-  }
+  g_array_sort (frames, (GCompareFunc) _sort_frames);
+  _save_ref_index (self, ref_dir, frames);
+
+insert:
+  g_hash_table_insert (self->priv->ref_frames_cache, g_strdup (ref_dir),
+      frames);
 
 done:
   g_clear_object (&ref_dir_file);
@@ -736,68 +880,228 @@ fail:
   goto done;
 }
 
-static gboolean
-_check_directory (GstValidateSsim * self, const gchar * ref_dir,
-    const gchar * compared_dir, gfloat * mean, gfloat * lowest,
-    gfloat * highest, const gchar * outfolder)
+typedef struct
+{
+  gchar *name;
+  gchar *ref_file;
+  gchar *compared_file;
+
+  gboolean found;
+  gboolean res;
+  gfloat mean, lowest, highest;
+
+  /* Reports emitted while comparing in a worker, replayed on the main
+   * #GstValidateSsim in order */
+  GList *reports;
+  gboolean done;
+} SSimJob;
+
+typedef struct
+{
+  const gchar *outfolder;
+
+  /* Idle worker #GstValidateSsim, each with its own #Gssim and converters */
+  GAsyncQueue *workers;
+
+  GMutex lock;
+  GCond cond;
+} SSimJobPool;
+
+static void
+_free_job (SSimJob * job)
+{
+  g_free (job->name);
+  g_free (job->ref_file);
+  g_free (job->compared_file);
+  g_list_free_full (job->reports, (GDestroyNotify) gst_validate_report_unref);
+  g_slice_free (SSimJob, job);
+}
+
+static gint
+_sort_jobs (SSimJob ** a, SSimJob ** b)
+{
+  return g_strcmp0 ((*a)->name, (*b)->name);
+}
+
+static gint
+_sort_reports (GstValidateReport * a, GstValidateReport * b)
+{
+  if (a->timestamp < b->timestamp)
+    return -1;
+
+  if (a->timestamp == b->timestamp)
+    return 0;
+
+  return 1;
+}
+
+static void
+_run_job (GstValidateSsim * self, SSimJob * job, const gchar * outfolder)
+{
+  job->found = g_file_test (job->compared_file, G_FILE_TEST_IS_REGULAR);
+  if (!job->found) {
+    GST_INFO_OBJECT (self, "Could not find file %s", job->compared_file);
+    job->res = FALSE;
+
+    return;
+  }
+
+  job->res = gst_validate_ssim_compare_image_files (self, job->ref_file,
+      job->compared_file, &job->mean, &job->lowest, &job->highest, outfolder);
+}
+
+static void
+_pool_run_job (SSimJob * job, SSimJobPool * pool)
+{
+  GstValidateSsim *worker = g_async_queue_pop (pool->workers);
+
+  _run_job (worker, job, pool->outfolder);
+
+  /* Workers have no runner, their reports are kept until the main thread
+   * forwards them, in order, to the object it runs the comparison for */
+  job->reports =
+      g_list_sort (gst_validate_reporter_get_reports (GST_VALIDATE_REPORTER
+          (worker)), (GCompareFunc) _sort_reports);
+  gst_validate_reporter_purge_reports (GST_VALIDATE_REPORTER (worker));
+
+  g_async_queue_push (pool->workers, worker);
+
+  g_mutex_lock (&pool->lock);
+  job->done = TRUE;
+  g_cond_broadcast (&pool->cond);
+  g_mutex_unlock (&pool->lock);
+}
+
+static GPtrArray *
+_list_directory_jobs (GstValidateSsim * self, const gchar * ref_dir,
+    const gchar * compared_dir)
 {
-  gint nfiles = 0, nnotfound = 0, nfailures = 0;
-  gboolean res = TRUE;
   GFileInfo *info;
   GFileEnumerator *fenum;
-  gfloat min_avg = 1.0, min_min = 1.0, total_avg = 0;
+  GPtrArray *jobs = NULL;
   GFile *file = g_file_new_for_path (ref_dir);
 
   if (!(fenum = g_file_enumerate_children (file,
               "standard::*", G_FILE_QUERY_INFO_NONE, NULL, NULL))) {
     GST_INFO ("%s is not a folder", ref_dir);
-    res = FALSE;
 
     goto done;
   }
 
+  jobs = g_ptr_array_new_with_free_func ((GDestroyNotify) _free_job);
   for (info = g_file_enumerator_next_file (fenum, NULL, NULL);
       info; info = g_file_enumerator_next_file (fenum, NULL, NULL)) {
 
-    if (g_file_info_get_file_type (info) == G_FILE_TYPE_REGULAR ||
-        g_file_info_get_file_type (info) == G_FILE_TYPE_SYMBOLIC_LINK) {
-      gchar *compared_file = g_build_path (G_DIR_SEPARATOR_S,
+    if ((g_file_info_get_file_type (info) == G_FILE_TYPE_REGULAR ||
+            g_file_info_get_file_type (info) == G_FILE_TYPE_SYMBOLIC_LINK) &&
+        g_strcmp0 (g_file_info_get_name (info), REF_INDEX_NAME)) {
+      SSimJob *job = g_slice_new0 (SSimJob);
+
+      job->name = g_strdup (g_file_info_get_display_name (info));
+      job->ref_file = g_build_path (G_DIR_SEPARATOR_S, ref_dir,
+          g_file_info_get_name (info), NULL);
+      job->compared_file = g_build_path (G_DIR_SEPARATOR_S,
           compared_dir, g_file_info_get_name (info), NULL);
-      gchar *ref_file = NULL;
 
-      if (!g_file_test (compared_file, G_FILE_TEST_IS_REGULAR)) {
-        GST_INFO_OBJECT (self, "Could not find file %s", compared_file);
-        nnotfound++;
+      g_ptr_array_add (jobs, job);
+    }
+
+    g_object_unref (info);
+  }
+
+  /* Results are reported in a stable order whatever the number of jobs */
+  g_ptr_array_sort (jobs, (GCompareFunc) _sort_jobs);
+
+done:
+  gst_object_unref (file);
+  if (fenum)
+    gst_object_unref (fenum);
+
+  return jobs;
+}
+
+static gboolean
+_check_directory (GstValidateSsim * self, const gchar * ref_dir,
+    const gchar * compared_dir, gfloat * mean, gfloat * lowest,
+    gfloat * highest, const gchar * outfolder)
+{
+  guint i, n_workers;
+  gint nfiles = 0, nnotfound = 0, nfailures = 0;
+  gboolean res = TRUE;
+  gfloat min_avg = 1.0, min_min = 1.0, total_avg = 0;
+  GPtrArray *jobs;
+  GThreadPool *tpool = NULL;
+  SSimJobPool pool = { outfolder, NULL };
+
+  jobs = _list_directory_jobs (self, ref_dir, compared_dir);
+  if (!jobs)
+    return FALSE;
+
+  n_workers = MIN (self->priv->jobs, jobs->len);
+  if (n_workers > 1) {
+    pool.workers = g_async_queue_new_full (gst_object_unref);
+    for (i = 0; i < n_workers; i++)
+      g_async_queue_push (pool.workers,
+          gst_object_ref_sink (gst_validate_ssim_new (NULL,
+                  self->priv->min_avg_similarity,
+                  self->priv->min_lowest_similarity)));
+
+    g_mutex_init (&pool.lock);
+    g_cond_init (&pool.cond);
+    tpool = g_thread_pool_new ((GFunc) _pool_run_job, &pool, n_workers, TRUE,
+        NULL);
+    for (i = 0; i < jobs->len; i++)
+      g_thread_pool_push (tpool, g_ptr_array_index (jobs, i), NULL);
+  }
+
+  for (i = 0; i < jobs->len; i++) {
+    GList *tmp;
+    SSimJob *job = g_ptr_array_index (jobs, i);
+
+    if (tpool) {
+      g_mutex_lock (&pool.lock);
+      while (!job->done)
+        g_cond_wait (&pool.cond, &pool.lock);
+      g_mutex_unlock (&pool.lock);
+
+      for (tmp = job->reports; tmp; tmp = tmp->next)
+        gst_validate_reporter_forward_report (GST_VALIDATE_REPORTER (self),
+            tmp->data);
+    } else {
+      _run_job (self, job, outfolder);
+    }
+
+    if (!job->found) {
+      nnotfound++;
+      res = FALSE;
+    } else {
+      *mean = job->mean;
+      *lowest = job->lowest;
+      *highest = job->highest;
+
+      if (!job->res) {
+        nfailures++;
         res = FALSE;
       } else {
-
-        ref_file =
-            g_build_path (G_DIR_SEPARATOR_S, ref_dir,
-            g_file_info_get_name (info), NULL);
-        if (!gst_validate_ssim_compare_image_files (self, ref_file,
-                compared_file, mean, lowest, highest, outfolder)) {
-          nfailures++;
-          res = FALSE;
-        } else {
-          nfiles++;
-        }
+        nfiles++;
       }
-
-      min_avg = MIN (min_avg, *mean);
-      min_min = MIN (min_min, *lowest);
-      total_avg += *mean;
-      gst_validate_printf (NULL,
-          "<position: %s duration: %" GST_TIME_FORMAT
-          " avg: %f min: %f (Passed: %d failed: %d, %d not found)/>\r",
-          g_file_info_get_display_name (info),
-          GST_TIME_ARGS (GST_CLOCK_TIME_NONE),
-          *mean, *lowest, nfiles, nfailures, nnotfound);
-
-      g_free (compared_file);
-      g_free (ref_file);
     }
 
-    g_object_unref (info);
+    min_avg = MIN (min_avg, *mean);
+    min_min = MIN (min_min, *lowest);
+    total_avg += *mean;
+    gst_validate_printf (NULL,
+        "<position: %s duration: %" GST_TIME_FORMAT
+        " avg: %f min: %f (Passed: %d failed: %d, %d not found)/>\r",
+        job->name, GST_TIME_ARGS (GST_CLOCK_TIME_NONE),
+        *mean, *lowest, nfiles, nfailures, nnotfound);
+  }
+
+  if (tpool) {
+    g_thread_pool_free (tpool, FALSE, TRUE);
+    g_async_queue_unref (pool.workers);
+    g_mutex_clear (&pool.lock);
+    g_cond_clear (&pool.cond);
   }
 
   if (nfiles == 0) {
@@ -808,10 +1112,7 @@ _check_directory (GstValidateSsim * self, const gchar * ref_dir,
         total_avg / nfiles, min_avg, min_min);
   }
 
-done:
-  gst_object_unref (file);
-  if (fenum)
-    gst_object_unref (fenum);
+  g_ptr_array_unref (jobs);
 
   return res;
 }
@@ -960,6 +1261,7 @@ gst_validate_ssim_init (GstValidateSsim * self)
   self->priv = gst_validate_ssim_get_instance_private (self);
 
   self->priv->ssim = gssim_new ();
+  self->priv->jobs = 1;
   self->priv->ref_frames_cache = g_hash_table_new_full (g_str_hash,
       g_str_equal, g_free, (GDestroyNotify) g_array_unref);
 }
@@ -979,3 +1281,22 @@ gst_validate_ssim_new (GstValidateRunner * runner,
 
   return self;
 }
+
+/**
+ * gst_validate_ssim_set_jobs:
+ * @self: a #GstValidateSsim
+ * @jobs: The number of frames to compare in parallel, 0 means as many as
+ * there are processors
+ *
+ * Sets how many frames are compared concurrently when comparing directories.
+ * Each job uses its own #Gssim instance; reports and progress are still
+ * emitted in a deterministic order.
+ */
+void
+gst_validate_ssim_set_jobs (GstValidateSsim * self, guint jobs)
+{
+  if (jobs == 0)
+    jobs = g_get_num_processors ();
+
+  self->priv->jobs = jobs;
+}
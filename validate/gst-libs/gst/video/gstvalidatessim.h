@@ -68,6 +68,8 @@ void gst_validate_ssim_compare_frames           (GstValidateSsim * self, GstVide
                                                  GstVideoFrame *frame, GstBuffer **outbuf,
                                                  gfloat * mean, gfloat * lowest, gfloat * highest);
 
+void gst_validate_ssim_set_jobs                 (GstValidateSsim * self, guint jobs);
+
 G_END_DECLS
 
 #endif
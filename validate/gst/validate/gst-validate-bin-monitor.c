@@ -215,16 +215,12 @@ static void
 gst_validate_bin_child_added_overrides (GstValidateMonitor * monitor,
     GstElement * element)
 {
-  GList *iter;
+  GstValidateOverride **overrides =
+      gst_validate_monitor_get_overrides_for_handler (monitor,
+      GST_VALIDATE_OVERRIDE_ELEMENT_ADDED_HANDLER);
 
-  GST_VALIDATE_MONITOR_OVERRIDES_LOCK (monitor);
-  for (iter = GST_VALIDATE_MONITOR_OVERRIDES (monitor).head; iter;
-      iter = g_list_next (iter)) {
-    GstValidateOverride *override = iter->data;
-
-    gst_validate_override_element_added_handler (override, monitor, element);
-  }
-  GST_VALIDATE_MONITOR_OVERRIDES_UNLOCK (monitor);
+  for (; overrides && *overrides; overrides++)
+    (*overrides)->element_added_handler (*overrides, monitor, element);
 }
 
 static gboolean
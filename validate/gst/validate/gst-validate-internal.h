@@ -46,13 +46,48 @@ void init_scenarios (void);
  * and this is done by the scenario itself now */
 G_GNUC_INTERNAL gboolean _action_check_and_set_printed (GstValidateAction *action);
 G_GNUC_INTERNAL gboolean gst_validate_action_is_subaction (GstValidateAction *action);
+G_GNUC_INTERNAL gchar * gst_validate_get_scenarios (void);
 G_GNUC_INTERNAL void _priv_validate_override_registry_deinit (void);
 
 G_GNUC_INTERNAL GstValidateReportingDetails gst_validate_runner_get_default_reporting_details (GstValidateRunner *runner);
 
 G_GNUC_INTERNAL GstValidateMonitor * gst_validate_get_monitor (GObject *object);
+G_GNUC_INTERNAL gboolean gst_validate_klass_contains (const gchar * element_klass, const gchar * klass);
+
+typedef enum
+{
+  GST_VALIDATE_OVERRIDE_BUFFER_HANDLER,
+  GST_VALIDATE_OVERRIDE_EVENT_HANDLER,
+  GST_VALIDATE_OVERRIDE_QUERY_HANDLER,
+  GST_VALIDATE_OVERRIDE_BUFFER_PROBE_HANDLER,
+  GST_VALIDATE_OVERRIDE_GETCAPS_HANDLER,
+  GST_VALIDATE_OVERRIDE_SETCAPS_HANDLER,
+  GST_VALIDATE_OVERRIDE_ELEMENT_ADDED_HANDLER,
+  GST_VALIDATE_OVERRIDE_N_HANDLERS
+} GstValidateOverrideHandlerType;
+
+G_GNUC_INTERNAL GstValidateOverride ** gst_validate_monitor_get_overrides_for_handler (GstValidateMonitor * monitor,
+                                                                                       GstValidateOverrideHandlerType handler_type);
 G_GNUC_INTERNAL void gst_validate_init_runner (void);
 G_GNUC_INTERNAL void gst_validate_deinit_runner (void);
 G_GNUC_INTERNAL void gst_validate_report_deinit (void);
 G_GNUC_INTERNAL gboolean gst_validate_send (JsonNode * root);
+G_GNUC_INTERNAL void gst_validate_send_flush (void);
+
+G_GNUC_INTERNAL gsize gst_validate_media_checksum_compute (GstValidateMediaChecksumType type, const guint8 * data, gsize size, guint8 * checksum);
+G_GNUC_INTERNAL gchar * gst_validate_media_checksum_to_string (const guint8 * checksum, gsize size);
+G_GNUC_INTERNAL gsize gst_validate_media_checksum_from_string (const gchar * str, guint8 * checksum);
+G_GNUC_INTERNAL const gchar * gst_validate_media_checksum_type_get_name (GstValidateMediaChecksumType type);
+G_GNUC_INTERNAL gboolean gst_validate_media_checksum_type_from_name (const gchar * name, GstValidateMediaChecksumType * type);
+
+G_GNUC_INTERNAL GstValidateMediaFrameTable * gst_validate_media_frame_table_new (void);
+G_GNUC_INTERNAL GstValidateMediaFrameTable * gst_validate_media_frame_table_ref (GstValidateMediaFrameTable * table);
+G_GNUC_INTERNAL void gst_validate_media_frame_table_unref (GstValidateMediaFrameTable * table);
+G_GNUC_INTERNAL guint gst_validate_media_frame_table_get_size (GstValidateMediaFrameTable * table);
+G_GNUC_INTERNAL void gst_validate_media_frame_table_append (GstValidateMediaFrameTable * table, const GstValidateMediaFrameNode * frame);
+G_GNUC_INTERNAL void gst_validate_media_frame_table_get (GstValidateMediaFrameTable * table, guint i, GstValidateMediaFrameNode * frame);
+G_GNUC_INTERNAL void gst_validate_media_frame_table_sort (GstValidateMediaFrameTable * table);
+G_GNUC_INTERNAL GstValidateMediaFrameTable * gst_validate_media_descriptor_get_frame_table (GstValidateMediaDescriptor * self, GstPad * pad);
+G_GNUC_INTERNAL gboolean gst_validate_media_descriptor_is_binary (const gchar * data, gsize size);
+G_GNUC_INTERNAL gboolean gst_validate_media_descriptor_parse_binary (GstValidateMediaDescriptor * self, const gchar * data, gsize size, GError ** error);
 #endif
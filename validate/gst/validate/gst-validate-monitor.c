@@ -116,6 +116,112 @@ _reporter_iface_init (GstValidateReporterInterface * iface)
 G_DEFINE_ABSTRACT_TYPE_WITH_CODE (GstValidateMonitor, gst_validate_monitor,
     GST_TYPE_OBJECT, _do_init);
 
+/* Immutable snapshot of the attached overrides, grouped by the handlers
+ * they implement so that the streaming threads can dispatch to them without
+ * taking the overrides lock. Snapshots are replaced when a new override is
+ * attached, and the old ones are only freed when the monitor is disposed
+ * as a streaming thread might still be iterating them. */
+typedef struct
+{
+  /* NULL terminated, NULL if no override implements the handler */
+  GstValidateOverride **overrides[GST_VALIDATE_OVERRIDE_N_HANDLERS];
+} OverrideHandlers;
+
+static gboolean
+_override_has_handler (GstValidateOverride * override,
+    GstValidateOverrideHandlerType handler_type)
+{
+  switch (handler_type) {
+    case GST_VALIDATE_OVERRIDE_BUFFER_HANDLER:
+      return override->buffer_handler != NULL;
+    case GST_VALIDATE_OVERRIDE_EVENT_HANDLER:
+      return override->event_handler != NULL;
+    case GST_VALIDATE_OVERRIDE_QUERY_HANDLER:
+      return override->query_handler != NULL;
+    case GST_VALIDATE_OVERRIDE_BUFFER_PROBE_HANDLER:
+      return override->buffer_probe_handler != NULL;
+    case GST_VALIDATE_OVERRIDE_GETCAPS_HANDLER:
+      return override->getcaps_handler != NULL;
+    case GST_VALIDATE_OVERRIDE_SETCAPS_HANDLER:
+      return override->setcaps_handler != NULL;
+    case GST_VALIDATE_OVERRIDE_ELEMENT_ADDED_HANDLER:
+      return override->element_added_handler != NULL;
+    default:
+      g_assert_not_reached ();
+  }
+
+  return FALSE;
+}
+
+static void
+_override_handlers_free (OverrideHandlers * handlers)
+{
+  gint i;
+
+  for (i = 0; i < GST_VALIDATE_OVERRIDE_N_HANDLERS; i++)
+    g_free (handlers->overrides[i]);
+
+  g_slice_free (OverrideHandlers, handlers);
+}
+
+/* Must be called with the OVERRIDES_LOCK */
+static void
+_update_override_handlers (GstValidateMonitor * monitor)
+{
+  gint i;
+  GList *iter;
+  OverrideHandlers *old_handlers;
+  OverrideHandlers *handlers = g_slice_new0 (OverrideHandlers);
+
+  for (i = 0; i < GST_VALIDATE_OVERRIDE_N_HANDLERS; i++) {
+    GPtrArray *overrides = NULL;
+
+    for (iter = monitor->overrides.head; iter; iter = g_list_next (iter)) {
+      if (!_override_has_handler (iter->data, i))
+        continue;
+
+      if (!overrides)
+        overrides = g_ptr_array_new ();
+      g_ptr_array_add (overrides, iter->data);
+    }
+
+    if (overrides) {
+      g_ptr_array_add (overrides, NULL);
+      handlers->overrides[i] =
+          (GstValidateOverride **) g_ptr_array_free (overrides, FALSE);
+    }
+  }
+
+  old_handlers = monitor->override_handlers;
+  g_atomic_pointer_set (&monitor->override_handlers, handlers);
+  if (old_handlers)
+    monitor->retired_override_handlers =
+        g_list_prepend (monitor->retired_override_handlers, old_handlers);
+}
+
+/**
+ * gst_validate_monitor_get_overrides_for_handler: (skip):
+ * @monitor: The monitor to get overrides from
+ * @handler_type: The handler the overrides should implement
+ *
+ * Can be called from any thread without locking.
+ *
+ * Returns: (transfer none): A %NULL terminated array of the attached
+ * overrides implementing @handler_type, or %NULL if there are none.
+ */
+GstValidateOverride **
+gst_validate_monitor_get_overrides_for_handler (GstValidateMonitor * monitor,
+    GstValidateOverrideHandlerType handler_type)
+{
+  OverrideHandlers *handlers =
+      g_atomic_pointer_get (&monitor->override_handlers);
+
+  if (G_LIKELY (handlers == NULL))
+    return NULL;
+
+  return handlers->overrides[handler_type];
+}
+
 static void
 gst_validate_monitor_dispose (GObject * object)
 {
@@ -125,6 +231,13 @@ gst_validate_monitor_dispose (GObject * object)
   g_mutex_clear (&monitor->overrides_mutex);
   g_queue_clear (&monitor->overrides);
 
+  if (monitor->override_handlers)
+    _override_handlers_free (monitor->override_handlers);
+  monitor->override_handlers = NULL;
+  g_list_free_full (monitor->retired_override_handlers,
+      (GDestroyNotify) _override_handlers_free);
+  monitor->retired_override_handlers = NULL;
+
   g_weak_ref_clear (&monitor->pipeline);
   g_weak_ref_clear (&monitor->target);
 
@@ -392,6 +505,7 @@ gst_validate_monitor_attach_override (GstValidateMonitor * monitor,
     gst_validate_reporter_set_runner (GST_VALIDATE_REPORTER (override),
         mrunner);
   g_queue_push_tail (&monitor->overrides, override);
+  _update_override_handlers (monitor);
   GST_VALIDATE_MONITOR_OVERRIDES_UNLOCK (monitor);
 
   if (runner)
@@ -98,6 +98,11 @@ struct _GstValidateMonitor {
   GHashTable *reports;
 
   GstValidateVerbosityFlags verbosity;
+
+  /* Overrides implementing each handler, see
+   * gst_validate_monitor_get_overrides_for_handler() */
+  gpointer override_handlers;
+  GList *retired_override_handlers;
 };
 
 /**
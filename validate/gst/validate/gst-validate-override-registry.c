@@ -37,10 +37,26 @@
 #include "gst-validate-override.h"
 #include "gst-validate-override-registry.h"
 
+typedef enum
+{
+  /* The pattern is a literal name, which is searched anywhere in names */
+  NAME_MATCH_SUBSTRING,
+  /* The pattern is a '^name$' literal, indexed in name_overrides_index */
+  NAME_MATCH_EXACT,
+  /* The pattern needs the regex, @literal is its literal prefix if any */
+  NAME_MATCH_REGEX
+} NameMatchType;
+
 typedef struct
 {
   gchar *name;
   GstValidateOverride *override;
+
+  /* Precomputed matching data for name overrides */
+  guint index;
+  NameMatchType match_type;
+  gchar *literal;
+  GRegex *regex;
 } GstValidateOverrideRegistryNameEntry;
 
 typedef struct
@@ -63,6 +79,9 @@ static void
     (GstValidateOverrideRegistryNameEntry * entry)
 {
   g_free (entry->name);
+  g_free (entry->literal);
+  if (entry->regex)
+    g_regex_unref (entry->regex);
   g_object_unref (entry->override);
 
   g_slice_free (GstValidateOverrideRegistryNameEntry, entry);
@@ -86,6 +105,9 @@ gst_validate_override_registry_new (void)
   g_queue_init (&reg->name_overrides);
   g_queue_init (&reg->gtype_overrides);
   g_queue_init (&reg->klass_overrides);
+  g_queue_init (&reg->name_patterns);
+  reg->name_overrides_index = g_hash_table_new_full (g_str_hash, g_str_equal,
+      NULL, (GDestroyNotify) g_list_free);
 
   return reg;
 }
@@ -93,6 +115,9 @@ gst_validate_override_registry_new (void)
 static void
 gst_validate_overide_registery_free (GstValidateOverrideRegistry * reg)
 {
+  g_hash_table_unref (reg->name_overrides_index);
+  g_queue_clear (&reg->name_patterns);
+
   g_queue_foreach (&reg->klass_overrides,
       (GFunc) gst_validate_override_registry_name_entry_free, NULL);
 
@@ -125,18 +150,100 @@ gst_validate_override_registry_get (void)
   return _registry_default;
 }
 
+#define REGEX_SPECIAL_CHARS "\\^$.|?*+()[]{}"
+
+/* Sets up @entry so that matching names mostly does not need to run
+ * the regex, and compiles it once for all if it does */
+static void
+_name_entry_compile (GstValidateOverrideRegistryNameEntry * entry)
+{
+  GError *err = NULL;
+  const gchar *pattern = entry->name;
+  gsize len = strlen (pattern);
+  gsize literal_len;
+
+  if (strpbrk (pattern, REGEX_SPECIAL_CHARS) == NULL) {
+    entry->match_type = NAME_MATCH_SUBSTRING;
+    entry->literal = g_strdup (pattern);
+
+    return;
+  }
+
+  if (len >= 2 && pattern[0] == '^' && pattern[len - 1] == '$') {
+    literal_len = strcspn (pattern + 1, REGEX_SPECIAL_CHARS);
+
+    if (literal_len == len - 2) {
+      entry->match_type = NAME_MATCH_EXACT;
+      entry->literal = g_strndup (pattern + 1, literal_len);
+
+      return;
+    }
+  }
+
+  entry->match_type = NAME_MATCH_REGEX;
+  if (pattern[0] == '^' && strchr (pattern, '|') == NULL) {
+    literal_len = strcspn (pattern + 1, REGEX_SPECIAL_CHARS);
+
+    /* The last literal char is optional with those quantifiers */
+    if (literal_len && strchr ("?*{", pattern[1 + literal_len]))
+      literal_len--;
+
+    if (literal_len)
+      entry->literal = g_strndup (pattern + 1, literal_len);
+  }
+
+  entry->regex = g_regex_new (pattern, G_REGEX_OPTIMIZE, 0, &err);
+  if (!entry->regex) {
+    GST_ERROR ("Invalid element name pattern '%s': %s, it will never match",
+        pattern, err->message);
+    g_clear_error (&err);
+  }
+}
+
+static gboolean
+_name_entry_matches (GstValidateOverrideRegistryNameEntry * entry,
+    const gchar * name)
+{
+  switch (entry->match_type) {
+    case NAME_MATCH_SUBSTRING:
+      return strstr (name, entry->literal) != NULL;
+    case NAME_MATCH_EXACT:
+      return g_strcmp0 (name, entry->literal) == 0;
+    case NAME_MATCH_REGEX:
+      if (entry->literal && !g_str_has_prefix (name, entry->literal))
+        return FALSE;
+
+      return entry->regex && g_regex_match (entry->regex, name, 0, NULL);
+  }
+
+  return FALSE;
+}
+
 void
 gst_validate_override_register_by_name (const gchar * name,
     GstValidateOverride * override)
 {
   GstValidateOverrideRegistry *registry = gst_validate_override_registry_get ();
   GstValidateOverrideRegistryNameEntry *entry =
-      g_slice_new (GstValidateOverrideRegistryNameEntry);
+      g_slice_new0 (GstValidateOverrideRegistryNameEntry);
 
-  GST_VALIDATE_OVERRIDE_REGISTRY_LOCK (registry);
   entry->name = g_strdup (name);
   entry->override = g_object_ref (override);
+  _name_entry_compile (entry);
+
+  GST_VALIDATE_OVERRIDE_REGISTRY_LOCK (registry);
+  entry->index = registry->n_name_overrides++;
   g_queue_push_tail (&registry->name_overrides, entry);
+  if (entry->match_type == NAME_MATCH_EXACT) {
+    GList *entries = g_hash_table_lookup (registry->name_overrides_index,
+        entry->literal);
+
+    g_hash_table_steal (registry->name_overrides_index, entry->literal);
+    g_hash_table_insert (registry->name_overrides_index, entry->literal,
+        g_list_append (entries, entry));
+  } else {
+    g_queue_push_tail (&registry->name_patterns, entry);
+  }
   GST_VALIDATE_OVERRIDE_REGISTRY_UNLOCK (registry);
 }
 
@@ -161,7 +268,7 @@ gst_validate_override_register_by_klass (const gchar * klass,
 {
   GstValidateOverrideRegistry *registry = gst_validate_override_registry_get ();
   GstValidateOverrideRegistryNameEntry *entry =
-      g_slice_new (GstValidateOverrideRegistryNameEntry);
+      g_slice_new0 (GstValidateOverrideRegistryNameEntry);
 
   GST_VALIDATE_OVERRIDE_REGISTRY_LOCK (registry);
   entry->name = g_strdup (klass);
@@ -175,18 +282,38 @@ static void
     (GstValidateOverrideRegistry * registry, GstValidateMonitor * monitor)
 {
   GstValidateOverrideRegistryNameEntry *entry;
-  GList *iter;
+  GList *exact, *patterns;
   const gchar *name;
 
   name = gst_validate_reporter_get_name (GST_VALIDATE_REPORTER (monitor));
-  for (iter = registry->name_overrides.head; iter; iter = g_list_next (iter)) {
-    entry = iter->data;
-    if (g_regex_match_simple (entry->name, name, 0, 0)) {
-      GST_INFO_OBJECT (registry, "Adding override %s to %s", entry->name, name);
+  if (!name)
+    return;
 
-      gst_validate_monitor_attach_override (monitor, entry->override);
-      gst_validate_override_attached (entry->override);
+  exact = g_hash_table_lookup (registry->name_overrides_index, name);
+  patterns = registry->name_patterns.head;
+
+  /* Merge both lists so overrides are attached in registration order */
+  while (exact || patterns) {
+    GstValidateOverrideRegistryNameEntry *pattern_entry =
+        patterns ? patterns->data : NULL;
+
+    if (pattern_entry && (!exact ||
+            pattern_entry->index <
+            ((GstValidateOverrideRegistryNameEntry *) exact->data)->index)) {
+      entry = pattern_entry;
+      patterns = patterns->next;
+
+      if (!_name_entry_matches (entry, name))
+        continue;
+    } else {
+      entry = exact->data;
+      exact = exact->next;
     }
+
+    GST_INFO_OBJECT (registry, "Adding override %s to %s", entry->name, name);
+
+    gst_validate_monitor_attach_override (monitor, entry->override);
+    gst_validate_override_attached (entry->override);
   }
 }
 
@@ -218,16 +345,26 @@ static void
   GstValidateOverrideRegistryNameEntry *entry;
   GList *iter;
   GstElement *element;
+  const gchar *element_klass;
+
+  if (!registry->klass_overrides.length)
+    return;
 
   element = gst_validate_monitor_get_element (monitor);
   if (!element)
     return;
 
+  element_klass =
+      gst_element_class_get_metadata (GST_ELEMENT_GET_CLASS (element),
+      GST_ELEMENT_METADATA_KLASS);
+  if (!element_klass)
+    element_klass = "";
+
   for (iter = registry->klass_overrides.head; iter; iter = g_list_next (iter)) {
 
     entry = iter->data;
 
-    if (gst_validate_element_has_klass (element, entry->name)) {
+    if (gst_validate_klass_contains (element_klass, entry->name)) {
       gst_validate_monitor_attach_override (monitor, entry->override);
     }
   }
@@ -37,6 +37,13 @@ typedef struct {
   GQueue name_overrides;
   GQueue gtype_overrides;
   GQueue klass_overrides;
+
+  /*< private >*/
+  /* Name overrides that can only match one name, indexed by that name */
+  GHashTable *name_overrides_index;
+  /* Other name overrides, checked against each new monitor */
+  GQueue name_patterns;
+  guint n_name_overrides;
 } GstValidateOverrideRegistry;
 
 GST_VALIDATE_API
@@ -59,6 +59,13 @@ struct _GstValidateOverrideClass
   void (*attached)(GstValidateOverride * override);
 };
 
+/**
+ * GstValidateOverride:
+ *
+ * The handlers have to be set before the override is attached to a
+ * #GstValidateMonitor, monitors only call the handlers that were set at
+ * that time.
+ */
 struct _GstValidateOverride
 {
   GstObject parent;
@@ -886,7 +886,8 @@ gst_validate_pad_monitor_dispose (GObject * object)
   gst_structure_free (monitor->pending_setcaps_fields);
   g_ptr_array_unref (monitor->serialized_events);
   g_list_free_full (monitor->expired_events, (GDestroyNotify) gst_event_unref);
-  g_list_free_full (monitor->all_bufs, (GDestroyNotify) gst_buffer_unref);
+  if (monitor->frames)
+    gst_validate_media_frame_table_unref (monitor->frames);
   gst_caps_replace (&monitor->last_caps, NULL);
   gst_caps_replace (&monitor->last_query_res, NULL);
   gst_caps_replace (&monitor->last_query_filter, NULL);
@@ -909,6 +910,49 @@ gst_validate_pad_monitor_class_init (GstValidatePadMonitorClass * klass)
   monitor_klass->get_element = gst_validate_pad_monitor_get_element;
 }
 
+/* The timestamp range is written from the streaming thread of the pad
+ * and read from the streaming threads of the internally linked pads, it
+ * is protected by a sequence counter so that the per-buffer code path
+ * never blocks on another pad's monitor lock. Concurrent writers (flushing
+ * from another thread) serialize on the counter itself. */
+static inline void
+_timestamp_range_write_begin (GstValidatePadMonitor * monitor)
+{
+  gint seqnum;
+
+  do {
+    seqnum = g_atomic_int_get (&monitor->timestamp_range_seqnum);
+  } while ((seqnum & 1)
+      || !g_atomic_int_compare_and_exchange (&monitor->timestamp_range_seqnum,
+          seqnum, seqnum + 1));
+}
+
+static inline void
+_timestamp_range_write_end (GstValidatePadMonitor * monitor)
+{
+  g_atomic_int_inc (&monitor->timestamp_range_seqnum);
+}
+
+static void
+_timestamp_range_read (GstValidatePadMonitor * monitor,
+    GstClockTime * start, GstClockTime * end)
+{
+  gint seqnum;
+
+  for (;;) {
+    seqnum = g_atomic_int_get (&monitor->timestamp_range_seqnum);
+    if (G_UNLIKELY (seqnum & 1))
+      continue;
+
+    *start = monitor->timestamp_range_start;
+    *end = monitor->timestamp_range_end;
+
+    if (G_LIKELY (g_atomic_int_get (&monitor->timestamp_range_seqnum) ==
+            seqnum))
+      break;
+  }
+}
+
 /* Called when a pad is being flushed */
 static void
 gst_validate_pad_monitor_flush (GstValidatePadMonitor * pad_monitor)
@@ -919,10 +963,10 @@ gst_validate_pad_monitor_flush (GstValidatePadMonitor * pad_monitor)
   pad_monitor->caps_is_audio = pad_monitor->caps_is_video =
       pad_monitor->caps_is_raw = FALSE;
 
-  pad_monitor->first_buffer = TRUE;
+  g_atomic_int_set (&pad_monitor->first_buffer, TRUE);
 
   pad_monitor->has_segment = FALSE;
-  pad_monitor->is_eos = FALSE;
+  g_atomic_int_set (&pad_monitor->is_eos, FALSE);
 
   pad_monitor->pending_buffer_discont = TRUE;
 
@@ -938,10 +982,12 @@ gst_validate_pad_monitor_flush (GstValidatePadMonitor * pad_monitor)
   pad_monitor->current_timestamp = GST_CLOCK_TIME_NONE;
   pad_monitor->current_duration = GST_CLOCK_TIME_NONE;
 
-  pad_monitor->last_flow_return = GST_FLOW_OK;
+  g_atomic_int_set ((gint *) & pad_monitor->last_flow_return, GST_FLOW_OK);
 
+  _timestamp_range_write_begin (pad_monitor);
   pad_monitor->timestamp_range_start = GST_CLOCK_TIME_NONE;
   pad_monitor->timestamp_range_end = GST_CLOCK_TIME_NONE;
+  _timestamp_range_write_end (pad_monitor);
 }
 
 /* Called when the pad monitor is initialized or when
@@ -1016,89 +1062,71 @@ gst_validate_pad_monitor_get_element (GstValidateMonitor * monitor)
   return parent;
 }
 
+/* The overrides are dispatched from a snapshot that is replaced when new
+ * ones are attached, so those do not need the OVERRIDES_LOCK */
 static void
 gst_validate_pad_monitor_event_overrides (GstValidatePadMonitor * pad_monitor,
     GstEvent * event)
 {
-  GList *iter;
+  GstValidateOverride **overrides =
+      gst_validate_monitor_get_overrides_for_handler (GST_VALIDATE_MONITOR_CAST
+      (pad_monitor), GST_VALIDATE_OVERRIDE_EVENT_HANDLER);
 
-  GST_VALIDATE_MONITOR_OVERRIDES_LOCK (pad_monitor);
-  for (iter = GST_VALIDATE_MONITOR_OVERRIDES (pad_monitor).head; iter;
-      iter = g_list_next (iter)) {
-    GstValidateOverride *override = iter->data;
-
-    gst_validate_override_event_handler (override,
+  for (; overrides && *overrides; overrides++)
+    (*overrides)->event_handler (*overrides,
         GST_VALIDATE_MONITOR_CAST (pad_monitor), event);
-  }
-  GST_VALIDATE_MONITOR_OVERRIDES_UNLOCK (pad_monitor);
 }
 
 static void
 gst_validate_pad_monitor_buffer_overrides (GstValidatePadMonitor * pad_monitor,
     GstBuffer * buffer)
 {
-  GList *iter;
-
-  GST_VALIDATE_MONITOR_OVERRIDES_LOCK (pad_monitor);
-  for (iter = GST_VALIDATE_MONITOR_OVERRIDES (pad_monitor).head; iter;
-      iter = g_list_next (iter)) {
-    GstValidateOverride *override = iter->data;
+  GstValidateOverride **overrides =
+      gst_validate_monitor_get_overrides_for_handler (GST_VALIDATE_MONITOR_CAST
+      (pad_monitor), GST_VALIDATE_OVERRIDE_BUFFER_HANDLER);
 
-    gst_validate_override_buffer_handler (override,
+  for (; overrides && *overrides; overrides++)
+    (*overrides)->buffer_handler (*overrides,
         GST_VALIDATE_MONITOR_CAST (pad_monitor), buffer);
-  }
-  GST_VALIDATE_MONITOR_OVERRIDES_UNLOCK (pad_monitor);
 }
 
 static void
 gst_validate_pad_monitor_buffer_probe_overrides (GstValidatePadMonitor *
     pad_monitor, GstBuffer * buffer)
 {
-  GList *iter;
-
-  GST_VALIDATE_MONITOR_OVERRIDES_LOCK (pad_monitor);
-  for (iter = GST_VALIDATE_MONITOR_OVERRIDES (pad_monitor).head; iter;
-      iter = g_list_next (iter)) {
-    GstValidateOverride *override = iter->data;
+  GstValidateOverride **overrides =
+      gst_validate_monitor_get_overrides_for_handler (GST_VALIDATE_MONITOR_CAST
+      (pad_monitor), GST_VALIDATE_OVERRIDE_BUFFER_PROBE_HANDLER);
 
-    gst_validate_override_buffer_probe_handler (override,
+  for (; overrides && *overrides; overrides++)
+    (*overrides)->buffer_probe_handler (*overrides,
         GST_VALIDATE_MONITOR_CAST (pad_monitor), buffer);
-  }
-  GST_VALIDATE_MONITOR_OVERRIDES_UNLOCK (pad_monitor);
 }
 
 static void
 gst_validate_pad_monitor_query_overrides (GstValidatePadMonitor * pad_monitor,
     GstQuery * query)
 {
-  GList *iter;
-
-  GST_VALIDATE_MONITOR_OVERRIDES_LOCK (pad_monitor);
-  for (iter = GST_VALIDATE_MONITOR_OVERRIDES (pad_monitor).head; iter;
-      iter = g_list_next (iter)) {
-    GstValidateOverride *override = iter->data;
+  GstValidateOverride **overrides =
+      gst_validate_monitor_get_overrides_for_handler (GST_VALIDATE_MONITOR_CAST
+      (pad_monitor), GST_VALIDATE_OVERRIDE_QUERY_HANDLER);
 
-    gst_validate_override_query_handler (override,
+  for (; overrides && *overrides; overrides++)
+    (*overrides)->query_handler (*overrides,
         GST_VALIDATE_MONITOR_CAST (pad_monitor), query);
-  }
-  GST_VALIDATE_MONITOR_OVERRIDES_UNLOCK (pad_monitor);
 }
 
 static void
 gst_validate_pad_monitor_setcaps_overrides (GstValidatePadMonitor * pad_monitor,
     GstCaps * caps)
 {
-  GList *iter;
+  GstValidateOverride **overrides =
+      gst_validate_monitor_get_overrides_for_handler (GST_VALIDATE_MONITOR_CAST
+      (pad_monitor), GST_VALIDATE_OVERRIDE_SETCAPS_HANDLER);
 
-  GST_VALIDATE_MONITOR_OVERRIDES_LOCK (pad_monitor);
-  for (iter = GST_VALIDATE_MONITOR_OVERRIDES (pad_monitor).head; iter;
-      iter = g_list_next (iter)) {
-    GstValidateOverride *override = iter->data;
-
-    gst_validate_override_setcaps_handler (override,
+  for (; overrides && *overrides; overrides++)
+    (*overrides)->setcaps_handler (*overrides,
         GST_VALIDATE_MONITOR_CAST (pad_monitor), caps);
-  }
-  GST_VALIDATE_MONITOR_OVERRIDES_UNLOCK (pad_monitor);
 }
 
 /* FIXME : This is a bit dubious, what's the point of this check ? */
@@ -1106,29 +1134,27 @@ static gboolean
 gst_validate_pad_monitor_timestamp_is_in_received_range (GstValidatePadMonitor *
     monitor, GstClockTime ts, GstClockTime tolerance)
 {
-  GstPad *pad =
-      GST_PAD (gst_validate_monitor_get_target (GST_VALIDATE_MONITOR
-          (monitor)));
+  GstClockTime range_start, range_end;
+
+  _timestamp_range_read (monitor, &range_start, &range_end);
 
-  GST_DEBUG_OBJECT (pad,
+  GST_DEBUG_OBJECT (monitor,
       "Checking if timestamp %" GST_TIME_FORMAT " is in range: %"
-      GST_TIME_FORMAT " - %" GST_TIME_FORMAT " for pad "
-      "%s:%s with tolerance: %" GST_TIME_FORMAT, GST_TIME_ARGS (ts),
-      GST_TIME_ARGS (monitor->timestamp_range_start),
-      GST_TIME_ARGS (monitor->timestamp_range_end), GST_DEBUG_PAD_NAME (pad),
-      GST_TIME_ARGS (tolerance));
-  gst_object_unref (pad);
+      GST_TIME_FORMAT " - %" GST_TIME_FORMAT " with tolerance: %"
+      GST_TIME_FORMAT, GST_TIME_ARGS (ts), GST_TIME_ARGS (range_start),
+      GST_TIME_ARGS (range_end), GST_TIME_ARGS (tolerance));
 
-  return !GST_CLOCK_TIME_IS_VALID (monitor->timestamp_range_start) ||
-      !GST_CLOCK_TIME_IS_VALID (monitor->timestamp_range_end) ||
-      ((monitor->timestamp_range_start >= tolerance ?
-          monitor->timestamp_range_start - tolerance : 0) <= ts
-      && (ts >= tolerance ? ts - tolerance : 0) <=
-      monitor->timestamp_range_end);
+  return !GST_CLOCK_TIME_IS_VALID (range_start) ||
+      !GST_CLOCK_TIME_IS_VALID (range_end) ||
+      ((range_start >= tolerance ? range_start - tolerance : 0) <= ts
+      && (ts >= tolerance ? ts - tolerance : 0) <= range_end);
 }
 
 /* Iterates over internal links (sinkpads) to check that this buffer has
- * a timestamp that is in the range of the lastly received buffers */
+ * a timestamp that is in the range of the lastly received buffers.
+ *
+ * The other monitors are not locked, their received range is read through
+ * its sequence counter. */
 static void
     gst_validate_pad_monitor_check_buffer_timestamp_in_received_range
     (GstValidatePadMonitor * monitor, GstBuffer * buffer,
@@ -1174,7 +1200,6 @@ static void
             GST_DEBUG_PAD_NAME (otherpad));
         othermonitor =
             g_object_get_data ((GObject *) otherpad, "validate-monitor");
-        GST_VALIDATE_MONITOR_LOCK (othermonitor);
         if (gst_validate_pad_monitor_timestamp_is_in_received_range
             (othermonitor, ts, tolerance)
             &&
@@ -1183,7 +1208,6 @@ static void
           done = TRUE;
           found = TRUE;
         }
-        GST_VALIDATE_MONITOR_UNLOCK (othermonitor);
         g_value_reset (&value);
         has_one = TRUE;
         break;
@@ -1239,8 +1263,8 @@ gst_validate_pad_monitor_check_first_buffer (GstValidatePadMonitor *
       GST_PAD (gst_validate_monitor_get_target (GST_VALIDATE_MONITOR
           (pad_monitor)));
 
-  if (G_UNLIKELY (pad_monitor->first_buffer)) {
-    pad_monitor->first_buffer = FALSE;
+  if (G_UNLIKELY (g_atomic_int_get (&pad_monitor->first_buffer))) {
+    g_atomic_int_set (&pad_monitor->first_buffer, FALSE);
 
     if (!pad_monitor->has_segment && PAD_IS_IN_PUSH_MODE (pad)) {
       GST_VALIDATE_REPORT (pad_monitor, BUFFER_BEFORE_SEGMENT,
@@ -1261,7 +1285,7 @@ static void
 gst_validate_pad_monitor_check_eos (GstValidatePadMonitor *
     pad_monitor, GstBuffer * buffer)
 {
-  if (G_UNLIKELY (pad_monitor->is_eos)) {
+  if (G_UNLIKELY (g_atomic_int_get (&pad_monitor->is_eos))) {
     GST_VALIDATE_REPORT (pad_monitor, BUFFER_AFTER_EOS,
         "Received buffer %" GST_PTR_FORMAT " after EOS", buffer);
   }
@@ -1271,37 +1295,42 @@ static void
 gst_validate_pad_monitor_update_buffer_data (GstValidatePadMonitor *
     pad_monitor, GstBuffer * buffer)
 {
-  GstPad *pad =
-      GST_PAD (gst_validate_monitor_get_target (GST_VALIDATE_MONITOR
-          (pad_monitor)));
+  GstClockTime range_start = pad_monitor->timestamp_range_start;
+  GstClockTime range_end = pad_monitor->timestamp_range_end;
+
   pad_monitor->current_timestamp = GST_BUFFER_TIMESTAMP (buffer);
   pad_monitor->current_duration = GST_BUFFER_DURATION (buffer);
-  if (GST_CLOCK_TIME_IS_VALID (GST_BUFFER_TIMESTAMP (buffer))) {
-    if (GST_CLOCK_TIME_IS_VALID (pad_monitor->timestamp_range_start)) {
-      pad_monitor->timestamp_range_start =
-          MIN (pad_monitor->timestamp_range_start,
-          GST_BUFFER_TIMESTAMP (buffer));
-    } else {
-      pad_monitor->timestamp_range_start = GST_BUFFER_TIMESTAMP (buffer);
-    }
+  if (!GST_CLOCK_TIME_IS_VALID (GST_BUFFER_TIMESTAMP (buffer)))
+    return;
 
-    if (GST_CLOCK_TIME_IS_VALID (GST_BUFFER_DURATION (buffer))) {
-      GstClockTime endts =
-          GST_BUFFER_TIMESTAMP (buffer) + GST_BUFFER_DURATION (buffer);
-      if (GST_CLOCK_TIME_IS_VALID (pad_monitor->timestamp_range_end)) {
-        pad_monitor->timestamp_range_end =
-            MAX (pad_monitor->timestamp_range_end, endts);
-      } else {
-        pad_monitor->timestamp_range_end = endts;
-      }
-    }
+  if (GST_CLOCK_TIME_IS_VALID (range_start))
+    range_start = MIN (range_start, GST_BUFFER_TIMESTAMP (buffer));
+  else
+    range_start = GST_BUFFER_TIMESTAMP (buffer);
+
+  if (GST_CLOCK_TIME_IS_VALID (GST_BUFFER_DURATION (buffer))) {
+    GstClockTime endts =
+        GST_BUFFER_TIMESTAMP (buffer) + GST_BUFFER_DURATION (buffer);
+
+    if (GST_CLOCK_TIME_IS_VALID (range_end))
+      range_end = MAX (range_end, endts);
+    else
+      range_end = endts;
   }
-  GST_DEBUG_OBJECT (pad, "Current stored range: %" GST_TIME_FORMAT
-      " - %" GST_TIME_FORMAT,
-      GST_TIME_ARGS (pad_monitor->timestamp_range_start),
-      GST_TIME_ARGS (pad_monitor->timestamp_range_end));
 
-  gst_object_unref (pad);
+  /* Avoid bumping the sequence counter when nothing changed, which is
+   * the common case for buffers arriving in order with no duration */
+  if (range_start != pad_monitor->timestamp_range_start ||
+      range_end != pad_monitor->timestamp_range_end) {
+    _timestamp_range_write_begin (pad_monitor);
+    pad_monitor->timestamp_range_start = range_start;
+    pad_monitor->timestamp_range_end = range_end;
+    _timestamp_range_write_end (pad_monitor);
+  }
+
+  GST_LOG_OBJECT (pad_monitor, "Current stored range: %" GST_TIME_FORMAT
+      " - %" GST_TIME_FORMAT, GST_TIME_ARGS (range_start),
+      GST_TIME_ARGS (range_end));
 }
 
 static GstFlowReturn
@@ -1348,10 +1377,8 @@ gst_validate_pad_monitor_check_aggregated_return (GstValidatePadMonitor *
               g_object_get_data ((GObject *) peerpad, "validate-monitor");
           if (othermonitor) {
             found_a_pad = TRUE;
-            GST_VALIDATE_MONITOR_LOCK (othermonitor);
-            aggregated =
-                _combine_flows (aggregated, othermonitor->last_flow_return);
-            GST_VALIDATE_MONITOR_UNLOCK (othermonitor);
+            aggregated = _combine_flows (aggregated,
+                g_atomic_int_get ((gint *) & othermonitor->last_flow_return));
           }
 
           gst_object_unref (peerpad);
@@ -1392,7 +1419,7 @@ gst_validate_pad_monitor_check_aggregated_return (GstValidatePadMonitor *
       goto done;
     }
 
-    if (monitor->is_eos && ret == GST_FLOW_EOS) {
+    if (g_atomic_int_get (&monitor->is_eos) && ret == GST_FLOW_EOS) {
       /* this element received eos and returned eos */
       goto done;
     }
@@ -1718,13 +1745,13 @@ mark_pads_eos (GstValidatePadMonitor * pad_monitor)
   GstPad *peer = gst_pad_get_peer (pad);
 
   gst_object_unref (pad);
-  pad_monitor->is_eos = TRUE;
+  g_atomic_int_set (&pad_monitor->is_eos, TRUE);
   if (peer) {
     real_peer = _get_actual_pad (peer);
     peer_monitor =
         g_object_get_data ((GObject *) real_peer, "validate-monitor");
     if (peer_monitor)
-      peer_monitor->is_eos = TRUE;
+      g_atomic_int_set (&peer_monitor->is_eos, TRUE);
     gst_object_unref (peer);
     gst_object_unref (real_peer);
   }
@@ -1739,7 +1766,7 @@ _should_check_buffers (GstValidatePadMonitor * pad_monitor,
           (pad_monitor)));
   GstValidateMonitor *monitor = GST_VALIDATE_MONITOR (pad_monitor);
 
-  if (pad_monitor->first_buffer || force_checks) {
+  if (g_atomic_int_get (&pad_monitor->first_buffer) || force_checks) {
     if (pad_monitor->segment.rate != 1.0) {
       GST_INFO_OBJECT (pad_monitor, "We do not support buffer checking"
           " for trick modes");
@@ -1766,9 +1793,10 @@ _should_check_buffers (GstValidatePadMonitor * pad_monitor,
       GST_DEBUG_OBJECT (pad,
           "No frame detection media descriptor => no buffer checking");
       pad_monitor->check_buffers = FALSE;
-    } else if (pad_monitor->all_bufs == NULL &&
-        !gst_validate_media_descriptor_get_buffers (monitor->media_descriptor,
-            pad, NULL, &pad_monitor->all_bufs)) {
+    } else if (pad_monitor->frames == NULL &&
+        !(pad_monitor->frames =
+            gst_validate_media_descriptor_get_frame_table
+            (monitor->media_descriptor, pad))) {
 
       GST_INFO_OBJECT (monitor,
           "The MediaInfo is marked as detecting frame, but getting frames"
@@ -1777,8 +1805,9 @@ _should_check_buffers (GstValidatePadMonitor * pad_monitor,
 
       pad_monitor->check_buffers = FALSE;
     } else {
-      if (!pad_monitor->current_buf)
-        pad_monitor->current_buf = pad_monitor->all_bufs;
+      if (pad_monitor->current_frame >=
+          gst_validate_media_frame_table_get_size (pad_monitor->frames))
+        pad_monitor->current_frame = 0;
       pad_monitor->check_buffers = TRUE;
     }
   }
@@ -1790,17 +1819,23 @@ _should_check_buffers (GstValidatePadMonitor * pad_monitor,
 static void
 gst_validate_monitor_find_next_buffer (GstValidatePadMonitor * pad_monitor)
 {
-  GList *tmp;
+  guint i;
+  GArray *dts, *pts, *flags;
   gboolean passed_start = FALSE;
 
   if (!_should_check_buffers (pad_monitor, TRUE))
     return;
 
-  for (tmp = g_list_last (pad_monitor->all_bufs); tmp; tmp = tmp->prev) {
-    GstBuffer *cbuf = (GstBuffer *) tmp->data;
-    GstClockTime ts =
-        GST_CLOCK_TIME_IS_VALID (GST_BUFFER_DTS (cbuf)) ? GST_BUFFER_DTS (cbuf)
-        : GST_BUFFER_PTS (cbuf);
+  /* Only look at the columns we need */
+  dts = pad_monitor->frames->dts;
+  pts = pad_monitor->frames->pts;
+  flags = pad_monitor->frames->flags;
+  for (i = gst_validate_media_frame_table_get_size (pad_monitor->frames);
+      i > 0; i--) {
+    GstClockTime ts = g_array_index (dts, guint64, i - 1);
+
+    if (!GST_CLOCK_TIME_IS_VALID (ts))
+      ts = g_array_index (pts, guint64, i - 1);
 
     if (!GST_CLOCK_TIME_IS_VALID (ts))
       continue;
@@ -1811,15 +1846,14 @@ gst_validate_monitor_find_next_buffer (GstValidatePadMonitor * pad_monitor)
     if (!passed_start)
       continue;
 
-    if (!GST_BUFFER_FLAG_IS_SET (cbuf, GST_BUFFER_FLAG_DELTA_UNIT)) {
+    if (g_array_index (flags, guint8, i - 1) &
+        (GST_VALIDATE_MEDIA_FRAME_KEYFRAME |
+            GST_VALIDATE_MEDIA_FRAME_KEYFRAME_UNKNOWN)) {
       break;
     }
   }
 
-  if (tmp == NULL)
-    pad_monitor->current_buf = pad_monitor->all_bufs;
-  else
-    pad_monitor->current_buf = tmp;
+  pad_monitor->current_frame = i > 0 ? i - 1 : 0;
 }
 
 /* Checks whether a segment is just an update of another,
@@ -1944,7 +1978,7 @@ gst_validate_pad_monitor_downstream_event_check (GstValidatePadMonitor *
       break;
     }
     case GST_EVENT_EOS:
-      pad_monitor->is_eos = TRUE;
+      g_atomic_int_set (&pad_monitor->is_eos, TRUE);
       /* FIXME : This feels and looks wrong ... */
       if (pad_monitor->pending_eos_seqnum == GST_SEQNUM_INVALID) {
         GST_VALIDATE_REPORT (pad_monitor, EVENT_EOS_WITHOUT_SEGMENT,
@@ -2129,9 +2163,12 @@ static gboolean
 gst_validate_pad_monitor_check_right_buffer (GstValidatePadMonitor *
     pad_monitor, GstBuffer * buffer)
 {
-  gchar *checksum;
-  GstBuffer *wanted_buf;
-  GstMapInfo map, wanted_map;
+  guint8 checksum[GST_VALIDATE_MEDIA_CHECKSUM_MAX_SIZE];
+  gsize checksum_size;
+  GstValidateMediaFrameNode wanted;
+  GstValidateMediaDescriptor *descriptor =
+      GST_VALIDATE_MONITOR_CAST (pad_monitor)->media_descriptor;
+  GstMapInfo map;
 
   gboolean ret = TRUE;
   GstPad *pad;
@@ -2143,75 +2180,80 @@ gst_validate_pad_monitor_check_right_buffer (GstValidatePadMonitor *
   pad =
       GST_PAD (gst_validate_monitor_get_target (GST_VALIDATE_MONITOR
           (pad_monitor)));
-  if (pad_monitor->current_buf == NULL) {
+  if (pad_monitor->current_frame >=
+      gst_validate_media_frame_table_get_size (pad_monitor->frames)) {
     GST_INFO_OBJECT (pad, "No current buffer one pad, Why?");
     gst_object_unref (pad);
     return FALSE;
   }
 
-  wanted_buf = pad_monitor->current_buf->data;
+  gst_validate_media_frame_table_get (pad_monitor->frames,
+      pad_monitor->current_frame, &wanted);
 
-  if (GST_CLOCK_TIME_IS_VALID (GST_BUFFER_PTS (wanted_buf)) &&
+  if (GST_CLOCK_TIME_IS_VALID (wanted.pts) &&
       GST_CLOCK_TIME_IS_VALID (GST_BUFFER_PTS (buffer)) &&
-      GST_BUFFER_PTS (wanted_buf) != GST_BUFFER_PTS (buffer)) {
+      wanted.pts != GST_BUFFER_PTS (buffer)) {
 
     GST_VALIDATE_REPORT (pad_monitor, WRONG_BUFFER,
         "buffer %" GST_PTR_FORMAT " PTS %" GST_TIME_FORMAT
         " different than expected: %" GST_TIME_FORMAT, buffer,
-        GST_TIME_ARGS (GST_BUFFER_PTS (buffer)),
-        GST_TIME_ARGS (GST_BUFFER_PTS (wanted_buf)));
+        GST_TIME_ARGS (GST_BUFFER_PTS (buffer)), GST_TIME_ARGS (wanted.pts));
 
     ret = FALSE;
   }
 
-  if (GST_BUFFER_DTS (wanted_buf) != GST_BUFFER_DTS (buffer)) {
+  if (wanted.dts != GST_BUFFER_DTS (buffer)) {
     GST_VALIDATE_REPORT (pad_monitor, WRONG_BUFFER,
         "buffer %" GST_PTR_FORMAT " DTS %" GST_TIME_FORMAT
         " different than expected: %" GST_TIME_FORMAT, buffer,
-        GST_TIME_ARGS (GST_BUFFER_DTS (buffer)),
-        GST_TIME_ARGS (GST_BUFFER_DTS (wanted_buf)));
+        GST_TIME_ARGS (GST_BUFFER_DTS (buffer)), GST_TIME_ARGS (wanted.dts));
     ret = FALSE;
   }
 
-  if (GST_BUFFER_DURATION (wanted_buf) != GST_BUFFER_DURATION (buffer)) {
+  if (wanted.duration != GST_BUFFER_DURATION (buffer)) {
     GST_VALIDATE_REPORT (pad_monitor, WRONG_BUFFER,
         "buffer %" GST_PTR_FORMAT " DURATION %" GST_TIME_FORMAT
         " different than expected: %" GST_TIME_FORMAT, buffer,
         GST_TIME_ARGS (GST_BUFFER_DURATION (buffer)),
-        GST_TIME_ARGS (GST_BUFFER_DURATION (wanted_buf)));
+        GST_TIME_ARGS (wanted.duration));
     ret = FALSE;
   }
 
-  if (GST_BUFFER_FLAG_IS_SET (wanted_buf, GST_BUFFER_FLAG_DELTA_UNIT) !=
+  if (!wanted.is_keyframe !=
       GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT)) {
     GST_VALIDATE_REPORT (pad_monitor, WRONG_BUFFER,
         "buffer %" GST_PTR_FORMAT "  Delta unit is set to %s but expected %s",
         buffer, GST_BUFFER_FLAG_IS_SET (buffer,
             GST_BUFFER_FLAG_DELTA_UNIT) ? "True" : "False",
-        GST_BUFFER_FLAG_IS_SET (wanted_buf,
-            GST_BUFFER_FLAG_DELTA_UNIT) ? "True" : "False");
+        !wanted.is_keyframe ? "True" : "False");
     ret = FALSE;
   }
 
-  g_assert (gst_buffer_map (wanted_buf, &wanted_map, GST_MAP_READ));
   g_assert (gst_buffer_map (buffer, &map, GST_MAP_READ));
 
-  checksum = g_compute_checksum_for_data (G_CHECKSUM_MD5,
-      (const guchar *) map.data, map.size);
+  checksum_size =
+      gst_validate_media_checksum_compute (descriptor->filenode->checksum_type,
+      map.data, map.size, checksum);
+
+  if (checksum_size != wanted.checksum_size
+      || memcmp (wanted.checksum, checksum, checksum_size)) {
+    gchar *str = gst_validate_media_checksum_to_string (checksum,
+        checksum_size);
+    gchar *wanted_str = gst_validate_media_checksum_to_string (wanted.checksum,
+        wanted.checksum_size);
 
-  if (g_strcmp0 ((gchar *) wanted_map.data, checksum)) {
     GST_VALIDATE_REPORT (pad_monitor, WRONG_BUFFER,
         "buffer %" GST_PTR_FORMAT " checksum %s different from expected: %s",
-        buffer, checksum, wanted_map.data);
+        buffer, str, wanted_str);
+    g_free (str);
+    g_free (wanted_str);
     ret = FALSE;
   }
 
-  gst_buffer_unmap (wanted_buf, &wanted_map);
   gst_buffer_unmap (buffer, &map);
-  g_free (checksum);
   gst_object_unref (pad);
 
-  pad_monitor->current_buf = pad_monitor->current_buf->next;
+  pad_monitor->current_frame++;
 
   return ret;
 }
@@ -2244,6 +2286,18 @@ gst_validate_pad_monitor_check_return (GstValidatePadMonitor * pad_monitor,
   }
 }
 
+/* Whether the buffer checks need anything else than the state owned by
+ * the streaming thread of the pad, in which case the monitors have to be
+ * locked. This is only the case for the first buffer after a flush and when
+ * checking buffers against a media descriptor. */
+static inline gboolean
+gst_validate_pad_monitor_buffer_checks_need_lock (GstValidatePadMonitor *
+    pad_monitor)
+{
+  return g_atomic_int_get (&pad_monitor->first_buffer)
+      || pad_monitor->check_buffers;
+}
+
 static GstFlowReturn
 gst_validate_pad_monitor_chain_func (GstPad * pad, GstObject * parent,
     GstBuffer * buffer)
@@ -2252,17 +2306,24 @@ gst_validate_pad_monitor_chain_func (GstPad * pad, GstObject * parent,
       g_object_get_data ((GObject *) pad, "validate-monitor");
   GstFlowReturn ret;
 
-  GST_VALIDATE_PAD_MONITOR_PARENT_LOCK (pad_monitor);
-  GST_VALIDATE_MONITOR_LOCK (pad_monitor);
+  if (G_UNLIKELY (gst_validate_pad_monitor_buffer_checks_need_lock
+          (pad_monitor))) {
+    GST_VALIDATE_PAD_MONITOR_PARENT_LOCK (pad_monitor);
+    GST_VALIDATE_MONITOR_LOCK (pad_monitor);
 
-  gst_validate_pad_monitor_check_discont (pad_monitor, buffer);
-  gst_validate_pad_monitor_check_right_buffer (pad_monitor, buffer);
-  gst_validate_pad_monitor_check_first_buffer (pad_monitor, buffer);
-  gst_validate_pad_monitor_update_buffer_data (pad_monitor, buffer);
-  gst_validate_pad_monitor_check_eos (pad_monitor, buffer);
+    gst_validate_pad_monitor_check_discont (pad_monitor, buffer);
+    gst_validate_pad_monitor_check_right_buffer (pad_monitor, buffer);
+    gst_validate_pad_monitor_check_first_buffer (pad_monitor, buffer);
+    gst_validate_pad_monitor_update_buffer_data (pad_monitor, buffer);
+    gst_validate_pad_monitor_check_eos (pad_monitor, buffer);
 
-  GST_VALIDATE_MONITOR_UNLOCK (pad_monitor);
-  GST_VALIDATE_PAD_MONITOR_PARENT_UNLOCK (pad_monitor);
+    GST_VALIDATE_MONITOR_UNLOCK (pad_monitor);
+    GST_VALIDATE_PAD_MONITOR_PARENT_UNLOCK (pad_monitor);
+  } else {
+    gst_validate_pad_monitor_check_discont (pad_monitor, buffer);
+    gst_validate_pad_monitor_update_buffer_data (pad_monitor, buffer);
+    gst_validate_pad_monitor_check_eos (pad_monitor, buffer);
+  }
 
   gst_validate_pad_monitor_buffer_overrides (pad_monitor, buffer);
 
@@ -2270,18 +2331,23 @@ gst_validate_pad_monitor_chain_func (GstPad * pad, GstObject * parent,
 
   gst_validate_pad_monitor_check_return (pad_monitor, ret);
 
-  GST_VALIDATE_PAD_MONITOR_PARENT_LOCK (pad_monitor);
-  GST_VALIDATE_MONITOR_LOCK (pad_monitor);
+  g_atomic_int_set ((gint *) & pad_monitor->last_flow_return, ret);
 
-  pad_monitor->last_flow_return = ret;
-  if (ret == GST_FLOW_EOS) {
-    mark_pads_eos (pad_monitor);
-  }
-  if (PAD_PARENT_IS_DEMUXER (pad_monitor))
-    gst_validate_pad_monitor_check_aggregated_return (pad_monitor, parent, ret);
+  /* Only EOS and demuxers flow combination checks look at other pads */
+  if (ret == GST_FLOW_EOS || PAD_PARENT_IS_DEMUXER (pad_monitor)) {
+    GST_VALIDATE_PAD_MONITOR_PARENT_LOCK (pad_monitor);
+    GST_VALIDATE_MONITOR_LOCK (pad_monitor);
 
-  GST_VALIDATE_MONITOR_UNLOCK (pad_monitor);
-  GST_VALIDATE_PAD_MONITOR_PARENT_UNLOCK (pad_monitor);
+    if (ret == GST_FLOW_EOS) {
+      mark_pads_eos (pad_monitor);
+    }
+    if (PAD_PARENT_IS_DEMUXER (pad_monitor))
+      gst_validate_pad_monitor_check_aggregated_return (pad_monitor, parent,
+          ret);
+
+    GST_VALIDATE_MONITOR_UNLOCK (pad_monitor);
+    GST_VALIDATE_PAD_MONITOR_PARENT_UNLOCK (pad_monitor);
+  }
 
   return ret;
 }
@@ -2464,9 +2530,16 @@ gst_validate_pad_monitor_buffer_probe (GstPad * pad, GstBuffer * buffer,
     gpointer udata, gboolean pull_mode)
 {
   GstValidatePadMonitor *monitor = udata;
+  gboolean locked =
+      gst_validate_pad_monitor_buffer_checks_need_lock (monitor);
 
-  GST_VALIDATE_PAD_MONITOR_PARENT_LOCK (monitor);
-  GST_VALIDATE_MONITOR_LOCK (monitor);
+  /* The other pads are never locked in the common case, the received
+   * timestamp range is read locklessly and serialized events pending on
+   * this pad are checked under its own lock only. */
+  if (G_UNLIKELY (locked)) {
+    GST_VALIDATE_PAD_MONITOR_PARENT_LOCK (monitor);
+    GST_VALIDATE_MONITOR_LOCK (monitor);
+  }
 
   if (!pull_mode)
     gst_validate_pad_monitor_check_discont (monitor, buffer);
@@ -2484,8 +2557,15 @@ gst_validate_pad_monitor_buffer_probe (GstPad * pad, GstBuffer * buffer,
         buffer, tolerance);
   }
 
-  gst_validate_pad_monitor_check_late_serialized_events (monitor,
-      GST_BUFFER_TIMESTAMP (buffer));
+  if (locked) {
+    gst_validate_pad_monitor_check_late_serialized_events (monitor,
+        GST_BUFFER_TIMESTAMP (buffer));
+  } else if (g_atomic_int_get ((gint *) & monitor->serialized_events->len)) {
+    GST_VALIDATE_MONITOR_LOCK (monitor);
+    gst_validate_pad_monitor_check_late_serialized_events (monitor,
+        GST_BUFFER_TIMESTAMP (buffer));
+    GST_VALIDATE_MONITOR_UNLOCK (monitor);
+  }
 
   /* a GstValidatePadMonitor parent must be a GstValidateElementMonitor */
   if (PAD_PARENT_IS_DECODER (monitor)) {
@@ -2515,8 +2595,10 @@ gst_validate_pad_monitor_buffer_probe (GstPad * pad, GstBuffer * buffer,
     }
   }
 
-  GST_VALIDATE_MONITOR_UNLOCK (monitor);
-  GST_VALIDATE_PAD_MONITOR_PARENT_UNLOCK (monitor);
+  if (G_UNLIKELY (locked)) {
+    GST_VALIDATE_MONITOR_UNLOCK (monitor);
+    GST_VALIDATE_PAD_MONITOR_PARENT_UNLOCK (monitor);
+  }
   gst_validate_pad_monitor_buffer_probe_overrides (monitor, buffer);
   return TRUE;
 }
@@ -75,9 +75,12 @@ struct _GstValidatePadMonitor {
   gboolean caps_is_raw;
 
   /* FIXME : Let's migrate all those booleans into a 32 (or 64) bit flag */
+  /* Owned by the streaming thread, accessed with g_atomic_int_* so that
+   * the per-buffer checks do not need the monitor lock */
   gboolean first_buffer;
 
   gboolean has_segment;
+  /* Set by the peer pad monitor too, always use g_atomic_int_* */
   gboolean is_eos;
 
   gboolean pending_flush_stop;
@@ -116,15 +119,22 @@ struct _GstValidatePadMonitor {
    *
    * When a buffer is pushed, the timestamp range is checked against
    * the outgoing timestamp to check it is in the received boundaries.
+   *
+   * Those are only written by the streaming thread of the pad and read
+   * by other pads monitors, @timestamp_range_seqnum is used as a sequence
+   * lock so that neither side needs to take the monitor lock.
    */
   GstClockTime timestamp_range_start;
   GstClockTime timestamp_range_end;
 
   /* GstValidateMediaCheck related fields */
-  GList *all_bufs;
-  /* The GstBuffer that should arrive next in a GList */
-  GList *current_buf;
+  GstValidateMediaFrameTable *frames;
+  /* The index in @frames of the frame that should arrive next */
+  guint current_frame;
   gboolean check_buffers;
+
+  /* Odd while the timestamp range is being updated */
+  gint timestamp_range_seqnum;
 };
 
 /**
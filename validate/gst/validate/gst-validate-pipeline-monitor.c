@@ -28,8 +28,10 @@
 #include "gst-validate-pipeline-monitor.h"
 #include "gst-validate-pad-monitor.h"
 #include "gst-validate-monitor-factory.h"
+#include "validate.h"
 
 #define PRINT_POSITION_TIMEOUT 250
+#define DEFAULT_POSITION_QUERY_INTERVAL 100
 
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
@@ -41,7 +43,15 @@ static gboolean output_is_tty = TRUE;
  * SECTION:gst-validate-pipeline-monitor
  * @short_description: Class that wraps a #GstPipeline for Validate checks
  *
- * TODO
+ * The pipeline monitor keeps track of the pipeline position, duration and
+ * rate for the position printer, the scenarios and the overrides, see
+ * gst_validate_pipeline_monitor_get_position().
+ *
+ * Possible configurations (see #GST_VALIDATE_CONFIG):
+ *  * position-query-interval: Sets the minimum interval in milliseconds
+ *    between two real position queries on the pipeline. In between, the
+ *    position is derived from the last query and the pipeline clock.
+ *    Setting it to 0 means always querying. The default value is 100ms.
  */
 
 typedef struct
@@ -76,6 +86,17 @@ gst_validate_pipeline_monitor_dispose (GObject * object)
   G_OBJECT_CLASS (gst_validate_pipeline_monitor_parent_class)->dispose (object);
 }
 
+static void
+gst_validate_pipeline_monitor_finalize (GObject * object)
+{
+  GstValidatePipelineMonitor *self = (GstValidatePipelineMonitor *) object;
+
+  g_mutex_clear (&self->position_lock);
+
+  G_OBJECT_CLASS (gst_validate_pipeline_monitor_parent_class)->finalize
+      (object);
+}
+
 static void
 gst_validate_pipeline_monitor_class_init (GstValidatePipelineMonitorClass *
     klass)
@@ -83,6 +104,7 @@ gst_validate_pipeline_monitor_class_init (GstValidatePipelineMonitorClass *
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
 
   object_class->dispose = gst_validate_pipeline_monitor_dispose;
+  object_class->finalize = gst_validate_pipeline_monitor_finalize;
 
 #ifdef HAVE_UNISTD_H
   output_is_tty = isatty (1);
@@ -94,42 +116,203 @@ static void
 gst_validate_pipeline_monitor_init (GstValidatePipelineMonitor *
     pipeline_monitor)
 {
+  g_mutex_init (&pipeline_monitor->position_lock);
+  pipeline_monitor->position_query_interval =
+      DEFAULT_POSITION_QUERY_INTERVAL * GST_MSECOND;
+  pipeline_monitor->position_timestamp = GST_CLOCK_TIME_NONE;
+  pipeline_monitor->position_clock_time = GST_CLOCK_TIME_NONE;
+  pipeline_monitor->position = GST_CLOCK_TIME_NONE;
+  pipeline_monitor->duration = GST_CLOCK_TIME_NONE;
+  pipeline_monitor->rate = 1.0;
+}
+
+/**
+ * gst_validate_pipeline_monitor_invalidate_position:
+ * @monitor: The #GstValidatePipelineMonitor
+ *
+ * Drops the cached position so that the next call to
+ * gst_validate_pipeline_monitor_get_position() queries the pipeline. This
+ * is done automatically on state, clock, duration and buffering changes,
+ * but needs to be called when seeking the pipeline.
+ */
+void
+gst_validate_pipeline_monitor_invalidate_position (GstValidatePipelineMonitor *
+    monitor)
+{
+  g_return_if_fail (GST_IS_VALIDATE_PIPELINE_MONITOR (monitor));
+
+  g_mutex_lock (&monitor->position_lock);
+  monitor->position_timestamp = GST_CLOCK_TIME_NONE;
+  g_mutex_unlock (&monitor->position_lock);
 }
 
+/* Must be called with position_lock taken */
 static gboolean
-print_position (GstValidateMonitor * monitor)
+_get_cached_position (GstValidatePipelineMonitor * monitor,
+    GstClockTime now, GstClockTime clock_time, GstClockTime * position)
+{
+  GstClockTime delta;
+
+  if (!GST_CLOCK_TIME_IS_VALID (monitor->position_timestamp) ||
+      now < monitor->position_timestamp ||
+      now - monitor->position_timestamp >= monitor->position_query_interval)
+    return FALSE;
+
+  *position = monitor->position;
+  if (!GST_CLOCK_TIME_IS_VALID (monitor->position_clock_time))
+    return TRUE;
+
+  /* Was PLAYING when queried, keep advancing at the segment rate */
+  if (!GST_CLOCK_TIME_IS_VALID (clock_time)
+      || clock_time < monitor->position_clock_time)
+    return FALSE;
+
+  delta = clock_time - monitor->position_clock_time;
+  if (monitor->rate >= 0) {
+    *position += delta * monitor->rate;
+    if (GST_CLOCK_TIME_IS_VALID (monitor->duration)
+        && *position > monitor->duration)
+      *position = monitor->duration;
+  } else {
+    delta *= -monitor->rate;
+    *position = *position > delta ? *position - delta : 0;
+  }
+
+  return TRUE;
+}
+
+/**
+ * gst_validate_pipeline_monitor_get_position:
+ * @monitor: The #GstValidatePipelineMonitor
+ * @position: (out) (allow-none): The current position
+ * @duration: (out) (allow-none): The current duration,
+ * %GST_CLOCK_TIME_NONE if unknown
+ * @rate: (out) (allow-none): The current playback rate
+ * @queried: (out) (allow-none): Whether the values have just been queried
+ * or derived from a previous query
+ *
+ * Gets the position of the monitored pipeline. The pipeline is only
+ * really queried once per position-query-interval, in between the
+ * position is derived from the last query, the current rate and the
+ * pipeline clock so that all the users share the same queries.
+ *
+ * Returns: %TRUE if the position could be determined, %FALSE otherwise
+ */
+gboolean
+gst_validate_pipeline_monitor_get_position (GstValidatePipelineMonitor *
+    monitor, GstClockTime * position, GstClockTime * duration, gdouble * rate,
+    gboolean * queried)
 {
   GstQuery *query;
-  gint64 position, duration;
+  GstClock *clock = NULL;
+  gint64 pos, dur;
+  gboolean res = FALSE, playing;
+  gdouble qrate = 1.0;
+  GstClockTime pos_now, now, clock_time = GST_CLOCK_TIME_NONE;
+  GstElement *pipeline;
+
+  g_return_val_if_fail (GST_IS_VALIDATE_PIPELINE_MONITOR (monitor), FALSE);
+
+  pipeline = GST_ELEMENT (gst_validate_monitor_get_pipeline
+      (GST_VALIDATE_MONITOR (monitor)));
+  if (!pipeline)
+    return FALSE;
+
+  GST_OBJECT_LOCK (pipeline);
+  playing = GST_STATE (pipeline) == GST_STATE_PLAYING
+      && GST_STATE_PENDING (pipeline) == GST_STATE_VOID_PENDING;
+  GST_OBJECT_UNLOCK (pipeline);
+  playing = playing && !monitor->buffering;
+
+  if (playing && (clock = gst_element_get_clock (pipeline)))
+    clock_time = gst_clock_get_time (clock);
+  now = gst_util_get_timestamp ();
+
+  g_mutex_lock (&monitor->position_lock);
+  if (_get_cached_position (monitor, now, clock_time, &pos_now)) {
+    if (duration)
+      *duration = monitor->duration;
+    if (rate)
+      *rate = monitor->rate;
+    g_mutex_unlock (&monitor->position_lock);
+
+    if (position)
+      *position = pos_now;
+    if (queried)
+      *queried = FALSE;
+
+    res = TRUE;
+    goto done;
+  }
+  g_mutex_unlock (&monitor->position_lock);
+
+  if (!gst_element_query_position (pipeline, GST_FORMAT_TIME, &pos)
+      || !GST_CLOCK_TIME_IS_VALID (pos))
+    goto done;
+
+  if (!gst_element_query_duration (pipeline, GST_FORMAT_TIME, &dur))
+    dur = GST_CLOCK_TIME_NONE;
+
+  query = gst_query_new_segment (GST_FORMAT_DEFAULT);
+  if (gst_element_query (pipeline, query))
+    gst_query_parse_segment (query, &qrate, NULL, NULL, NULL);
+  gst_query_unref (query);
+
+  g_mutex_lock (&monitor->position_lock);
+  if (monitor->position_query_interval) {
+    monitor->position_timestamp = now;
+    monitor->position_clock_time = clock_time;
+  }
+  monitor->position = pos;
+  monitor->duration = dur;
+  monitor->rate = qrate;
+  g_mutex_unlock (&monitor->position_lock);
+
+  if (position)
+    *position = pos;
+  if (duration)
+    *duration = dur;
+  if (rate)
+    *rate = qrate;
+  if (queried)
+    *queried = TRUE;
+
+  res = TRUE;
+
+done:
+  if (clock)
+    gst_object_unref (clock);
+  gst_object_unref (pipeline);
+
+  return res;
+}
+
+static gboolean
+print_position (GstValidateMonitor * monitor)
+{
+  GstClockTime position, duration;
   JsonBuilder *jbuilder;
-  GstElement *pipeline =
-      GST_ELEMENT (gst_validate_monitor_get_pipeline (monitor));
 
   gdouble rate = 1.0;
-  GstFormat format = GST_FORMAT_TIME;
 
   if (!(GST_VALIDATE_MONITOR_CAST (monitor)->verbosity &
           GST_VALIDATE_VERBOSITY_POSITION))
     goto done;
 
-  if (!gst_element_query_position (pipeline, format, &position)) {
+  if (!gst_validate_pipeline_monitor_get_position
+      (GST_VALIDATE_PIPELINE_MONITOR (monitor), &position, &duration, &rate,
+          NULL)) {
     GST_DEBUG_OBJECT (monitor, "Could not query position");
 
     goto done;
   }
 
-  format = GST_FORMAT_TIME;
-  if (!gst_element_query_duration (pipeline, format, &duration)) {
+  if (!GST_CLOCK_TIME_IS_VALID (duration)) {
     GST_DEBUG_OBJECT (monitor, "Could not query duration");
 
     goto done;
   }
 
-  query = gst_query_new_segment (GST_FORMAT_DEFAULT);
-  if (gst_element_query (pipeline, query))
-    gst_query_parse_segment (query, &rate, NULL, NULL, NULL);
-  gst_query_unref (query);
-
   jbuilder = json_builder_new ();
   json_builder_begin_object (jbuilder);
   json_builder_set_member_name (jbuilder, "type");
@@ -151,8 +334,6 @@ print_position (GstValidateMonitor * monitor)
       rate, output_is_tty ? '\r' : '\n');
 
 done:
-  gst_object_unref (pipeline);
-
   return TRUE;
 }
 
@@ -530,6 +711,22 @@ _bus_handler (GstBus * bus, GstMessage * message,
     gst_validate_printf (NULL, "%s", str->str);
     g_string_free (str, TRUE);
   }
+  switch (GST_MESSAGE_TYPE (message)) {
+    case GST_MESSAGE_STATE_CHANGED:
+    case GST_MESSAGE_ASYNC_DONE:
+    case GST_MESSAGE_DURATION_CHANGED:
+    case GST_MESSAGE_BUFFERING:
+    case GST_MESSAGE_NEW_CLOCK:
+    case GST_MESSAGE_CLOCK_LOST:
+    case GST_MESSAGE_RESET_TIME:
+    case GST_MESSAGE_SEGMENT_DONE:
+    case GST_MESSAGE_EOS:
+      gst_validate_pipeline_monitor_invalidate_position (monitor);
+      break;
+    default:
+      break;
+  }
+
   switch (GST_MESSAGE_TYPE (message)) {
     case GST_MESSAGE_ERROR:
       gst_message_parse_error (message, &err, &debug);
@@ -711,7 +908,7 @@ static void
 gst_validate_pipeline_monitor_create_scenarios (GstValidateBinMonitor * monitor)
 {
   /* scenarios currently only make sense for pipelines */
-  const gchar *scenarios_names;
+  gchar *scenarios_names;
   gchar **scenarios = NULL;
   GstObject *target =
       gst_validate_monitor_get_target (GST_VALIDATE_MONITOR (monitor));
@@ -719,7 +916,7 @@ gst_validate_pipeline_monitor_create_scenarios (GstValidateBinMonitor * monitor)
       gst_validate_reporter_get_runner (GST_VALIDATE_REPORTER (monitor));
 
 
-  if ((scenarios_names = g_getenv ("GST_VALIDATE_SCENARIO"))) {
+  if ((scenarios_names = gst_validate_get_scenarios ())) {
     gint i;
 
     scenarios = g_strsplit (scenarios_names, G_SEARCHPATH_SEPARATOR_S, 0);
@@ -745,6 +942,7 @@ gst_validate_pipeline_monitor_create_scenarios (GstValidateBinMonitor * monitor)
     }
   }
 done:
+  g_free (scenarios_names);
   g_strfreev (scenarios);
   if (target)
     gst_object_unref (target);
@@ -761,6 +959,7 @@ gst_validate_pipeline_monitor_new (GstPipeline * pipeline,
     GstValidateRunner * runner, GstValidateMonitor * parent)
 {
   GstBus *bus;
+  GList *config;
   GstValidatePipelineMonitor *monitor =
       g_object_new (GST_TYPE_VALIDATE_PIPELINE_MONITOR, "object",
       pipeline, "validate-runner", runner, "validate-parent", parent,
@@ -773,6 +972,24 @@ gst_validate_pipeline_monitor_new (GstPipeline * pipeline,
     return NULL;
   }
 
+  for (config = gst_validate_plugin_get_config (NULL); config;
+      config = config->next) {
+    gint interval;
+
+    if (gst_structure_get_int (config->data, "position-query-interval",
+            &interval)) {
+      if (interval >= 0) {
+        monitor->position_query_interval = interval * GST_MSECOND;
+        GST_DEBUG_OBJECT (monitor, "Setting position query interval to %d",
+            interval);
+
+        break;
+      } else {
+        GST_WARNING_OBJECT (monitor, "Interval is negative: %d", interval);
+      }
+    }
+  }
+
   gst_validate_pipeline_monitor_create_scenarios (GST_VALIDATE_BIN_MONITOR
       (monitor));
 
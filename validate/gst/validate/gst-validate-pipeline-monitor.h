@@ -70,6 +70,19 @@ struct _GstValidatePipelineMonitor {
   GList *streams_selected;
 
   gulong deep_notify_id;
+
+  /* Position tracking, see gst_validate_pipeline_monitor_get_position() */
+  GMutex position_lock;
+  GstClockTime position_query_interval;
+  /* Monotonic time of the last real query, GST_CLOCK_TIME_NONE if the
+   * cached values are invalid */
+  GstClockTime position_timestamp;
+  /* Pipeline clock time of the last real query, GST_CLOCK_TIME_NONE if
+   * the pipeline was not PLAYING at that time */
+  GstClockTime position_clock_time;
+  GstClockTime position;
+  GstClockTime duration;
+  gdouble rate;
 };
 
 /**
@@ -90,6 +103,15 @@ GST_VALIDATE_API
 GstValidatePipelineMonitor *   gst_validate_pipeline_monitor_new      (GstPipeline * pipeline,
     GstValidateRunner * runner, GstValidateMonitor * parent);
 
+GST_VALIDATE_API
+gboolean gst_validate_pipeline_monitor_get_position (GstValidatePipelineMonitor * monitor,
+                                                     GstClockTime * position,
+                                                     GstClockTime * duration,
+                                                     gdouble * rate,
+                                                     gboolean * queried);
+GST_VALIDATE_API
+void     gst_validate_pipeline_monitor_invalidate_position (GstValidatePipelineMonitor * monitor);
+
 G_END_DECLS
 
 #endif /* __GST_VALIDATE_PIPELINE_MONITOR_H__ */
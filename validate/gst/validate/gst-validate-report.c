@@ -26,7 +26,7 @@
 #endif
 
 
-#include <stdio.h>              /* fprintf */
+#include <stdio.h>              /* fwrite */
 #include <glib/gstdio.h>
 #include <errno.h>
 
@@ -44,11 +44,66 @@ static GstValidateDebugFlags _gst_validate_flags = 0;
 static GHashTable *_gst_validate_issues = NULL;
 static FILE **log_files = NULL;
 
+/* When a launcher is attached, gst_validate_printf() output is written to
+ * the log files from a dedicated thread so that reporting threads never wait
+ * on the disk, unless more than PRINTER_MAX_PENDING_SIZE bytes are waiting
+ * to be written. Reports are always flushed right away so that they are not
+ * lost if the process crashes. */
+#define PRINTER_MAX_PENDING_SIZE (1 << 20)
+/* Size above which the per thread formatting buffers are not kept */
+#define PRINTER_MAX_BUFFER_SIZE (1 << 16)
+static GThread *printer_thread = NULL;
+static GMutex printer_lock;
+static GCond printer_cond;
+static GString *printer_pending = NULL;
+static guint64 printer_n_queued = 0;
+static guint64 printer_n_written = 0;
+static gboolean printer_stop = FALSE;
+static void _free_printer_buffer (GString * buffer);
+static GPrivate printer_buffer =
+G_PRIVATE_INIT ((GDestroyNotify) _free_printer_buffer);
+
 /* Tcp server for communications with gst-validate-launcher */
 GSocketClient *socket_client = NULL;
 GSocketConnection *server_connection = NULL;
 GOutputStream *server_ostream = NULL;
 
+/* Messages for the launcher are written from a dedicated thread so that
+ * the (streaming) threads sending them do not block on the socket, unless
+ * more than SENDER_MAX_PENDING messages are waiting to be written. Only the
+ * latest position is kept while it waits, so positions never pile up. */
+#define SENDER_MAX_PENDING 1024
+static GThread *sender_thread = NULL;
+static GAsyncQueue *sender_queue = NULL;
+static GMutex sender_lock;
+static GCond sender_cond;
+static gint sender_n_pending = 0;
+static gint sender_stop_marker;
+/* Queued in place of the position, which is kept in sender_position */
+static gint sender_position_marker;
+static JsonNode *sender_position = NULL;
+
+/* Compact binary framing for the high frequency messages, used when the
+ * launcher advertises it with `protocol=binary` in GST_VALIDATE_SERVER.
+ *
+ * Frames are prefixed with a big endian 32 bits length, with the high bit
+ * set for binary frames. The payload of binary frames starts with a
+ * #SenderBinaryMessageType followed by the big endian fields:
+ *
+ *  * position: position (int64), duration (int64), speed (double)
+ *  * action: playback-time (int64), action-type (string), args (string)
+ *  * action-done: execution-duration (double), action-type (string)
+ *
+ * with strings prefixed by their 32 bits length. */
+#define SENDER_BINARY_FLAG 0x80000000
+typedef enum
+{
+  SENDER_BINARY_POSITION = 1,
+  SENDER_BINARY_ACTION = 2,
+  SENDER_BINARY_ACTION_DONE = 3,
+} SenderBinaryMessageType;
+static gboolean sender_binary = FALSE;
+
 static GType _gst_validate_report_type = 0;
 
 static JsonNode *
@@ -403,56 +458,433 @@ gst_validate_report_load_issues (void)
   REGISTER_VALIDATE_ISSUE (ISSUE, G_LOG_ISSUE, _("We got a g_log issue"), NULL);
 }
 
-gboolean
-gst_validate_send (JsonNode * root)
+static gboolean
+_is_position_message (JsonNode * root)
+{
+  JsonObject *object;
+
+  if (!JSON_NODE_HOLDS_OBJECT (root))
+    return FALSE;
+
+  object = json_node_get_object (root);
+  return json_object_has_member (object, "type") &&
+      !g_strcmp0 (json_object_get_string_member (object, "type"), "position");
+}
+
+static void
+_append_int64 (GString * batch, gint64 value)
+{
+  guint8 data[8];
+
+  GST_WRITE_UINT64_BE (data, (guint64) value);
+  g_string_append_len (batch, (const gchar *) data, 8);
+}
+
+static void
+_append_double (GString * batch, gdouble value)
+{
+  guint8 data[8];
+
+  GST_WRITE_DOUBLE_BE (data, value);
+  g_string_append_len (batch, (const gchar *) data, 8);
+}
+
+static void
+_append_string (GString * batch, const gchar * value)
+{
+  guint8 data[4];
+  gsize len = value ? strlen (value) : 0;
+
+  GST_WRITE_UINT32_BE (data, len);
+  g_string_append_len (batch, (const gchar *) data, 4);
+  g_string_append_len (batch, value, len);
+}
+
+static gboolean
+_has_members (JsonObject * object, const gchar * first, ...)
+{
+  va_list varargs;
+  const gchar *name = first;
+  gboolean res = TRUE;
+
+  va_start (varargs, first);
+  while (name && res) {
+    res = json_object_has_member (object, name);
+    name = va_arg (varargs, const gchar *);
+  }
+  va_end (varargs);
+
+  return res;
+}
+
+/* Returns: %FALSE if @root can not be sent as a binary frame */
+static gboolean
+_append_binary_message (GString * batch, JsonNode * root)
+{
+  JsonObject *object;
+  const gchar *type;
+  gsize start = batch->len;
+
+  if (!JSON_NODE_HOLDS_OBJECT (root))
+    return FALSE;
+
+  object = json_node_get_object (root);
+  if (!json_object_has_member (object, "type"))
+    return FALSE;
+
+  /* Length, written once the payload is known */
+  g_string_append_len (batch, "\0\0\0\0", 4);
+
+  type = json_object_get_string_member (object, "type");
+  if (!g_strcmp0 (type, "position")
+      && _has_members (object, "position", "duration", "speed", NULL)) {
+    g_string_append_c (batch, SENDER_BINARY_POSITION);
+    _append_int64 (batch, json_object_get_int_member (object, "position"));
+    _append_int64 (batch, json_object_get_int_member (object, "duration"));
+    _append_double (batch, json_object_get_double_member (object, "speed"));
+  } else if (!g_strcmp0 (type, "action")
+      && _has_members (object, "playback-time", "action-type", "args", NULL)) {
+    g_string_append_c (batch, SENDER_BINARY_ACTION);
+    _append_int64 (batch, json_object_get_int_member (object,
+            "playback-time"));
+    _append_string (batch, json_object_get_string_member (object,
+            "action-type"));
+    _append_string (batch, json_object_get_string_member (object, "args"));
+  } else if (!g_strcmp0 (type, "action-done")
+      && _has_members (object, "execution-duration", "action-type", NULL)) {
+    g_string_append_c (batch, SENDER_BINARY_ACTION_DONE);
+    _append_double (batch, json_object_get_double_member (object,
+            "execution-duration"));
+    _append_string (batch, json_object_get_string_member (object,
+            "action-type"));
+  } else {
+    g_string_truncate (batch, start);
+
+    return FALSE;
+  }
+
+  GST_WRITE_UINT32_BE (batch->str + start,
+      SENDER_BINARY_FLAG | (batch->len - start - 4));
+
+  return TRUE;
+}
+
+static void
+_append_message (GString * batch, JsonGenerator * jgen, JsonNode * root)
 {
-  gboolean res = FALSE;
-  JsonGenerator *jgen;
+  guint8 header[4];
   gsize message_length;
-  gchar *object, *message;
-  GError *error = NULL;
+  gchar *message;
 
-  if (!server_ostream)
-    goto done;
+  if (sender_binary && _append_binary_message (batch, root))
+    return;
 
-  jgen = json_generator_new ();
   json_generator_set_root (jgen, root);
+  message = json_generator_to_data (jgen, &message_length);
+
+  GST_WRITE_UINT32_BE (header, message_length);
+  g_string_append_len (batch, (const gchar *) header, 4);
+  g_string_append_len (batch, message, message_length);
+  g_free (message);
+}
+
+static gpointer
+_sender_thread_func (gpointer unused)
+{
+  gboolean stop = FALSE, broken = FALSE;
+  GString *batch = g_string_new (NULL);
+  GPtrArray *messages = g_ptr_array_new ();
+  JsonGenerator *jgen = json_generator_new ();
+
+  while (!stop) {
+    guint i;
+    GError *error = NULL;
+    JsonNode *last_position = NULL;
+    gpointer message = g_async_queue_pop (sender_queue);
+
+    /* Write everything that got queued while we were busy in one go */
+    do {
+      if (message == &sender_stop_marker) {
+        stop = TRUE;
+        break;
+      }
 
-  object = json_generator_to_data (jgen, &message_length);
-  message = g_malloc0 (message_length + 5);
-  GST_WRITE_UINT32_BE (message, message_length);
-  strcpy (&message[4], object);
-  g_free (object);
-
-  res = g_output_stream_write_all (server_ostream, message, message_length + 4,
-      NULL, NULL, &error);
-
-  if (!res) {
-    if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_PENDING)) {
-      GST_DEBUG ("Stream was busy, trying again later.");
-
-      g_free (message);
-      g_object_unref (jgen);
-      if (error)
-        g_error_free (error);
-      g_idle_add ((GSourceFunc) gst_validate_send, root);
-      return G_SOURCE_REMOVE;
+      if (message == &sender_position_marker) {
+        g_mutex_lock (&sender_lock);
+        message = sender_position;
+        sender_position = NULL;
+        g_mutex_unlock (&sender_lock);
+      }
+      g_ptr_array_add (messages, message);
+    } while ((message = g_async_queue_try_pop (sender_queue)));
+
+    /* Only the latest position matters, drop the superseded ones */
+    for (i = 0; i < messages->len; i++) {
+      if (_is_position_message (g_ptr_array_index (messages, i)))
+        last_position = g_ptr_array_index (messages, i);
+    }
+
+    for (i = 0; i < messages->len; i++) {
+      JsonNode *root = g_ptr_array_index (messages, i);
+
+      if (!broken && (root == last_position || !_is_position_message (root)))
+        _append_message (batch, jgen, root);
+      json_node_free (root);
+    }
+
+    if (batch->len) {
+      if (!g_output_stream_write_all (server_ostream, batch->str, batch->len,
+              NULL, NULL, &error)) {
+        GST_ERROR ("ERROR: Can't write to remote: %s", error->message);
+        broken = TRUE;
+      } else if (!g_output_stream_flush (server_ostream, NULL, &error)) {
+        GST_ERROR ("ERROR: Can't flush stream: %s", error->message);
+      }
+      g_clear_error (&error);
+      g_string_truncate (batch, 0);
     }
 
-    GST_ERROR ("ERROR: Can't write to remote: %s", error->message);
-  } else if (!g_output_stream_flush (server_ostream, NULL, &error)) {
-    GST_ERROR ("ERROR: Can't flush stream: %s", error->message);
+    g_mutex_lock (&sender_lock);
+    g_atomic_int_add (&sender_n_pending, -(gint) messages->len);
+    g_cond_broadcast (&sender_cond);
+    g_mutex_unlock (&sender_lock);
+
+    g_ptr_array_set_size (messages, 0);
   }
 
-  g_free (message);
   g_object_unref (jgen);
-  if (error)
-    g_error_free (error);
+  g_ptr_array_free (messages, TRUE);
+  g_string_free (batch, TRUE);
+
+  return NULL;
+}
+
+/* Sends @root to gst-validate-launcher, taking ownership of it. The
+ * message is serialized and written from the sender thread, this only
+ * blocks when more than SENDER_MAX_PENDING messages are waiting. */
+gboolean
+gst_validate_send (JsonNode * root)
+{
+  if (!sender_queue) {
+    json_node_free (root);
+
+    return FALSE;
+  }
+
+  g_mutex_lock (&sender_lock);
+  if (_is_position_message (root)) {
+    /* Replace the position that has not been written yet, if any */
+    if (sender_position) {
+      json_node_free (sender_position);
+      sender_position = root;
+      g_mutex_unlock (&sender_lock);
+
+      return TRUE;
+    }
+
+    sender_position = root;
+    root = (JsonNode *) & sender_position_marker;
+  } else {
+    /* Keep the memory bounded when the launcher does not keep up */
+    while (g_atomic_int_get (&sender_n_pending) > SENDER_MAX_PENDING)
+      g_cond_wait (&sender_cond, &sender_lock);
+  }
 
-done:
-  json_node_free (root);
+  g_atomic_int_inc (&sender_n_pending);
+  g_async_queue_push (sender_queue, root);
+  g_mutex_unlock (&sender_lock);
 
-  return G_SOURCE_REMOVE;
+  return TRUE;
+}
+
+/* Waits until all the messages sent so far have been written */
+void
+gst_validate_send_flush (void)
+{
+  if (!sender_queue)
+    return;
+
+  g_mutex_lock (&sender_lock);
+  while (g_atomic_int_get (&sender_n_pending) > 0)
+    g_cond_wait (&sender_cond, &sender_lock);
+  g_mutex_unlock (&sender_lock);
+}
+
+static void
+_free_printer_buffer (GString * buffer)
+{
+  g_string_free (buffer, TRUE);
+}
+
+static void
+_write_to_log_files (const gchar * str, gsize len)
+{
+  gint i;
+
+  for (i = 0; log_files[i]; i++) {
+    fwrite (str, 1, len, log_files[i]);
+    fflush (log_files[i]);
+  }
+}
+
+static gpointer
+_printer_thread_func (gpointer unused)
+{
+  GString *writing = g_string_new (NULL);
+
+  g_mutex_lock (&printer_lock);
+  for (;;) {
+    GString *tmp;
+    guint64 n_queued;
+
+    while (!printer_pending->len && !printer_stop)
+      g_cond_wait (&printer_cond, &printer_lock);
+
+    if (!printer_pending->len)
+      break;
+
+    /* Write everything that got queued while we were busy in one go */
+    tmp = printer_pending;
+    printer_pending = writing;
+    writing = tmp;
+    n_queued = printer_n_queued;
+    g_cond_broadcast (&printer_cond);
+    g_mutex_unlock (&printer_lock);
+
+    _write_to_log_files (writing->str, writing->len);
+    g_string_truncate (writing, 0);
+
+    g_mutex_lock (&printer_lock);
+    printer_n_written = n_queued;
+    g_cond_broadcast (&printer_cond);
+  }
+  g_mutex_unlock (&printer_lock);
+
+  g_string_free (writing, TRUE);
+
+  return NULL;
+}
+
+static void
+_printer_write (const gchar * str, gsize len)
+{
+  g_mutex_lock (&printer_lock);
+  if (!printer_thread) {
+    _write_to_log_files (str, len);
+    g_mutex_unlock (&printer_lock);
+
+    return;
+  }
+
+  /* Keep the memory bounded when the disk can't keep up */
+  while (printer_pending->len > PRINTER_MAX_PENDING_SIZE)
+    g_cond_wait (&printer_cond, &printer_lock);
+
+  g_string_append_len (printer_pending, str, len);
+  printer_n_queued++;
+  g_cond_broadcast (&printer_cond);
+  g_mutex_unlock (&printer_lock);
+}
+
+/**
+ * gst_validate_printf_flush:
+ *
+ * Waits until everything printed with gst_validate_printf() so far has been
+ * written to the log files. This is needed before redirecting them.
+ */
+void
+gst_validate_printf_flush (void)
+{
+  g_mutex_lock (&printer_lock);
+  if (printer_thread) {
+    guint64 n_queued = printer_n_queued;
+
+    while (printer_n_written < n_queued)
+      g_cond_wait (&printer_cond, &printer_lock);
+  }
+  g_mutex_unlock (&printer_lock);
+}
+
+static void
+_printer_start (void)
+{
+  g_mutex_lock (&printer_lock);
+  if (!printer_thread) {
+    printer_pending = g_string_new (NULL);
+    printer_stop = FALSE;
+    printer_thread =
+        g_thread_new ("gst-validate-printer", _printer_thread_func, NULL);
+  }
+  g_mutex_unlock (&printer_lock);
+}
+
+static void
+_printer_stop (void)
+{
+  GThread *thread;
+
+  g_mutex_lock (&printer_lock);
+  printer_stop = TRUE;
+  thread = printer_thread;
+  g_cond_broadcast (&printer_cond);
+  g_mutex_unlock (&printer_lock);
+
+  if (!thread)
+    return;
+
+  g_thread_join (thread);
+
+  g_mutex_lock (&printer_lock);
+  /* Output queued after the thread stopped waiting for it */
+  _write_to_log_files (printer_pending->str, printer_pending->len);
+  printer_thread = NULL;
+  printer_n_written = printer_n_queued;
+  g_string_free (printer_pending, TRUE);
+  printer_pending = NULL;
+  g_cond_broadcast (&printer_cond);
+  g_mutex_unlock (&printer_lock);
+}
+
+/* Lets the launcher know that the messages that follow are about the test
+ * identified by @uuid */
+static void
+_send_test_started (const gchar * uuid, const gchar * protocol)
+{
+  JsonBuilder *jbuilder = json_builder_new ();
+
+  json_builder_begin_object (jbuilder);
+  json_builder_set_member_name (jbuilder, "uuid");
+  json_builder_add_string_value (jbuilder, uuid);
+  json_builder_set_member_name (jbuilder, "started");
+  json_builder_add_boolean_value (jbuilder, TRUE);
+  if (protocol) {
+    json_builder_set_member_name (jbuilder, "protocol");
+    json_builder_add_string_value (jbuilder, protocol);
+  }
+  json_builder_end_object (jbuilder);
+
+  gst_validate_send (json_builder_get_root (jbuilder));
+  g_object_unref (jbuilder);
+  gst_validate_send_flush ();
+}
+
+/**
+ * gst_validate_report_start_test:
+ * @uuid: The UUID gst-validate-launcher gave to the test
+ *
+ * Lets gst-validate-launcher know that the reports and positions sent
+ * from now on are about the test identified by @uuid. This is only needed
+ * by processes running several tests one after the other, the test
+ * identified by the GST_VALIDATE_UUID environment variable being
+ * announced when initializing.
+ */
+void
+gst_validate_report_start_test (const gchar * uuid)
+{
+  g_return_if_fail (uuid);
+
+  if (server_ostream)
+    _send_test_started (uuid, NULL);
 }
 
 void
@@ -495,8 +927,9 @@ gst_validate_report_init (void)
     GstUri *server_uri = gst_uri_from_string (server_env);
 
     if (server_uri && !g_strcmp0 (gst_uri_get_scheme (server_uri), "tcp")) {
-      JsonBuilder *jbuilder;
       GError *err = NULL;
+      const gchar *protocol = gst_uri_get_query_value (server_uri, "protocol");
+
       socket_client = g_socket_client_new ();
 
       server_connection = g_socket_client_connect_to_host (socket_client,
@@ -510,16 +943,14 @@ gst_validate_report_init (void)
       } else {
         server_ostream =
             g_io_stream_get_output_stream (G_IO_STREAM (server_connection));
-        jbuilder = json_builder_new ();
-        json_builder_begin_object (jbuilder);
-        json_builder_set_member_name (jbuilder, "uuid");
-        json_builder_add_string_value (jbuilder, uuid);
-        json_builder_set_member_name (jbuilder, "started");
-        json_builder_add_boolean_value (jbuilder, TRUE);
-        json_builder_end_object (jbuilder);
-
-        gst_validate_send (json_builder_get_root (jbuilder));
-        g_object_unref (jbuilder);
+        sender_queue = g_async_queue_new ();
+        sender_thread =
+            g_thread_new ("gst-validate-sender", _sender_thread_func, NULL);
+        /* Let the launcher know binary frames are going to be used,
+         * this first message itself is always JSON */
+        _send_test_started (uuid,
+            !g_strcmp0 (protocol, "binary") ? "binary" : NULL);
+        sender_binary = !g_strcmp0 (protocol, "binary");
       }
 
       gst_uri_unref (server_uri);
@@ -563,6 +994,11 @@ gst_validate_report_init (void)
     log_files[0] = stdout;
   }
 
+  /* Without a launcher, output is written synchronously as nothing else
+   * would keep it if the process crashed */
+  if (server_ostream)
+    _printer_start ();
+
 #ifndef GST_DISABLE_GST_DEBUG
   if (!newline_regex)
     newline_regex =
@@ -573,6 +1009,16 @@ gst_validate_report_init (void)
 void
 gst_validate_report_deinit (void)
 {
+  _printer_stop ();
+
+  if (sender_thread) {
+    g_async_queue_push (sender_queue, &sender_stop_marker);
+    g_thread_join (sender_thread);
+    sender_thread = NULL;
+    g_clear_pointer (&sender_queue, g_async_queue_unref);
+    g_clear_pointer (&sender_position, json_node_free);
+  }
+
   if (server_ostream) {
     g_output_stream_close (server_ostream, NULL, NULL);
     server_ostream = NULL;
@@ -689,8 +1135,9 @@ gst_validate_report_new (GstValidateIssue * issue,
     GstValidateReporter * reporter, const gchar * message)
 {
   GstValidateReport *report = g_slice_new0 (GstValidateReport);
-  GstValidateReportingDetails reporter_details, default_details,
-      issue_type_details;
+  GstValidateReportingDetails reporter_details,
+      default_details = GST_VALIDATE_SHOW_UNKNOWN,
+      issue_type_details = GST_VALIDATE_SHOW_UNKNOWN;
   GstValidateRunner *runner = gst_validate_reporter_get_runner (reporter);
 
   gst_mini_object_init (((GstMiniObject *) report), 0,
@@ -714,10 +1161,15 @@ gst_validate_report_new (GstValidateIssue * issue,
   report->reporting_level = GST_VALIDATE_SHOW_UNKNOWN;
 
   reporter_details = gst_validate_reporter_get_reporting_level (reporter);
-  issue_type_details = gst_validate_runner_get_reporting_level_for_name (runner,
-      g_quark_to_string (issue->issue_id));
-  default_details = gst_validate_runner_get_default_reporting_details (runner);
-  gst_object_unref (runner);
+  /* Reporters are not required to have a runner */
+  if (runner) {
+    issue_type_details =
+        gst_validate_runner_get_reporting_level_for_name (runner,
+        g_quark_to_string (issue->issue_id));
+    default_details =
+        gst_validate_runner_get_default_reporting_details (runner);
+    gst_object_unref (runner);
+  }
   if (reporter_details != GST_VALIDATE_SHOW_ALL &&
       reporter_details != GST_VALIDATE_SHOW_UNKNOWN)
     return report;
@@ -876,12 +1328,40 @@ print_action_parameter (GString * string, GstValidateActionType * type,
   g_free (param_head);
 }
 
+/* Returns a copy of the @len first bytes of @str without their newlines */
+static gchar *
+_strip_newlines (const gchar * str, gsize len)
+{
+  const gchar *end = str + len, *newline;
+  gchar *res = g_malloc (len + 1), *out = res;
+
+  while ((newline = memchr (str, '\n', end - str))) {
+    memcpy (out, str, newline - str);
+    out += newline - str;
+    str = newline + 1;
+  }
+  memcpy (out, str, end - str);
+  out += end - str;
+  *out = '\0';
+
+  return res;
+}
+
 void
 gst_validate_printf_valist (gpointer source, const gchar * format, va_list args)
 {
-  gint i;
   gchar *tmp;
-  GString *string = g_string_new (NULL);
+  GString *string;
+
+  /* Reuse this thread's formatting buffer, taking it so that a reentrant
+   * call gets a fresh one */
+  string = g_private_get (&printer_buffer);
+  if (string) {
+    g_private_set (&printer_buffer, NULL);
+    g_string_truncate (string, 0);
+  } else {
+    string = g_string_new (NULL);
+  }
 
   if (source) {
     if (*(GType *) source == GST_TYPE_VALIDATE_ACTION) {
@@ -910,6 +1390,10 @@ gst_validate_printf_valist (gpointer source, const gchar * format, va_list args)
 
       GstValidateActionType *type = GST_VALIDATE_ACTION_TYPE (source);
 
+      if (!newline_regex)
+        newline_regex =
+            g_regex_new ("\n", G_REGEX_OPTIMIZE | G_REGEX_MULTILINE, 0, NULL);
+
       g_string_assign (string, "\nAction type:");
       g_string_append_printf (string,
           "\n  Name: %s\n  Implementer namespace: %s",
@@ -965,16 +1449,10 @@ gst_validate_printf_valist (gpointer source, const gchar * format, va_list args)
   g_string_append (string, tmp);
   g_free (tmp);
 
-  if (!newline_regex)
-    newline_regex =
-        g_regex_new ("\n", G_REGEX_OPTIMIZE | G_REGEX_MULTILINE, 0, NULL);
-
 #ifndef GST_DISABLE_GST_DEBUG
-  {
-    gchar *str;
-
-    str = g_regex_replace (newline_regex, string->str, string->len, 0,
-        "", 0, NULL);
+  if (gst_debug_category_get_threshold (GST_CAT_DEFAULT) >=
+      (source ? GST_LEVEL_INFO : GST_LEVEL_DEBUG)) {
+    gchar *str = _strip_newlines (string->str, string->len);
 
     if (source)
       GST_INFO ("%s", str);
@@ -985,13 +1463,14 @@ gst_validate_printf_valist (gpointer source, const gchar * format, va_list args)
   }
 #endif
 
-  for (i = 0; log_files[i]; i++) {
-    fprintf (log_files[i], "%s", string->str);
-    fflush (log_files[i]);
-  }
+  _printer_write (string->str, string->len);
 
 out:
-  g_string_free (string, TRUE);
+  if (string->allocated_len <= PRINTER_MAX_BUFFER_SIZE
+      && !g_private_get (&printer_buffer))
+    g_private_set (&printer_buffer, string);
+  else
+    g_string_free (string, TRUE);
 }
 
 gboolean
@@ -1115,6 +1594,7 @@ gst_validate_report_printf (GstValidateReport * report)
 
   gst_validate_report_print_description (report);
   gst_validate_printf (NULL, "\n");
+  gst_validate_printf_flush ();
 }
 
 void
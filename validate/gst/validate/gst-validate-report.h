@@ -262,6 +262,8 @@ void               gst_validate_printf_valist (gpointer source,
                                                const gchar      * format,
                                                va_list            args) G_GNUC_NO_INSTRUMENT;
 GST_VALIDATE_API
+void               gst_validate_printf_flush  (void);
+GST_VALIDATE_API
 gboolean gst_validate_report_should_print (GstValidateReport * report);
 GST_VALIDATE_API
 gboolean gst_validate_report_set_master_report(GstValidateReport *report, GstValidateReport *master_report);
@@ -271,6 +273,8 @@ GST_VALIDATE_API
 void gst_validate_report_add_repeated_report (GstValidateReport *report, GstValidateReport *repeated_report);
 GST_VALIDATE_API
 GstValidateReportLevel gst_validate_report_level_from_name (const gchar *level_name);
+GST_VALIDATE_API
+void gst_validate_report_start_test (const gchar *uuid);
 
 G_END_DECLS
 
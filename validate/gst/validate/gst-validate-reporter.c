@@ -164,77 +164,75 @@ gst_validate_reporter_get_report (GstValidateReporter * reporter,
   return report;
 }
 
-void
-gst_validate_report_valist (GstValidateReporter * reporter,
-    GstValidateIssueId issue_id, const gchar * format, va_list var_args)
+#ifndef GST_DISABLE_GST_DEBUG
+static void
+_log_report (GstValidateReporterPrivate * priv, GstValidateIssue * issue,
+    const gchar * format, va_list var_args)
 {
-  GstValidateReport *report, *prev_report;
-  gchar *message, *combo;
+  gchar *combo;
   va_list vacopy;
-  GstValidateIssue *issue;
-  GstValidateReporterPrivate *priv = gst_validate_reporter_get_priv (reporter);
-  GstValidateInterceptionReturn int_ret;
-  GstValidateRunner *runner = NULL;
-
-  issue = gst_validate_issue_from_id (issue_id);
-
-  g_return_if_fail (issue != NULL);
-  g_return_if_fail (GST_IS_VALIDATE_REPORTER (reporter));
+  GstDebugLevel level;
+
+  if (issue->default_level == GST_VALIDATE_REPORT_LEVEL_CRITICAL)
+    level = GST_LEVEL_ERROR;
+  else if (issue->default_level == GST_VALIDATE_REPORT_LEVEL_WARNING)
+    level = GST_LEVEL_WARNING;
+  else if (issue->default_level == GST_VALIDATE_REPORT_LEVEL_ISSUE)
+    level = GST_LEVEL_LOG;
+  else
+    level = GST_LEVEL_DEBUG;
 
-  G_VA_COPY (vacopy, var_args);
-  message = g_strdup_vprintf (format, vacopy);
-  report = gst_validate_report_new (issue, reporter, message);
+  /* Do not build the format string if it is not going to be logged */
+  if (level > gst_debug_category_get_threshold (GST_CAT_DEFAULT))
+    return;
 
-#ifndef GST_DISABLE_GST_DEBUG
   combo =
       g_strdup_printf ("<%s> %" GST_VALIDATE_ISSUE_FORMAT " : %s", priv->name,
       GST_VALIDATE_ISSUE_ARGS (issue), format);
   G_VA_COPY (vacopy, var_args);
-  if (report->level == GST_VALIDATE_REPORT_LEVEL_CRITICAL) {
-    gst_debug_log_valist (GST_CAT_DEFAULT, GST_LEVEL_ERROR, __FILE__,
-        GST_FUNCTION, __LINE__, NULL, combo, vacopy);
-  } else if (report->level == GST_VALIDATE_REPORT_LEVEL_WARNING)
-    gst_debug_log_valist (GST_CAT_DEFAULT, GST_LEVEL_WARNING, __FILE__,
-        GST_FUNCTION, __LINE__, NULL, combo, vacopy);
-  else if (report->level == GST_VALIDATE_REPORT_LEVEL_ISSUE)
-    gst_debug_log_valist (GST_CAT_DEFAULT, GST_LEVEL_LOG, __FILE__,
-        GST_FUNCTION, __LINE__, (GObject *) NULL, combo, vacopy);
-  else
-    gst_debug_log_valist (GST_CAT_DEFAULT, GST_LEVEL_DEBUG, __FILE__,
-        GST_FUNCTION, __LINE__, NULL, combo, vacopy);
+  gst_debug_log_valist (GST_CAT_DEFAULT, level, __FILE__,
+      GST_FUNCTION, __LINE__, NULL, combo, vacopy);
+  va_end (vacopy);
   g_free (combo);
+}
 #endif
-  va_end (vacopy);
 
-  int_ret = gst_validate_reporter_intercept_report (reporter, report);
-
-  if (int_ret == GST_VALIDATE_REPORTER_DROP) {
-    gst_validate_report_unref (report);
-    goto done;
-  }
-
-  prev_report = g_hash_table_lookup (priv->reports, (gconstpointer) issue_id);
+/* Whether issues repeated inside the same reporter should be tracked */
+static gboolean
+_keeps_repeated_reports (GstValidateReporter * reporter,
+    GstValidateRunner * runner)
+{
+  GstValidateReportingDetails reporter_level =
+      gst_validate_reporter_get_reporting_level (reporter);
+  GstValidateReportingDetails runner_level = GST_VALIDATE_SHOW_UNKNOWN;
 
-  runner = gst_validate_reporter_get_runner (reporter);
-  if (prev_report) {
-    GstValidateReportingDetails reporter_level =
-        gst_validate_reporter_get_reporting_level (reporter);
-    GstValidateReportingDetails runner_level = GST_VALIDATE_SHOW_UNKNOWN;
+  if (runner)
+    runner_level = gst_validate_runner_get_default_reporting_level (runner);
 
-    if (runner)
-      runner_level = gst_validate_runner_get_default_reporting_level (runner);
+  return reporter_level == GST_VALIDATE_SHOW_ALL ||
+      (runner_level == GST_VALIDATE_SHOW_ALL &&
+      reporter_level == GST_VALIDATE_SHOW_UNKNOWN);
+}
 
-    if (reporter_level == GST_VALIDATE_SHOW_ALL ||
-        (runner_level == GST_VALIDATE_SHOW_ALL &&
-            reporter_level == GST_VALIDATE_SHOW_UNKNOWN))
-      gst_validate_report_add_repeated_report (prev_report, report);
+/* Tracks @report, created by gst_validate_report_new() for @reporter and
+ * already intercepted, @prev_report being the report previously tracked for
+ * the same issue if any */
+static void
+_add_report (GstValidateReporter * reporter, GstValidateRunner * runner,
+    GstValidateReport * report, GstValidateReport * prev_report,
+    GstValidateInterceptionReturn int_ret)
+{
+  GstValidateReporterPrivate *priv = gst_validate_reporter_get_priv (reporter);
 
+  if (prev_report) {
+    gst_validate_report_add_repeated_report (prev_report, report);
     gst_validate_report_unref (report);
-    goto done;
+    return;
   }
 
   GST_VALIDATE_REPORTER_REPORTS_LOCK (reporter);
-  g_hash_table_insert (priv->reports, (gpointer) issue_id, report);
+  g_hash_table_insert (priv->reports,
+      (gpointer) report->issue->issue_id, report);
   GST_VALIDATE_REPORTER_REPORTS_UNLOCK (reporter);
 
   if (runner && int_ret == GST_VALIDATE_REPORTER_REPORT) {
@@ -245,15 +243,85 @@ gst_validate_report_valist (GstValidateReporter * reporter,
     if (runner)
       gst_validate_runner_printf (runner);
 
+    /* Make sure the launcher and the logs get the report before aborting */
+    gst_validate_send_flush ();
+    gst_validate_printf_flush ();
+
     g_error ("Fatal report received: %" GST_VALIDATE_ERROR_REPORT_PRINT_FORMAT,
         GST_VALIDATE_REPORT_PRINT_ARGS (report));
   }
+}
+
+/**
+ * gst_validate_report_valist:
+ * @reporter: The source of the new report
+ * @issue_id: The #GstValidateIssueId of the issue
+ * @format: The format of the message describing the issue in a printf
+ *       format
+ * @var_args: Substitution arguments for @format
+ *
+ * Reports a new issue in the GstValidate reporting system with @reporter
+ * as the source of that issue.
+ *
+ * Repeated issues that are not going to be tracked are discarded before
+ * any report is created, and the message is only formatted once the
+ * report has passed the #GstValidateReporterInterface.intercept_report
+ * step, which means that #GstValidateReport.message is %NULL at that
+ * point.
+ */
+void
+gst_validate_report_valist (GstValidateReporter * reporter,
+    GstValidateIssueId issue_id, const gchar * format, va_list var_args)
+{
+  GstValidateReport *report, *prev_report;
+  va_list vacopy;
+  GstValidateIssue *issue;
+  GstValidateReporterPrivate *priv;
+  GstValidateInterceptionReturn int_ret;
+  GstValidateRunner *runner = NULL;
+
+  issue = gst_validate_issue_from_id (issue_id);
+
+  g_return_if_fail (issue != NULL);
+  g_return_if_fail (GST_IS_VALIDATE_REPORTER (reporter));
+
+  priv = gst_validate_reporter_get_priv (reporter);
+
+#ifndef GST_DISABLE_GST_DEBUG
+  _log_report (priv, issue, format, var_args);
+#endif
+
+  GST_VALIDATE_REPORTER_REPORTS_LOCK (reporter);
+  prev_report = g_hash_table_lookup (priv->reports, (gconstpointer) issue_id);
+  if (prev_report)
+    gst_validate_report_ref (prev_report);
+  GST_VALIDATE_REPORTER_REPORTS_UNLOCK (reporter);
+
+  runner = gst_validate_reporter_get_runner (reporter);
+  if (prev_report && !_keeps_repeated_reports (reporter, runner))
+    goto done;
+
+  report = gst_validate_report_new (issue, reporter, NULL);
+  int_ret = gst_validate_reporter_intercept_report (reporter, report);
+
+  if (int_ret == GST_VALIDATE_REPORTER_DROP) {
+    gst_validate_report_unref (report);
+    goto done;
+  }
+
+  /* The report is going to be kept, we can now build its message */
+  G_VA_COPY (vacopy, var_args);
+  report->message = g_strdup_vprintf (format, vacopy);
+  va_end (vacopy);
+
+  _add_report (reporter, runner, report, prev_report, int_ret);
 
 done:
   if (runner)
     gst_object_unref (runner);
 
-  g_free (message);
+  if (prev_report)
+    gst_validate_report_unref (prev_report);
 }
 
 static void
@@ -311,6 +379,66 @@ gst_validate_reporter_report_simple (GstValidateReporter * reporter,
   gst_validate_report (reporter, issue_id, "%s", message);
 }
 
+/**
+ * gst_validate_reporter_forward_report:
+ * @reporter: The reporter to report @report on
+ * @report: (transfer none): A report emitted by another reporter
+ *
+ * Reports a copy of @report, and of the reports it repeats, as if it had
+ * been emitted by @reporter, keeping their level, message and backtrace.
+ *
+ * This lets reporters without a runner, for example helpers running in
+ * worker threads, hand their reports over to a reporter that has one.
+ */
+void
+gst_validate_reporter_forward_report (GstValidateReporter * reporter,
+    GstValidateReport * report)
+{
+  GList *tmp;
+  GstValidateReport *copy, *prev_report;
+  GstValidateRunner *runner;
+  GstValidateInterceptionReturn int_ret;
+  GstValidateReporterPrivate *priv;
+
+  g_return_if_fail (GST_IS_VALIDATE_REPORTER (reporter));
+  g_return_if_fail (report != NULL);
+
+  priv = gst_validate_reporter_get_priv (reporter);
+
+  GST_VALIDATE_REPORTER_REPORTS_LOCK (reporter);
+  prev_report = g_hash_table_lookup (priv->reports,
+      (gconstpointer) report->issue->issue_id);
+  if (prev_report)
+    gst_validate_report_ref (prev_report);
+  GST_VALIDATE_REPORTER_REPORTS_UNLOCK (reporter);
+
+  runner = gst_validate_reporter_get_runner (reporter);
+  if (prev_report && !_keeps_repeated_reports (reporter, runner))
+    goto done;
+
+  copy = gst_validate_report_new (report->issue, reporter, report->message);
+  copy->level = report->level;
+  copy->timestamp = report->timestamp;
+  g_free (copy->trace);
+  copy->trace = g_strdup (report->trace);
+
+  int_ret = gst_validate_reporter_intercept_report (reporter, copy);
+  if (int_ret == GST_VALIDATE_REPORTER_DROP)
+    gst_validate_report_unref (copy);
+  else
+    _add_report (reporter, runner, copy, prev_report, int_ret);
+
+done:
+  if (runner)
+    gst_object_unref (runner);
+
+  if (prev_report)
+    gst_validate_report_unref (prev_report);
+
+  for (tmp = report->repeated_reports; tmp; tmp = tmp->next)
+    gst_validate_reporter_forward_report (reporter, tmp->data);
+}
+
 /**
  * gst_validate_reporter_set_name:
  * @reporter: The reporter to set the name on
@@ -114,6 +114,8 @@ void gst_validate_report_valist                (GstValidateReporter * reporter,
 GST_VALIDATE_API void
 gst_validate_reporter_report_simple (GstValidateReporter * reporter, GstValidateIssueId issue_id,
                                           const gchar * message);
+GST_VALIDATE_API
+void gst_validate_reporter_forward_report      (GstValidateReporter * reporter, GstValidateReport * report);
 
 GST_VALIDATE_API
 void gst_validate_reporter_set_runner          (GstValidateReporter * reporter, GstValidateRunner *runner);
@@ -813,6 +813,7 @@ gst_validate_runner_exit (GstValidateRunner * runner, gboolean print_result)
   gint ret = 0;
   g_return_val_if_fail (GST_IS_VALIDATE_RUNNER (runner), 1);
   g_signal_emit (runner, _signals[STOPPING_SIGNAL], 0);
+  gst_validate_send_flush ();
   if (print_result) {
     ret = gst_validate_runner_printf (runner);
   } else {
@@ -823,6 +824,7 @@ gst_validate_runner_exit (GstValidateRunner * runner, gboolean print_result)
         ret = 18;
     }
   }
+  gst_validate_printf_flush ();
 
   return ret;
 }
@@ -44,6 +44,7 @@
 #include <gio/gio.h>
 #include <string.h>
 #include <errno.h>
+#include <glib/gstdio.h>
 
 #include "gst-validate-internal.h"
 #include "gst-validate-scenario.h"
@@ -61,6 +62,10 @@
 #define DEFAULT_SEEK_TOLERANCE (1 * GST_MSECOND)        /* tolerance seek interval
                                                            TODO make it overridable  */
 
+/* Interval at which the position is still checked against the segment
+ * while the next action waits on the pipeline clock, in milliseconds */
+#define CLOCK_WAIT_POSITION_CHECK_INTERVAL 250
+
 GST_DEBUG_CATEGORY_STATIC (gst_validate_scenario_debug);
 #undef GST_CAT_DEFAULT
 #define GST_CAT_DEFAULT gst_validate_scenario_debug
@@ -104,6 +109,7 @@ static GList *action_types = NULL;
 static void gst_validate_scenario_dispose (GObject * object);
 static void gst_validate_scenario_finalize (GObject * object);
 static GstValidateActionType *_find_action_type (const gchar * type_name);
+static void _cancel_clock_wait (GstValidateScenario * scenario);
 
 /* GstValidateScenario is not really thread safe and
  * everything should be done from the thread GstValidate
@@ -140,6 +146,12 @@ struct _GstValidateScenarioPrivate
   gboolean handles_state;
 
   guint execute_actions_source_id;      /* MT safe. Protect with SCENARIO_LOCK */
+  /* Pending wait on the pipeline clock for the next timed action, replaces
+   * polling the position. MT safe. Protect with SCENARIO_LOCK */
+  GstClockID clock_id;
+  guint clock_wait_seqnum;
+  /* Low rate position checks while waiting on the clock */
+  guint position_check_id;
   guint wait_id;
   guint signal_handler_id;
   guint action_execution_interval;
@@ -167,12 +179,6 @@ struct _GstValidateScenarioPrivate
   GWeakRef ref_pipeline;
 };
 
-typedef struct KeyFileGroupName
-{
-  GKeyFile *kf;
-  gchar *group_name;
-} KeyFileGroupName;
-
 static GstValidateInterceptionReturn
 gst_validate_scenario_intercept_report (GstValidateReporter * reporter,
     GstValidateReport * report)
@@ -237,8 +243,26 @@ struct _GstValidateActionPrivate
   GstClockTime timeout;
 
   GWeakRef scenario;
+
+  /* Parameter name -> ActionExpression */
+  GHashTable *expressions;
 };
 
+/* An expression compiled from the value of an action parameter */
+typedef struct
+{
+  gchar *str;
+  GstValidateExpression *expression;
+} ActionExpression;
+
+static void
+_action_expression_free (ActionExpression * expr)
+{
+  gst_validate_expression_free (expr->expression);
+  g_free (expr->str);
+  g_free (expr);
+}
+
 static JsonNode *
 gst_validate_action_serialize (GstValidateAction * action)
 {
@@ -317,6 +341,9 @@ _action_free (GstValidateAction * action)
 
   g_weak_ref_clear (&action->priv->scenario);
 
+  if (action->priv->expressions)
+    g_hash_table_unref (action->priv->expressions);
+
   g_slice_free (GstValidateActionPrivate, action->priv);
   g_slice_free (GstValidateAction, action);
 }
@@ -516,6 +543,36 @@ done:
   return TRUE;
 }
 
+/* Evaluates @strval, the value of the @name parameter of @action, only
+ * compiling it the first time */
+static gdouble
+_action_evaluate_expression (GstValidateScenario * scenario,
+    GstValidateAction * action, const gchar * name, const gchar * strval,
+    gchar ** error)
+{
+  ActionExpression *expr = NULL;
+  GstValidateExpression *expression;
+
+  if (action->priv->expressions)
+    expr = g_hash_table_lookup (action->priv->expressions, name);
+  else
+    action->priv->expressions = g_hash_table_new_full (g_str_hash,
+        g_str_equal, g_free, (GDestroyNotify) _action_expression_free);
+
+  if (!expr || g_strcmp0 (expr->str, strval)) {
+    if (!(expression = gst_validate_expression_compile (strval, error)))
+      return -1.0;
+
+    expr = g_new0 (ActionExpression, 1);
+    expr->str = g_strdup (strval);
+    expr->expression = expression;
+    g_hash_table_insert (action->priv->expressions, g_strdup (name), expr);
+  }
+
+  return gst_validate_expression_evaluate (expr->expression,
+      _set_variable_func, scenario, error);
+}
+
 /* Check that @list doesn't contain any non-optional actions */
 static gboolean
 actions_list_is_done (GList * list)
@@ -580,8 +637,7 @@ gst_validate_action_get_clocktime (GstValidateScenario * scenario,
       return -1;
     }
 
-    val = gst_validate_utils_parse_expression (strval, _set_variable_func,
-        scenario, &error);
+    val = _action_evaluate_expression (scenario, action, name, strval, &error);
 
     if (error) {
       GST_WARNING ("Error while parsing %s: %s", strval, error);
@@ -638,6 +694,12 @@ gst_validate_scenario_execute_seek (GstValidateScenario * scenario,
 
   gst_event_ref (seek);
   if (gst_element_send_event (pipeline, seek)) {
+    GstValidatePipelineMonitor *monitor =
+        g_object_get_data ((GObject *) pipeline, "validate-monitor");
+
+    if (monitor && GST_IS_VALIDATE_PIPELINE_MONITOR (monitor))
+      gst_validate_pipeline_monitor_invalidate_position (monitor);
+
     gst_event_replace (&priv->last_seek, seek);
     priv->seek_flags = flags;
   } else {
@@ -850,6 +912,7 @@ _execute_stop (GstValidateScenario * scenario, GstValidateAction * action)
     g_source_remove (priv->execute_actions_source_id);
     priv->execute_actions_source_id = 0;
   }
+  _cancel_clock_wait (scenario);
   SCENARIO_UNLOCK (scenario);
 
   gst_bus_post (bus,
@@ -1455,12 +1518,33 @@ _execute_set_rank (GstValidateScenario * scenario, GstValidateAction * action)
   return GST_VALIDATE_EXECUTE_ACTION_OK;
 }
 
+/* Must be called with SCENARIO_LOCK taken */
+static void
+_cancel_clock_wait (GstValidateScenario * scenario)
+{
+  GstValidateScenarioPrivate *priv = scenario->priv;
+
+  if (priv->clock_id) {
+    gst_clock_id_unschedule (priv->clock_id);
+    gst_clock_id_unref (priv->clock_id);
+    priv->clock_id = NULL;
+  }
+
+  if (priv->position_check_id) {
+    g_source_remove (priv->position_check_id);
+    priv->position_check_id = 0;
+  }
+}
+
 static inline gboolean
 _add_execute_actions_gsource (GstValidateScenario * scenario)
 {
   GstValidateScenarioPrivate *priv = scenario->priv;
 
   SCENARIO_LOCK (scenario);
+  /* Something happened (seek, state or rate change...), go back to checking
+   * the position until a new clock wait is scheduled */
+  _cancel_clock_wait (scenario);
   if (priv->execute_actions_source_id == 0 && priv->wait_id == 0
       && priv->signal_handler_id == 0 && priv->message_type == NULL) {
     if (!scenario->priv->action_execution_interval)
@@ -1483,10 +1567,12 @@ _add_execute_actions_gsource (GstValidateScenario * scenario)
 
 static gboolean
 _get_position (GstValidateScenario * scenario,
-    GstValidateAction * act, GstClockTime * position)
+    GstValidateAction * act, GstClockTime * position, gdouble * rate,
+    gboolean * queried)
 {
   gboolean has_pos = FALSE, has_dur = FALSE;
   GstClockTime duration = -1;
+  GstValidatePipelineMonitor *monitor;
 
   GstValidateScenarioPrivate *priv = scenario->priv;
   GstElement *pipeline = gst_validate_scenario_get_pipeline (scenario);
@@ -1497,13 +1583,29 @@ _get_position (GstValidateScenario * scenario,
     return FALSE;
   }
 
-  has_pos = gst_element_query_position (pipeline, GST_FORMAT_TIME,
-      (gint64 *) position)
-      && GST_CLOCK_TIME_IS_VALID (*position);
-  has_dur =
-      gst_element_query_duration (pipeline, GST_FORMAT_TIME,
-      (gint64 *) & duration)
-      && GST_CLOCK_TIME_IS_VALID (duration);
+  monitor = g_object_get_data ((GObject *) pipeline, "validate-monitor");
+  if (monitor && GST_IS_VALIDATE_PIPELINE_MONITOR (monitor)) {
+    /* Share the (cached) queries with the monitor */
+    has_pos = gst_validate_pipeline_monitor_get_position (monitor, position,
+        &duration, rate, queried)
+        && GST_CLOCK_TIME_IS_VALID (*position);
+  } else {
+    GstQuery *query;
+
+    has_pos = gst_element_query_position (pipeline, GST_FORMAT_TIME,
+        (gint64 *) position)
+        && GST_CLOCK_TIME_IS_VALID (*position);
+    if (!gst_element_query_duration (pipeline, GST_FORMAT_TIME,
+            (gint64 *) & duration))
+      duration = GST_CLOCK_TIME_NONE;
+
+    query = gst_query_new_segment (GST_FORMAT_DEFAULT);
+    if (gst_element_query (pipeline, query))
+      gst_query_parse_segment (query, rate, NULL, NULL, NULL);
+    gst_query_unref (query);
+    *queried = TRUE;
+  }
+  has_dur = GST_CLOCK_TIME_IS_VALID (duration);
 
   if (!has_pos && GST_STATE (pipeline) >= GST_STATE_PAUSED &&
       act && GST_CLOCK_TIME_IS_VALID (act->playback_time)) {
@@ -1513,7 +1615,8 @@ _get_position (GstValidateScenario * scenario,
     goto fail;
   }
 
-  if (has_pos && has_dur && !priv->got_eos) {
+  /* Derived positions are clamped to the duration */
+  if (*queried && has_pos && has_dur && !priv->got_eos) {
     if (*position > duration) {
       _add_execute_actions_gsource (scenario);
 
@@ -1539,13 +1642,11 @@ static gboolean
 _check_position (GstValidateScenario * scenario, GstValidateAction * act,
     GstClockTime * position, gdouble * rate)
 {
-  GstQuery *query;
-
+  gboolean queried = FALSE;
   GstClockTime start_with_tolerance, stop_with_tolerance;
   GstValidateScenarioPrivate *priv = scenario->priv;
-  GstElement *pipeline;
 
-  if (!_get_position (scenario, act, position))
+  if (!_get_position (scenario, act, position, rate, &queried))
     return FALSE;
 
   GST_DEBUG_OBJECT (scenario, "Current position: %" GST_TIME_FORMAT,
@@ -1558,10 +1659,11 @@ _check_position (GstValidateScenario * scenario, GstValidateAction * act,
       GST_CLOCK_TIME_IS_VALID (priv->segment_stop) ? priv->segment_stop +
       priv->seek_pos_tol : -1;
 
-  if ((GST_CLOCK_TIME_IS_VALID (stop_with_tolerance)
-          && *position > stop_with_tolerance)
-      || (priv->seek_flags & GST_SEEK_FLAG_ACCURATE
-          && *position < start_with_tolerance)) {
+  /* Only check positions the pipeline actually reported */
+  if (queried && ((GST_CLOCK_TIME_IS_VALID (stop_with_tolerance)
+              && *position > stop_with_tolerance)
+          || (priv->seek_flags & GST_SEEK_FLAG_ACCURATE
+              && *position < start_with_tolerance))) {
 
     GST_VALIDATE_REPORT (scenario, QUERY_POSITION_OUT_OF_SEGMENT,
         "Current position %" GST_TIME_FORMAT " not in the expected range [%"
@@ -1570,19 +1672,6 @@ _check_position (GstValidateScenario * scenario, GstValidateAction * act,
         GST_TIME_ARGS (stop_with_tolerance));
   }
 
-  pipeline = gst_validate_scenario_get_pipeline (scenario);
-  if (pipeline == NULL) {
-    GST_INFO_OBJECT (scenario, "No pipeline set anymore");
-
-    return TRUE;
-  }
-
-  query = gst_query_new_segment (GST_FORMAT_DEFAULT);
-  if (gst_element_query (GST_ELEMENT (pipeline), query))
-    gst_query_parse_segment (query, rate, NULL, NULL, NULL);
-  gst_query_unref (query);
-  gst_object_unref (pipeline);
-
   if (priv->seeked_in_pause && priv->seek_flags & GST_SEEK_FLAG_ACCURATE) {
     if ((*rate > 0 && (*position >= priv->segment_start + priv->seek_pos_tol ||
                 *position < ((priv->segment_start <
@@ -1676,6 +1765,202 @@ no:
   return FALSE;
 }
 
+typedef struct
+{
+  gint refcount;
+  GWeakRef scenario;
+  guint seqnum;
+} ClockWaitData;
+
+static ClockWaitData *
+_clock_wait_data_ref (ClockWaitData * data)
+{
+  g_atomic_int_inc (&data->refcount);
+
+  return data;
+}
+
+static void
+_clock_wait_data_unref (ClockWaitData * data)
+{
+  if (g_atomic_int_dec_and_test (&data->refcount)) {
+    g_weak_ref_clear (&data->scenario);
+    g_slice_free (ClockWaitData, data);
+  }
+}
+
+static gboolean
+_clock_wait_done (ClockWaitData * data)
+{
+  gboolean waiting;
+  GstValidateScenario *scenario = g_weak_ref_get (&data->scenario);
+
+  if (!scenario)
+    return G_SOURCE_REMOVE;
+
+  SCENARIO_LOCK (scenario);
+  if (scenario->priv->clock_wait_seqnum != data->seqnum ||
+      !scenario->priv->clock_id) {
+    /* Cancelled in the meantime */
+    SCENARIO_UNLOCK (scenario);
+    gst_object_unref (scenario);
+
+    return G_SOURCE_REMOVE;
+  }
+
+  _cancel_clock_wait (scenario);
+  SCENARIO_UNLOCK (scenario);
+
+  GST_DEBUG_OBJECT (scenario, "Clock wait done, checking position");
+  execute_next_action (scenario);
+
+  /* Keep polling, as the execute_next_action gsource would have, unless
+   * we are waiting on the clock again */
+  SCENARIO_LOCK (scenario);
+  waiting = scenario->priv->clock_id != NULL;
+  SCENARIO_UNLOCK (scenario);
+
+  if (!waiting)
+    _add_execute_actions_gsource (scenario);
+  gst_object_unref (scenario);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Called from the clock thread, the scenario is only accessed from the main
+ * thread */
+static gboolean
+_clock_wait_cb (GstClock * clock, GstClockTime time, GstClockID id,
+    ClockWaitData * data)
+{
+  /* Unscheduled */
+  if (!GST_CLOCK_TIME_IS_VALID (time))
+    return TRUE;
+
+  g_main_context_invoke_full (NULL, G_PRIORITY_DEFAULT,
+      (GSourceFunc) _clock_wait_done, _clock_wait_data_ref (data),
+      (GDestroyNotify) _clock_wait_data_unref);
+
+  return TRUE;
+}
+
+/* Keeps checking that the position stays in the segment while waiting on
+ * the clock, at a lower rate than the execute_next_action gsource does */
+static gboolean
+_check_position_while_waiting (GstValidateScenario * scenario)
+{
+  gdouble rate;
+  GstClockTime position;
+  GstValidateAction *act = NULL;
+
+  if (scenario->priv->actions)
+    act = scenario->priv->actions->data;
+
+  _check_position (scenario, act, &position, &rate);
+
+  return G_SOURCE_CONTINUE;
+}
+
+/* Instead of polling the position until @act playback time is reached, wait
+ * on the pipeline clock for the time at which the position will have
+ * advanced up to it. Anything that can change that (seeks, rate, state or
+ * buffering changes) goes through _add_execute_actions_gsource(), which
+ * cancels the wait and falls back to polling, which in turn schedules a new
+ * wait from the new position. The position is still checked every
+ * CLOCK_WAIT_POSITION_CHECK_INTERVAL ms during the wait.
+ *
+ * Returns: %TRUE if a wait has been scheduled, in which case the
+ * execute_next_action gsource has been removed.
+ */
+static gboolean
+_schedule_action_on_clock (GstValidateScenario * scenario,
+    GstValidateAction * act, GstClockTime position, gdouble rate)
+{
+  GstClock *clock = NULL;
+  GstClockID id;
+  GstClockTime delta;
+  ClockWaitData *data;
+  gboolean res = FALSE;
+  GstValidateScenarioPrivate *priv = scenario->priv;
+  GstElement *pipeline;
+
+  if (!act || !GST_CLOCK_TIME_IS_VALID (act->playback_time) ||
+      !GST_CLOCK_TIME_IS_VALID (position) || priv->got_eos)
+    return FALSE;
+
+  if (rate > 0 && act->playback_time > position)
+    delta = (act->playback_time - position) / rate;
+  else if (rate < 0 && act->playback_time < position)
+    delta = (position - act->playback_time) / -rate;
+  else
+    return FALSE;
+
+  /* Polling is as precise for small delays */
+  if (delta <= priv->action_execution_interval * GST_MSECOND)
+    return FALSE;
+
+  pipeline = gst_validate_scenario_get_pipeline (scenario);
+  if (!pipeline)
+    return FALSE;
+
+  if (priv->target_state != GST_STATE_PLAYING ||
+      GST_STATE (pipeline) != GST_STATE_PLAYING ||
+      GST_STATE_PENDING (pipeline) != GST_STATE_VOID_PENDING)
+    goto done;
+
+  clock = gst_element_get_clock (pipeline);
+  if (!clock)
+    goto done;
+
+  id = gst_clock_new_single_shot_id (clock,
+      gst_clock_get_time (clock) + delta);
+
+  data = g_slice_new0 (ClockWaitData);
+  data->refcount = 1;
+  g_weak_ref_init (&data->scenario, scenario);
+
+  SCENARIO_LOCK (scenario);
+  _cancel_clock_wait (scenario);
+  priv->clock_id = gst_clock_id_ref (id);
+  data->seqnum = ++priv->clock_wait_seqnum;
+  if (priv->execute_actions_source_id) {
+    g_source_remove (priv->execute_actions_source_id);
+    priv->execute_actions_source_id = 0;
+  }
+  SCENARIO_UNLOCK (scenario);
+
+  if (gst_clock_id_wait_async (id, (GstClockCallback) _clock_wait_cb, data,
+          (GDestroyNotify) _clock_wait_data_unref) != GST_CLOCK_OK) {
+    GST_INFO_OBJECT (scenario, "Could not wait on %" GST_PTR_FORMAT, clock);
+
+    SCENARIO_LOCK (scenario);
+    if (priv->clock_id == id)
+      _cancel_clock_wait (scenario);
+    SCENARIO_UNLOCK (scenario);
+  } else {
+    GST_DEBUG_OBJECT (scenario, "Waiting %" GST_TIME_FORMAT " on the clock"
+        " to execute %s at %" GST_TIME_FORMAT, GST_TIME_ARGS (delta),
+        act->type, GST_TIME_ARGS (act->playback_time));
+
+    SCENARIO_LOCK (scenario);
+    if (priv->clock_id == id && !priv->position_check_id)
+      priv->position_check_id =
+          g_timeout_add (CLOCK_WAIT_POSITION_CHECK_INTERVAL,
+          (GSourceFunc) _check_position_while_waiting, scenario);
+    SCENARIO_UNLOCK (scenario);
+
+    res = TRUE;
+  }
+  gst_clock_id_unref (id);
+
+done:
+  if (clock)
+    gst_object_unref (clock);
+  gst_object_unref (pipeline);
+
+  return res;
+}
+
 GstValidateExecuteActionReturn
 gst_validate_execute_action (GstValidateActionType * action_type,
     GstValidateAction * action)
@@ -1998,7 +2283,8 @@ execute_next_action (GstValidateScenario * scenario)
     return G_SOURCE_CONTINUE;
 
   if (!_should_execute_action (scenario, act, position, rate)) {
-    _add_execute_actions_gsource (scenario);
+    if (!_schedule_action_on_clock (scenario, act, position, rate))
+      _add_execute_actions_gsource (scenario);
 
     return G_SOURCE_CONTINUE;
   }
@@ -2013,8 +2299,8 @@ execute_next_action (GstValidateScenario * scenario)
 
     if (repeat_expr) {
       act->repeat =
-          gst_validate_utils_parse_expression (repeat_expr,
-          _set_variable_func, scenario, &error);
+          _action_evaluate_expression (scenario, act, "repeat", repeat_expr,
+          &error);
     }
   }
 
@@ -3172,6 +3458,10 @@ gst_validate_scenario_dispose (GObject * object)
     gst_event_unref (priv->last_seek);
   g_weak_ref_clear (&priv->ref_pipeline);
 
+  SCENARIO_LOCK (GST_VALIDATE_SCENARIO (object));
+  _cancel_clock_wait (GST_VALIDATE_SCENARIO (object));
+  SCENARIO_UNLOCK (GST_VALIDATE_SCENARIO (object));
+
   if (priv->bus) {
     gst_bus_remove_signal_watch (priv->bus);
     gst_object_unref (priv->bus);
@@ -3408,65 +3698,236 @@ gst_validate_scenario_factory_create (GstValidateRunner *
   return scenario;
 }
 
+/* Listing scenarios is done from the information the scenarios cache holds
+ * about each file, only parsing the files that changed since the cache was
+ * written. An entry is (mtime, size, has-description, description fields,
+ * action types). The action types are kept rather than whether the scenario
+ * needs clock sync, as that depends on the plugins providing them */
+#define SCENARIOS_CACHE_VERSION 1
+#define SCENARIOS_CACHE_ENTRY_TYPE "(xxba{ss}as)"
+#define SCENARIOS_CACHE_TYPE "(ua{s" SCENARIOS_CACHE_ENTRY_TYPE "})"
+
+typedef struct
+{
+  gchar *path;
+  /* File path -> entry */
+  GHashTable *entries;
+  gboolean changed;
+} ScenariosCache;
+
+static void
+_scenarios_cache_init (ScenariosCache * cache)
+{
+  GMappedFile *file;
+  GVariant *content, *entry;
+  GVariantIter *iter;
+  GBytes *bytes;
+  const gchar *path;
+  guint version;
+
+  path = g_getenv ("GST_VALIDATE_SCENARIOS_CACHE");
+  if (path)
+    cache->path = g_strdup (path);
+  else
+    cache->path = g_build_filename (g_get_user_cache_dir (),
+        "gstreamer-" GST_API_VERSION, "validate-scenarios.bin", NULL);
+  cache->entries = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+      (GDestroyNotify) g_variant_unref);
+  cache->changed = FALSE;
+
+  file = g_mapped_file_new (cache->path, FALSE, NULL);
+  if (!file)
+    return;
+
+  bytes = g_mapped_file_get_bytes (file);
+  g_mapped_file_unref (file);
+  content = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE
+          (SCENARIOS_CACHE_TYPE), bytes, FALSE));
+  g_bytes_unref (bytes);
+
+  g_variant_get (content, "(ua{s" SCENARIOS_CACHE_ENTRY_TYPE "})", &version,
+      &iter);
+  if (version == SCENARIOS_CACHE_VERSION) {
+    while (g_variant_iter_next (iter, "{s@" SCENARIOS_CACHE_ENTRY_TYPE "}",
+            &path, &entry))
+      g_hash_table_insert (cache->entries, (gpointer) path, entry);
+  } else {
+    GST_INFO ("Ignoring scenarios cache %s with version %u", cache->path,
+        version);
+  }
+
+  g_variant_iter_free (iter);
+  g_variant_unref (content);
+}
+
+static void
+_scenarios_cache_save (ScenariosCache * cache)
+{
+  GHashTableIter iter;
+  GVariantBuilder builder;
+  GVariant *content, *entry;
+  GError *err = NULL;
+  const gchar *path;
+  gchar *dirname;
+
+  g_variant_builder_init (&builder,
+      G_VARIANT_TYPE ("a{s" SCENARIOS_CACHE_ENTRY_TYPE "}"));
+  g_hash_table_iter_init (&iter, cache->entries);
+  while (g_hash_table_iter_next (&iter, (gpointer *) & path,
+          (gpointer *) & entry)) {
+    /* Forget about removed scenarios */
+    if (g_file_test (path, G_FILE_TEST_IS_REGULAR))
+      g_variant_builder_add (&builder, "{s@" SCENARIOS_CACHE_ENTRY_TYPE "}",
+          path, entry);
+  }
+
+  content = g_variant_ref_sink (g_variant_new ("(u@a{s"
+          SCENARIOS_CACHE_ENTRY_TYPE "})", SCENARIOS_CACHE_VERSION,
+          g_variant_builder_end (&builder)));
+
+  dirname = g_path_get_dirname (cache->path);
+  g_mkdir_with_parents (dirname, 0700);
+  g_free (dirname);
+
+  /* Written atomically as other processes might have it mapped */
+  if (!g_file_set_contents (cache->path, g_variant_get_data (content),
+          g_variant_get_size (content), &err)) {
+    GST_INFO ("Could not write scenarios cache %s: %s", cache->path,
+        err->message);
+    g_clear_error (&err);
+  }
+
+  g_variant_unref (content);
+}
+
+static void
+_scenarios_cache_clear (ScenariosCache * cache)
+{
+  if (cache->changed)
+    _scenarios_cache_save (cache);
+
+  g_hash_table_unref (cache->entries);
+  g_free (cache->path);
+}
+
 static gboolean
-_add_description (GQuark field_id, const GValue * value, KeyFileGroupName * kfg)
+_add_description (GQuark field_id, const GValue * value,
+    GVariantBuilder * fields)
 {
   gchar *tmp = gst_value_serialize (value);
+  gchar *compressed = g_strcompress (tmp);
 
-  g_key_file_set_string (kfg->kf, kfg->group_name,
-      g_quark_to_string (field_id), g_strcompress (tmp));
+  g_variant_builder_add (fields, "{ss}", g_quark_to_string (field_id),
+      compressed);
 
+  g_free (compressed);
   g_free (tmp);
 
   return TRUE;
 }
 
+static GVariant *
+_scenarios_cache_entry_new (GFile * f, gint64 mtime, gint64 size)
+{
+  gboolean has_description = FALSE;
+  GVariantBuilder fields, action_types;
+  GList *tmp, *structures = gst_validate_structs_parse_from_gfile (f);
+
+  g_variant_builder_init (&fields, G_VARIANT_TYPE ("a{ss}"));
+  g_variant_builder_init (&action_types, G_VARIANT_TYPE ("as"));
+  for (tmp = structures; tmp; tmp = tmp->next) {
+    GstStructure *_struct = (GstStructure *) tmp->data;
+
+    if (!has_description && gst_structure_has_name (_struct, "description")) {
+      has_description = TRUE;
+      gst_structure_foreach (_struct,
+          (GstStructureForeachFunc) _add_description, &fields);
+    } else {
+      g_variant_builder_add (&action_types, "s",
+          gst_structure_get_name (_struct));
+    }
+  }
+  g_list_free_full (structures, (GDestroyNotify) gst_structure_free);
+
+  return g_variant_ref_sink (g_variant_new ("(xxb@a{ss}@as)", mtime, size,
+          has_description, g_variant_builder_end (&fields),
+          g_variant_builder_end (&action_types)));
+}
+
+/* Returns: (transfer full): the cache entry for @f, updated if needed */
+static GVariant *
+_scenarios_cache_get_entry (ScenariosCache * cache, GFile * f)
+{
+  GStatBuf status;
+  GVariant *entry = NULL;
+  gint64 mtime, size;
+  gchar *path = g_file_get_path (f);
+
+  if (!path || g_stat (path, &status) < 0) {
+    g_free (path);
+
+    return _scenarios_cache_entry_new (f, -1, -1);
+  }
+
+  entry = g_hash_table_lookup (cache->entries, path);
+  if (entry) {
+    g_variant_get (entry, "(xxba{ss}as)", &mtime, &size, NULL, NULL, NULL);
+    if (mtime == status.st_mtime && size == status.st_size) {
+      g_free (path);
+
+      return g_variant_ref (entry);
+    }
+  }
+
+  GST_DEBUG ("Parsing %s", path);
+  entry = _scenarios_cache_entry_new (f, status.st_mtime, status.st_size);
+  g_hash_table_insert (cache->entries, path, g_variant_ref (entry));
+  cache->changed = TRUE;
+
+  return entry;
+}
 
 static gboolean
-_parse_scenario (GFile * f, GKeyFile * kf)
+_parse_scenario (GFile * f, GKeyFile * kf, ScenariosCache * cache)
 {
   gboolean ret = FALSE;
   gchar *fname = g_file_get_basename (f);
 
   if (g_str_has_suffix (fname, GST_VALIDATE_SCENARIO_SUFFIX)) {
-    gboolean needs_clock_sync = FALSE;
-    GstStructure *desc = NULL;
-
+    GVariantIter *iter;
+    gboolean has_description, needs_clock_sync = FALSE;
+    const gchar *field, *value;
     gchar **name = g_strsplit (fname, GST_VALIDATE_SCENARIO_SUFFIX, 0);
-    GList *tmp, *structures = gst_validate_structs_parse_from_gfile (f);
+    GVariant *entry = _scenarios_cache_get_entry (cache, f);
 
-    for (tmp = structures; tmp; tmp = tmp->next) {
-      GstStructure *_struct = (GstStructure *) tmp->data;
-      GstValidateActionType *type =
-          _find_action_type (gst_structure_get_name (_struct));
+    g_variant_get (entry, "(xxba{ss}as)", NULL, NULL, &has_description, NULL,
+        &iter);
+    while (g_variant_iter_next (iter, "&s", &value)) {
+      GstValidateActionType *type = _find_action_type (value);
 
-      if (!desc && gst_structure_has_name (_struct, "description"))
-        desc = gst_structure_copy (_struct);
-      else if (type && type->flags & GST_VALIDATE_ACTION_TYPE_NEEDS_CLOCK)
+      if (type && type->flags & GST_VALIDATE_ACTION_TYPE_NEEDS_CLOCK) {
         needs_clock_sync = TRUE;
+        break;
+      }
     }
-
-    if (needs_clock_sync) {
-      if (desc)
-        gst_structure_set (desc, "need-clock-sync", G_TYPE_BOOLEAN, TRUE, NULL);
-      else
-        desc = gst_structure_from_string ("description, need-clock-sync=true;",
-            NULL);
+    g_variant_iter_free (iter);
+
+    if (has_description) {
+      g_variant_get (entry, "(xxba{ss}as)", NULL, NULL, NULL, &iter, NULL);
+      while (g_variant_iter_next (iter, "{&s&s}", &field, &value)) {
+        if (needs_clock_sync && !g_strcmp0 (field, "need-clock-sync"))
+          value = "true";
+        g_key_file_set_string (kf, name[0], field, value);
+      }
+      g_variant_iter_free (iter);
     }
 
-    if (desc) {
-      KeyFileGroupName kfg;
-
-      kfg.group_name = name[0];
-      kfg.kf = kf;
-
-      gst_structure_foreach (desc,
-          (GstStructureForeachFunc) _add_description, &kfg);
-      gst_structure_free (desc);
-    } else {
+    if (needs_clock_sync)
+      g_key_file_set_string (kf, name[0], "need-clock-sync", "true");
+    else if (!has_description)
       g_key_file_set_string (kf, name[0], "noinfo", "nothing");
-    }
-    g_list_free_full (structures, (GDestroyNotify) gst_structure_free);
+
+    g_variant_unref (entry);
     g_strfreev (name);
 
     ret = TRUE;
@@ -3477,7 +3938,7 @@ _parse_scenario (GFile * f, GKeyFile * kf)
 }
 
 static void
-_list_scenarios_in_dir (GFile * dir, GKeyFile * kf)
+_list_scenarios_in_dir (GFile * dir, GKeyFile * kf, ScenariosCache * cache)
 {
   GFileEnumerator *fenum;
   GFileInfo *info;
@@ -3492,7 +3953,7 @@ _list_scenarios_in_dir (GFile * dir, GKeyFile * kf)
       info; info = g_file_enumerator_next_file (fenum, NULL, NULL)) {
     GFile *f = g_file_enumerator_get_child (fenum, info);
 
-    _parse_scenario (f, kf);
+    _parse_scenario (f, kf, cache);
     gst_object_unref (f);
   }
 
@@ -3515,7 +3976,9 @@ gst_validate_list_scenarios (gchar ** scenarios, gint num_scenarios,
       "gstreamer-" GST_API_VERSION, "validate", GST_VALIDATE_SCENARIO_DIRECTORY,
       NULL);
   GFile *dir = g_file_new_for_path (tldir);
+  ScenariosCache cache;
 
+  _scenarios_cache_init (&cache);
   kf = g_key_file_new ();
   if (num_scenarios > 0) {
     gint i;
@@ -3523,7 +3986,7 @@ gst_validate_list_scenarios (gchar ** scenarios, gint num_scenarios,
 
     for (i = 0; i < num_scenarios; i++) {
       file = g_file_new_for_path (scenarios[i]);
-      if (!_parse_scenario (file, kf)) {
+      if (!_parse_scenario (file, kf, &cache)) {
         GST_ERROR ("Could not parse scenario: %s", scenarios[i]);
 
         gst_object_unref (file);
@@ -3538,14 +4001,14 @@ gst_validate_list_scenarios (gchar ** scenarios, gint num_scenarios,
   if (envvar)
     env_scenariodir = g_strsplit (envvar, ":", 0);
 
-  _list_scenarios_in_dir (dir, kf);
+  _list_scenarios_in_dir (dir, kf, &cache);
   g_object_unref (dir);
   g_free (tldir);
 
   tldir = g_build_filename (GST_DATADIR, "gstreamer-" GST_API_VERSION,
       "validate", GST_VALIDATE_SCENARIO_DIRECTORY, NULL);
   dir = g_file_new_for_path (tldir);
-  _list_scenarios_in_dir (dir, kf);
+  _list_scenarios_in_dir (dir, kf, &cache);
   g_object_unref (dir);
   g_free (tldir);
 
@@ -3554,14 +4017,14 @@ gst_validate_list_scenarios (gchar ** scenarios, gint num_scenarios,
 
     for (i = 0; env_scenariodir[i]; i++) {
       dir = g_file_new_for_path (env_scenariodir[i]);
-      _list_scenarios_in_dir (dir, kf);
+      _list_scenarios_in_dir (dir, kf, &cache);
       g_object_unref (dir);
     }
   }
 
   /* Hack to make it work uninstalled */
   dir = g_file_new_for_path ("data/scenarios");
-  _list_scenarios_in_dir (dir, kf);
+  _list_scenarios_in_dir (dir, kf, &cache);
   g_object_unref (dir);
 
 done:
@@ -3584,10 +4047,51 @@ done:
   }
 
   g_key_file_free (kf);
+  _scenarios_cache_clear (&cache);
 
   return res;
 }
 
+G_LOCK_DEFINE_STATIC (scenarios_override);
+static gchar *scenarios_override = NULL;
+
+/**
+ * gst_validate_set_scenarios:
+ * @scenarios: (allow-none): The scenarios to run, in the format of the
+ * GST_VALIDATE_SCENARIO environment variable, or %NULL
+ *
+ * Sets the scenarios to run on the pipelines monitored from now on instead
+ * of the ones listed in GST_VALIDATE_SCENARIO, %NULL meaning that the
+ * environment variable is used again.
+ *
+ * Unlike the environment, this can safely be changed once threads are
+ * running, for example to run several tests in the same process.
+ */
+void
+gst_validate_set_scenarios (const gchar * scenarios)
+{
+  G_LOCK (scenarios_override);
+  g_free (scenarios_override);
+  scenarios_override = g_strdup (scenarios);
+  G_UNLOCK (scenarios_override);
+}
+
+/* Returns the scenarios to run, see gst_validate_set_scenarios () */
+gchar *
+gst_validate_get_scenarios (void)
+{
+  gchar *scenarios;
+
+  G_LOCK (scenarios_override);
+  if (scenarios_override)
+    scenarios = g_strdup (scenarios_override);
+  else
+    scenarios = g_strdup (g_getenv ("GST_VALIDATE_SCENARIO"));
+  G_UNLOCK (scenarios_override);
+
+  return scenarios;
+}
+
 static GstValidateExecuteActionReturn
 _check_last_sample_checksum (GstValidateScenario * scenario,
     GstValidateAction * action, GstElement * sink)
@@ -268,6 +268,9 @@ gst_validate_list_scenarios       (gchar **scenarios,
                                    gint num_scenarios,
                                    gchar * output_file);
 
+GST_VALIDATE_API void
+gst_validate_set_scenarios        (const gchar *scenarios);
+
 GST_VALIDATE_API GstValidateActionType *
 gst_validate_get_action_type           (const gchar *type_name);
 
@@ -27,6 +27,7 @@
 #include<stdlib.h>
 
 #include "gst-validate-utils.h"
+#include "gst-validate-internal.h"
 #include <gst/gst.h>
 
 #define PARSER_BOOLEAN_EQUALITY_THRESHOLD (1e-10)
@@ -35,6 +36,45 @@
 
 static GRegex *_clean_structs_lines = NULL;
 
+typedef enum
+{
+  EXPRESSION_OP_CONSTANT,
+  EXPRESSION_OP_VARIABLE,
+  EXPRESSION_OP_NEG,
+  EXPRESSION_OP_ADD,
+  EXPRESSION_OP_SUB,
+  EXPRESSION_OP_MUL,
+  EXPRESSION_OP_DIV,
+  EXPRESSION_OP_POW,
+  EXPRESSION_OP_LT,
+  EXPRESSION_OP_GT,
+  EXPRESSION_OP_LE,
+  EXPRESSION_OP_GE,
+  EXPRESSION_OP_EQ,
+  EXPRESSION_OP_NE,
+  EXPRESSION_OP_AND,
+  EXPRESSION_OP_OR,
+  EXPRESSION_OP_MIN,
+  EXPRESSION_OP_MAX,
+} ExpressionOpCode;
+
+typedef struct
+{
+  ExpressionOpCode code;
+  gdouble value;                /* EXPRESSION_OP_CONSTANT */
+  guint variable;               /* EXPRESSION_OP_VARIABLE */
+} ExpressionOp;
+
+/* Expressions are compiled to a program for a stack machine, operations
+ * popping their operands and pushing their result */
+struct _GstValidateExpression
+{
+  GArray *ops;
+  /* Variable names, indexed by the variable slots */
+  GPtrArray *variables;
+  guint stack_size;
+};
+
 typedef struct
 {
   const gchar *str;
@@ -42,11 +82,12 @@ typedef struct
   gint pos;
   jmp_buf err_jmp_buf;
   const gchar *error;
-  void *user_data;
-  GstValidateParseVariableFunc variable_func;
+  GstValidateExpression *expression;
+  guint depth;
 } MathParser;
 
-static gdouble _read_power (MathParser * parser);
+static void _read_power (MathParser * parser);
+static void _read_boolean_or (MathParser * parser);
 
 static void
 _error (MathParser * parser, const gchar * err)
@@ -82,6 +123,53 @@ _next (MathParser * parser)
   return '\0';
 }
 
+static void
+_emit_op (MathParser * parser, ExpressionOp * op)
+{
+  GstValidateExpression *expression = parser->expression;
+
+  if (op->code == EXPRESSION_OP_CONSTANT || op->code == EXPRESSION_OP_VARIABLE)
+    parser->depth++;
+  else if (op->code != EXPRESSION_OP_NEG)
+    parser->depth--;
+
+  expression->stack_size = MAX (expression->stack_size, parser->depth);
+  g_array_append_val (expression->ops, *op);
+}
+
+static void
+_emit (MathParser * parser, ExpressionOpCode code)
+{
+  ExpressionOp op = { code, 0.0, 0 };
+
+  _emit_op (parser, &op);
+}
+
+static void
+_emit_constant (MathParser * parser, gdouble value)
+{
+  ExpressionOp op = { EXPRESSION_OP_CONSTANT, value, 0 };
+
+  _emit_op (parser, &op);
+}
+
+static void
+_emit_variable (MathParser * parser, const gchar * name)
+{
+  GPtrArray *variables = parser->expression->variables;
+  ExpressionOp op = { EXPRESSION_OP_VARIABLE, 0.0, 0 };
+
+  for (op.variable = 0; op.variable < variables->len; op.variable++) {
+    if (!g_strcmp0 (g_ptr_array_index (variables, op.variable), name))
+      break;
+  }
+
+  if (op.variable == variables->len)
+    g_ptr_array_add (variables, g_strdup (name));
+
+  _emit_op (parser, &op);
+}
+
 static gdouble
 _read_double (MathParser * parser)
 {
@@ -124,67 +212,54 @@ _read_double (MathParser * parser)
   return val;
 }
 
-static gdouble
+static void
 _read_term (MathParser * parser)
 {
-  gdouble v0;
   gchar c;
 
-  v0 = _read_power (parser);
+  _read_power (parser);
   c = _peek (parser);
 
   while (c == '*' || c == '/') {
     _next (parser);
-    if (c == '*') {
-      v0 *= _read_power (parser);
-    } else if (c == '/') {
-      v0 /= _read_power (parser);
-    }
+    _read_power (parser);
+    _emit (parser, c == '*' ? EXPRESSION_OP_MUL : EXPRESSION_OP_DIV);
     c = _peek (parser);
   }
-  return v0;
 }
 
-static gdouble
+static void
 _read_expr (MathParser * parser)
 {
-  gdouble v0 = 0.0;
   gchar c;
 
   c = _peek (parser);
   if (c == '+' || c == '-') {
     _next (parser);
-    if (c == '+')
-      v0 += _read_term (parser);
-    else if (c == '-')
-      v0 -= _read_term (parser);
+    _emit_constant (parser, 0.0);
+    _read_term (parser);
+    _emit (parser, c == '+' ? EXPRESSION_OP_ADD : EXPRESSION_OP_SUB);
   } else {
-    v0 = _read_term (parser);
+    _read_term (parser);
   }
 
   c = _peek (parser);
   while (c == '+' || c == '-') {
     _next (parser);
-    if (c == '+') {
-      v0 += _read_term (parser);
-    } else if (c == '-') {
-      v0 -= _read_term (parser);
-    }
+    _read_term (parser);
+    _emit (parser, c == '+' ? EXPRESSION_OP_ADD : EXPRESSION_OP_SUB);
 
     c = _peek (parser);
   }
-
-  return v0;
 }
 
-static gdouble
+static void
 _read_boolean_comparison (MathParser * parser)
 {
   gchar c, oper[] = { '\0', '\0', '\0' };
-  gdouble v0, v1;
 
 
-  v0 = _read_expr (parser);
+  _read_expr (parser);
   c = _peek (parser);
   if (c == '>' || c == '<') {
     oper[0] = _next (parser);
@@ -193,30 +268,28 @@ _read_boolean_comparison (MathParser * parser)
       oper[1] = _next (parser);
 
 
-    v1 = _read_expr (parser);
+    _read_expr (parser);
 
     if (g_strcmp0 (oper, "<") == 0) {
-      v0 = (v0 < v1) ? 1.0 : 0.0;
+      _emit (parser, EXPRESSION_OP_LT);
     } else if (g_strcmp0 (oper, ">") == 0) {
-      v0 = (v0 > v1) ? 1.0 : 0.0;
+      _emit (parser, EXPRESSION_OP_GT);
     } else if (g_strcmp0 (oper, "<=") == 0) {
-      v0 = (v0 <= v1) ? 1.0 : 0.0;
+      _emit (parser, EXPRESSION_OP_LE);
     } else if (g_strcmp0 (oper, ">=") == 0) {
-      v0 = (v0 >= v1) ? 1.0 : 0.0;
+      _emit (parser, EXPRESSION_OP_GE);
     } else {
       _error (parser, "Unknown operation!");
     }
   }
-  return v0;
 }
 
-static gdouble
+static void
 _read_boolean_equality (MathParser * parser)
 {
   gchar c, oper[] = { '\0', '\0', '\0' };
-  gdouble v0, v1;
 
-  v0 = _read_boolean_comparison (parser);
+  _read_boolean_comparison (parser);
   c = _peek (parser);
   if (c == '=' || c == '!') {
     if (c == '!') {
@@ -224,7 +297,7 @@ _read_boolean_equality (MathParser * parser)
         oper[0] = _next (parser);
         oper[1] = _next (parser);
       } else {
-        return v0;
+        return;
       }
     } else {
       oper[0] = _next (parser);
@@ -233,25 +306,23 @@ _read_boolean_equality (MathParser * parser)
         _error (parser, "Expected a '=' for boolean '==' operator!");
       oper[1] = _next (parser);
     }
-    v1 = _read_boolean_comparison (parser);
+    _read_boolean_comparison (parser);
     if (g_strcmp0 (oper, "==") == 0) {
-      v0 = (fabs (v0 - v1) < PARSER_BOOLEAN_EQUALITY_THRESHOLD) ? 1.0 : 0.0;
+      _emit (parser, EXPRESSION_OP_EQ);
     } else if (g_strcmp0 (oper, "!=") == 0) {
-      v0 = (fabs (v0 - v1) > PARSER_BOOLEAN_EQUALITY_THRESHOLD) ? 1.0 : 0.0;
+      _emit (parser, EXPRESSION_OP_NE);
     } else {
       _error (parser, "Unknown operation!");
     }
   }
-  return v0;
 }
 
-static gdouble
+static void
 _read_boolean_and (MathParser * parser)
 {
   gchar c;
-  gdouble v0, v1;
 
-  v0 = _read_boolean_equality (parser);
+  _read_boolean_equality (parser);
 
   c = _peek (parser);
   while (c == '&') {
@@ -262,23 +333,19 @@ _read_boolean_and (MathParser * parser)
       _error (parser, "Expected '&' to follow '&' in logical and operation!");
     _next (parser);
 
-    v1 = _read_boolean_equality (parser);
-    v0 = (fabs (v0) >= PARSER_BOOLEAN_EQUALITY_THRESHOLD
-        && fabs (v1) >= PARSER_BOOLEAN_EQUALITY_THRESHOLD) ? 1.0 : 0.0;
+    _read_boolean_equality (parser);
+    _emit (parser, EXPRESSION_OP_AND);
 
     c = _peek (parser);
   }
-
-  return v0;
 }
 
-static gdouble
+static void
 _read_boolean_or (MathParser * parser)
 {
   gchar c;
-  gdouble v0, v1;
 
-  v0 = _read_boolean_and (parser);
+  _read_boolean_and (parser);
 
   c = _peek (parser);
   while (c == '|') {
@@ -287,64 +354,55 @@ _read_boolean_or (MathParser * parser)
     if (c != '|')
       _error (parser, "Expected '|' to follow '|' in logical or operation!");
     _next (parser);
-    v1 = _read_boolean_and (parser);
-    v0 = (fabs (v0) >= PARSER_BOOLEAN_EQUALITY_THRESHOLD
-        || fabs (v1) >= PARSER_BOOLEAN_EQUALITY_THRESHOLD) ? 1.0 : 0.0;
+    _read_boolean_and (parser);
+    _emit (parser, EXPRESSION_OP_OR);
     c = _peek (parser);
   }
-
-  return v0;
 }
 
 static gboolean
 _init (MathParser * parser, const gchar * str,
-    GstValidateParseVariableFunc variable_func, void *user_data)
+    GstValidateExpression * expression)
 {
   parser->str = str;
   parser->len = strlen (str) + 1;
   parser->pos = 0;
   parser->error = NULL;
-  parser->user_data = user_data;
-  parser->variable_func = variable_func;
+  parser->expression = expression;
+  parser->depth = 0;
 
   return TRUE;
 }
 
-static gdouble
+static gboolean
 _parse (MathParser * parser)
 {
-  gdouble result = 0.0;
-
   if (!setjmp (parser->err_jmp_buf)) {
-    result = _read_expr (parser);
+    _read_expr (parser);
     if (parser->pos < parser->len - 1) {
       _error (parser,
           "Failed to reach end of input expression, likely malformed input");
     } else
-      return result;
+      return TRUE;
   }
 
-  return -1.0;
+  return FALSE;
 }
 
-static gdouble
+static void
 _read_argument (MathParser * parser)
 {
   gchar c;
-  gdouble val;
 
-  val = _read_expr (parser);
+  _read_expr (parser);
   c = _peek (parser);
   if (c == ',')
     _next (parser);
-
-  return val;
 }
 
-static gdouble
+static void
 _read_builtin (MathParser * parser)
 {
-  gdouble v0 = 0.0, v1 = 0.0;
   gchar c, token[PARSER_MAX_TOKEN_SIZE];
   gint pos = 0;
 
@@ -359,13 +417,13 @@ _read_builtin (MathParser * parser)
     if (_peek (parser) == '(') {
       _next (parser);
       if (g_strcmp0 (token, "min") == 0) {
-        v0 = _read_argument (parser);
-        v1 = _read_argument (parser);
-        v0 = MIN (v0, v1);
+        _read_argument (parser);
+        _read_argument (parser);
+        _emit (parser, EXPRESSION_OP_MIN);
       } else if (g_strcmp0 (token, "max") == 0) {
-        v0 = _read_argument (parser);
-        v1 = _read_argument (parser);
-        v0 = MAX (v0, v1);
+        _read_argument (parser);
+        _read_argument (parser);
+        _emit (parser, EXPRESSION_OP_MAX);
       } else {
         _error (parser, "Tried to call unknown built-in function!");
       }
@@ -373,94 +431,100 @@ _read_builtin (MathParser * parser)
       if (_next (parser) != ')')
         _error (parser, "Expected ')' in built-in call!");
     } else {
-      if (parser->variable_func != NULL
-          && parser->variable_func (token, &v1, parser->user_data)) {
-        v0 = v1;
-      } else {
-        _error (parser, "Could not look up value for variable %s!");
-      }
+      /* Looked up when evaluating the expression */
+      _emit_variable (parser, token);
     }
   } else {
-    v0 = _read_double (parser);
+    _emit_constant (parser, _read_double (parser));
   }
-
-  return v0;
 }
 
-static gdouble
+static void
 _read_parenthesis (MathParser * parser)
 {
-  gdouble val;
-
   if (_peek (parser) == '(') {
     _next (parser);
-    val = _read_boolean_or (parser);
+    _read_boolean_or (parser);
     if (_peek (parser) != ')')
       _error (parser, "Expected ')'!");
     _next (parser);
   } else {
-    val = _read_builtin (parser);
+    _read_builtin (parser);
   }
-
-  return val;
 }
 
-static gdouble
+static void
 _read_unary (MathParser * parser)
 {
   gchar c;
-  gdouble v0 = 0.0;
 
   c = _peek (parser);
   if (c == '!') {
     _error (parser, "Expected '+' or '-' for unary expression, got '!'");
   } else if (c == '-') {
     _next (parser);
-    v0 = -_read_parenthesis (parser);
+    _read_parenthesis (parser);
+    _emit (parser, EXPRESSION_OP_NEG);
   } else if (c == '+') {
     _next (parser);
-    v0 = _read_parenthesis (parser);
+    _read_parenthesis (parser);
   } else {
-    v0 = _read_parenthesis (parser);
+    _read_parenthesis (parser);
   }
-  return v0;
 }
 
-static gdouble
+static void
 _read_power (MathParser * parser)
 {
-  gdouble v0, v1 = 1.0, s = 1.0;
+  gboolean negate = FALSE;
 
-  v0 = _read_unary (parser);
+  _read_unary (parser);
 
   while (_peek (parser) == '^') {
     _next (parser);
     if (_peek (parser) == '-') {
       _next (parser);
-      s = -1.0;
+      negate = TRUE;
     }
-    v1 = s * _read_power (parser);
-    v0 = pow (v0, v1);
+    _read_power (parser);
+    if (negate)
+      _emit (parser, EXPRESSION_OP_NEG);
+    _emit (parser, EXPRESSION_OP_POW);
   }
-
-  return v0;
 }
 
 /**
- * gst_validate_utils_parse_expression: (skip):
+ * gst_validate_expression_compile: (skip):
+ * @expr: The expression to compile
+ * @error: (out) (optional): The parsing error, if any
+ *
+ * Compiles @expr so that it can then be evaluated many times with
+ * #gst_validate_expression_evaluate without parsing it again.
+ *
+ * Returns: (transfer full) (nullable): The compiled expression, %NULL if
+ * @expr could not be parsed
  */
-gdouble
-gst_validate_utils_parse_expression (const gchar * expr,
-    GstValidateParseVariableFunc variable_func, gpointer user_data,
-    gchar ** error)
+GstValidateExpression *
+gst_validate_expression_compile (const gchar * expr, gchar ** error)
 {
-  gdouble val;
   MathParser parser;
-  gchar **spl = g_strsplit (expr, " ", -1);
-  gchar *expr_nospace = g_strjoinv ("", spl);
-
-  _init (&parser, expr_nospace, variable_func, user_data);
-  val = _parse (&parser);
+  GstValidateExpression *expression;
+  gchar **spl;
+  gchar *expr_nospace;
+
+  g_return_val_if_fail (expr, NULL);
+
+  spl = g_strsplit (expr, " ", -1);
+  expr_nospace = g_strjoinv ("", spl);
+  expression = g_new0 (GstValidateExpression, 1);
+  expression->ops = g_array_new (FALSE, FALSE, sizeof (ExpressionOp));
+  expression->variables = g_ptr_array_new_with_free_func (g_free);
+
+  _init (&parser, expr_nospace, expression);
+  if (!_parse (&parser)) {
+    gst_validate_expression_free (expression);
+    expression = NULL;
+  }
   g_strfreev (spl);
   g_free (expr_nospace);
 
@@ -470,6 +534,165 @@ gst_validate_utils_parse_expression (const gchar * expr,
     else
       *error = NULL;
   }
+
+  return expression;
+}
+
+/**
+ * gst_validate_expression_evaluate: (skip):
+ * @expression: The #GstValidateExpression to evaluate
+ * @variable_func: (allow-none): The function used to get the value of the
+ * variables the expression references
+ * @user_data: The user data passed to @variable_func
+ * @error: (out) (optional): The evaluation error, if any
+ *
+ * Evaluates @expression. @variable_func is only called for the variables
+ * the expression actually uses, once per variable.
+ *
+ * Returns: The value of the expression, or -1.0 if a variable could not be
+ * looked up
+ */
+gdouble
+gst_validate_expression_evaluate (GstValidateExpression * expression,
+    GstValidateParseVariableFunc variable_func, gpointer user_data,
+    gchar ** error)
+{
+  guint i, sp = 0, n_variables;
+  gdouble *stack, *values, v1;
+  gboolean *fetched;
+
+  g_return_val_if_fail (expression, -1.0);
+
+  if (error)
+    *error = NULL;
+
+  n_variables = expression->variables->len;
+  stack = g_newa (gdouble, expression->stack_size);
+  values = g_newa (gdouble, n_variables);
+  fetched = g_newa (gboolean, n_variables);
+  memset (fetched, 0, n_variables * sizeof (gboolean));
+
+  for (i = 0; i < expression->ops->len; i++) {
+    ExpressionOp *op = &g_array_index (expression->ops, ExpressionOp, i);
+
+    switch (op->code) {
+      case EXPRESSION_OP_CONSTANT:
+        stack[sp++] = op->value;
+        continue;
+      case EXPRESSION_OP_VARIABLE:
+        if (!fetched[op->variable]) {
+          const gchar *name =
+              g_ptr_array_index (expression->variables, op->variable);
+
+          if (variable_func == NULL
+              || !variable_func (name, &values[op->variable], user_data)) {
+            if (error)
+              *error = g_strdup_printf ("Could not look up value for"
+                  " variable %s!", name);
+
+            return -1.0;
+          }
+          fetched[op->variable] = TRUE;
+        }
+        stack[sp++] = values[op->variable];
+        continue;
+      case EXPRESSION_OP_NEG:
+        stack[sp - 1] = -stack[sp - 1];
+        continue;
+      default:
+        break;
+    }
+
+    v1 = stack[--sp];
+    switch (op->code) {
+      case EXPRESSION_OP_ADD:
+        stack[sp - 1] += v1;
+        break;
+      case EXPRESSION_OP_SUB:
+        stack[sp - 1] -= v1;
+        break;
+      case EXPRESSION_OP_MUL:
+        stack[sp - 1] *= v1;
+        break;
+      case EXPRESSION_OP_DIV:
+        stack[sp - 1] /= v1;
+        break;
+      case EXPRESSION_OP_POW:
+        stack[sp - 1] = pow (stack[sp - 1], v1);
+        break;
+      case EXPRESSION_OP_LT:
+        stack[sp - 1] = (stack[sp - 1] < v1) ? 1.0 : 0.0;
+        break;
+      case EXPRESSION_OP_GT:
+        stack[sp - 1] = (stack[sp - 1] > v1) ? 1.0 : 0.0;
+        break;
+      case EXPRESSION_OP_LE:
+        stack[sp - 1] = (stack[sp - 1] <= v1) ? 1.0 : 0.0;
+        break;
+      case EXPRESSION_OP_GE:
+        stack[sp - 1] = (stack[sp - 1] >= v1) ? 1.0 : 0.0;
+        break;
+      case EXPRESSION_OP_EQ:
+        stack[sp - 1] = (fabs (stack[sp - 1] - v1) <
+            PARSER_BOOLEAN_EQUALITY_THRESHOLD) ? 1.0 : 0.0;
+        break;
+      case EXPRESSION_OP_NE:
+        stack[sp - 1] = (fabs (stack[sp - 1] - v1) >
+            PARSER_BOOLEAN_EQUALITY_THRESHOLD) ? 1.0 : 0.0;
+        break;
+      case EXPRESSION_OP_AND:
+        stack[sp - 1] = (fabs (stack[sp - 1]) >= PARSER_BOOLEAN_EQUALITY_THRESHOLD
+            && fabs (v1) >= PARSER_BOOLEAN_EQUALITY_THRESHOLD) ? 1.0 : 0.0;
+        break;
+      case EXPRESSION_OP_OR:
+        stack[sp - 1] = (fabs (stack[sp - 1]) >= PARSER_BOOLEAN_EQUALITY_THRESHOLD
+            || fabs (v1) >= PARSER_BOOLEAN_EQUALITY_THRESHOLD) ? 1.0 : 0.0;
+        break;
+      case EXPRESSION_OP_MIN:
+        stack[sp - 1] = MIN (stack[sp - 1], v1);
+        break;
+      case EXPRESSION_OP_MAX:
+        stack[sp - 1] = MAX (stack[sp - 1], v1);
+        break;
+      default:
+        g_assert_not_reached ();
+    }
+  }
+
+  return stack[0];
+}
+
+/**
+ * gst_validate_expression_free: (skip):
+ * @expression: The #GstValidateExpression to free
+ */
+void
+gst_validate_expression_free (GstValidateExpression * expression)
+{
+  g_array_unref (expression->ops);
+  g_ptr_array_unref (expression->variables);
+  g_free (expression);
+}
+
+/**
+ * gst_validate_utils_parse_expression: (skip):
+ */
+gdouble
+gst_validate_utils_parse_expression (const gchar * expr,
+    GstValidateParseVariableFunc variable_func, gpointer user_data,
+    gchar ** error)
+{
+  gdouble val;
+  GstValidateExpression *expression =
+      gst_validate_expression_compile (expr, error);
+
+  if (!expression)
+    return -1.0;
+
+  val = gst_validate_expression_evaluate (expression, variable_func, user_data,
+      error);
+  gst_validate_expression_free (expression);
+
   return val;
 }
 
@@ -653,42 +876,65 @@ gst_validate_structs_parse_from_gfile (GFile * scenario_file)
   return _lines_get_structures (lines);
 }
 
+/* Whether the '/' separated @klass list contains the @len first
+ * characters of @part as one of its items */
 static gboolean
-strv_contains (GStrv strv, const gchar * str)
+_klass_has_item (const gchar * klass, const gchar * part, gsize len)
 {
-  guint i;
+  const gchar *end;
 
-  for (i = 0; strv[i] != NULL; i++)
-    if (g_strcmp0 (strv[i], str) == 0)
+  if (*klass == '\0')
+    return FALSE;
+
+  for (;;) {
+    end = strchr (klass, '/');
+    if (end == NULL)
+      end = klass + strlen (klass);
+
+    if ((gsize) (end - klass) == len && strncmp (klass, part, len) == 0)
       return TRUE;
 
-  return FALSE;
+    if (*end == '\0')
+      return FALSE;
+
+    klass = end + 1;
+  }
+}
+
+/* Whether all the items of the '/' separated @klass list are items of
+ * @element_klass, without splitting any of them */
+gboolean
+gst_validate_klass_contains (const gchar * element_klass, const gchar * klass)
+{
+  const gchar *end;
+
+  if (*klass == '\0')
+    return TRUE;
+
+  for (;;) {
+    end = strchr (klass, '/');
+    if (end == NULL)
+      end = klass + strlen (klass);
+
+    if (!_klass_has_item (element_klass, klass, end - klass))
+      return FALSE;
+
+    if (*end == '\0')
+      return TRUE;
+
+    klass = end + 1;
+  }
 }
 
 gboolean
 gst_validate_element_has_klass (GstElement * element, const gchar * klass)
 {
   const gchar *tmp;
-  gchar **a, **b;
-  gboolean result = FALSE;
-  guint i;
 
   tmp = gst_element_class_get_metadata (GST_ELEMENT_GET_CLASS (element),
       GST_ELEMENT_METADATA_KLASS);
 
-  a = g_strsplit (klass, "/", -1);
-  b = g_strsplit (tmp, "/", -1);
-
-  /* All the elements in 'a' have to be in 'b' */
-  for (i = 0; a[i] != NULL; i++)
-    if (!strv_contains (b, a[i]))
-      goto done;
-  result = TRUE;
-
-done:
-  g_strfreev (a);
-  g_strfreev (b);
-  return result;
+  return gst_validate_klass_contains (tmp ? tmp : "", klass);
 }
 
 /**
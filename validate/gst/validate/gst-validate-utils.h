@@ -39,6 +39,19 @@ gdouble gst_validate_utils_parse_expression (const gchar *expr,
                                              GstValidateParseVariableFunc variable_func,
                                              gpointer user_data,
                                              gchar **error);
+
+typedef struct _GstValidateExpression GstValidateExpression;
+
+GST_VALIDATE_API
+GstValidateExpression * gst_validate_expression_compile  (const gchar *expr,
+                                                          gchar **error);
+GST_VALIDATE_API
+gdouble gst_validate_expression_evaluate                 (GstValidateExpression *expression,
+                                                          GstValidateParseVariableFunc variable_func,
+                                                          gpointer user_data,
+                                                          gchar **error);
+GST_VALIDATE_API
+void gst_validate_expression_free                        (GstValidateExpression *expression);
 GST_VALIDATE_API
 guint gst_validate_utils_flags_from_str     (GType type, const gchar * str_flags);
 GST_VALIDATE_API
@@ -0,0 +1,627 @@
+/* GStreamer
+ *
+ * media-descriptor-binary.c - Binary media descriptors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* The binary media descriptor format is meant to be mapped in memory, the
+ * frames of each stream are stored column by column, the same way as in
+ * #GstValidateMediaFrameTable, so loading them is a plain copy.
+ *
+ * Everything before the frames is the index, which is all the launcher
+ * needs to read. All integers are little endian, doubles are stored as
+ * their IEEE 754 representation and strings as offsets in the string pool,
+ * 0 meaning no string.
+ *
+ * Header (56 bytes):
+ *   0: magic "\211GSTVMI\n"
+ *   8: u32 version
+ *  12: u32 index size, the frames start after it, aligned on 8 bytes
+ *  16: u64 duration
+ *  24: u32 file flags
+ *  28: u32 checksum type
+ *  32: string uri
+ *  36: string caps
+ *  40: u32 number of streams
+ *  44: u32 number of file tags
+ *  48: u32 string pool offset
+ *  52: u32 string pool size
+ *
+ * Followed by the stream records (48 bytes):
+ *   0: string id
+ *   4: string caps
+ *   8: string padname
+ *  12: string type
+ *  16: u32 number of segments
+ *  20: u32 number of tags
+ *  24: u32 number of frames
+ *  28: u32 checksum size
+ *  32: u32 stream flags
+ *  36: u32 padding
+ *  40: u64 offset of the frames in the file
+ *
+ * The segment records (88 bytes) of all the streams, in order:
+ *   0: u64 next frame id
+ *   8: u32 flags
+ *  12: u32 format
+ *  16: double rate
+ *  24: double applied rate
+ *  32: u64 base, offset, start, stop, time, position and duration
+ *
+ * The tag records (a string holding the taglist) of all the streams and
+ * then the file ones, and finally the NUL terminated strings of the pool.
+ *
+ * The frames of a stream are the id, offset, offset-end, duration, pts,
+ * dts and running-time u64 columns, followed by the u8 flags column and
+ * the checksums.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <string.h>
+#include "media-descriptor.h"
+#include "gst-validate-internal.h"
+
+#define BINARY_MAGIC "\211GSTVMI\n"
+#define BINARY_MAGIC_SIZE 8
+#define BINARY_VERSION 1
+
+#define HEADER_SIZE 56
+#define STREAM_RECORD_SIZE 48
+#define SEGMENT_RECORD_SIZE 88
+#define TAG_RECORD_SIZE 4
+#define N_FRAME_U64_COLUMNS 7
+
+#define FILE_FLAG_FRAME_DETECTION (1 << 0)
+#define FILE_FLAG_SKIP_PARSERS (1 << 1)
+#define FILE_FLAG_SEEKABLE (1 << 2)
+#define FILE_FLAG_HAS_TAGS (1 << 3)
+
+#define STREAM_FLAG_HAS_TAGS (1 << 0)
+
+/* Writing */
+static gsize
+_reserve (GByteArray * data, gsize size)
+{
+  gsize offset = data->len;
+
+  g_byte_array_set_size (data, offset + size);
+  memset (data->data + offset, 0, size);
+
+  return offset;
+}
+
+static void
+_put_u32 (GByteArray * data, gsize offset, guint32 val)
+{
+  val = GUINT32_TO_LE (val);
+  memcpy (data->data + offset, &val, sizeof (val));
+}
+
+static void
+_put_u64 (GByteArray * data, gsize offset, guint64 val)
+{
+  val = GUINT64_TO_LE (val);
+  memcpy (data->data + offset, &val, sizeof (val));
+}
+
+static void
+_put_double (GByteArray * data, gsize offset, gdouble val)
+{
+  guint64 bits;
+
+  memcpy (&bits, &val, sizeof (bits));
+  _put_u64 (data, offset, bits);
+}
+
+static guint32
+_add_string (GByteArray * strings, const gchar * str)
+{
+  guint32 offset = strings->len;
+
+  if (!str)
+    return 0;
+
+  g_byte_array_append (strings, (const guint8 *) str, strlen (str) + 1);
+
+  return offset;
+}
+
+static guint32
+_add_caps (GByteArray * strings, const GstCaps * caps)
+{
+  gchar *str;
+  guint32 offset;
+
+  if (!caps)
+    return 0;
+
+  str = gst_caps_to_string (caps);
+  offset = _add_string (strings, str);
+  g_free (str);
+
+  return offset;
+}
+
+static void
+_append_segment (GByteArray * data, GstValidateSegmentNode * node)
+{
+  gsize offset = _reserve (data, SEGMENT_RECORD_SIZE);
+
+  _put_u64 (data, offset, node->next_frame_id);
+  _put_u32 (data, offset + 8, node->segment.flags);
+  _put_u32 (data, offset + 12, node->segment.format);
+  _put_double (data, offset + 16, node->segment.rate);
+  _put_double (data, offset + 24, node->segment.applied_rate);
+  _put_u64 (data, offset + 32, node->segment.base);
+  _put_u64 (data, offset + 40, node->segment.offset);
+  _put_u64 (data, offset + 48, node->segment.start);
+  _put_u64 (data, offset + 56, node->segment.stop);
+  _put_u64 (data, offset + 64, node->segment.time);
+  _put_u64 (data, offset + 72, node->segment.position);
+  _put_u64 (data, offset + 80, node->segment.duration);
+}
+
+static void
+_append_tags (GByteArray * data, GByteArray * strings,
+    GstValidateMediaTagsNode * tagsnode)
+{
+  GList *tmp;
+
+  if (!tagsnode)
+    return;
+
+  for (tmp = tagsnode->tags; tmp; tmp = tmp->next) {
+    GstValidateMediaTagNode *tagnode = tmp->data;
+    gchar *str = gst_tag_list_to_string (tagnode->taglist);
+
+    _put_u32 (data, _reserve (data, TAG_RECORD_SIZE),
+        _add_string (strings, str));
+    g_free (str);
+  }
+}
+
+static void
+_append_u64_column (GByteArray * data, GArray * column)
+{
+  guint i;
+  gsize offset = _reserve (data, column->len * sizeof (guint64));
+
+  for (i = 0; i < column->len; i++)
+    _put_u64 (data, offset + i * sizeof (guint64),
+        g_array_index (column, guint64, i));
+}
+
+static void
+_append_frames (GByteArray * data, GstValidateMediaFrameTable * frames)
+{
+  if (!frames)
+    return;
+
+  _append_u64_column (data, frames->ids);
+  _append_u64_column (data, frames->offsets);
+  _append_u64_column (data, frames->offset_ends);
+  _append_u64_column (data, frames->durations);
+  _append_u64_column (data, frames->pts);
+  _append_u64_column (data, frames->dts);
+  _append_u64_column (data, frames->running_times);
+  g_byte_array_append (data, (const guint8 *) frames->flags->data,
+      frames->flags->len);
+  g_byte_array_append (data, frames->checksums->data, frames->checksums->len);
+}
+
+/**
+ * gst_validate_media_descriptor_write_binary:
+ * @self: A #GstValidateMediaDescriptor
+ * @filename: The path of the file to write
+ * @error: A #GError to be set on failure
+ *
+ * Writes @self in the binary media descriptor format which can be loaded
+ * much faster than the XML one, see #gst_validate_media_descriptor_parser_new
+ *
+ * Returns: %TRUE on success, %FALSE otherwise
+ */
+gboolean
+gst_validate_media_descriptor_write_binary (GstValidateMediaDescriptor * self,
+    const gchar * filename, GError ** error)
+{
+  GList *tmp, *tmp2;
+  gsize offset;
+  guint32 flags = 0;
+  gboolean ret;
+  GByteArray *data, *strings;
+  GstValidateMediaFileNode *filenode;
+
+  g_return_val_if_fail (GST_IS_VALIDATE_MEDIA_DESCRIPTOR (self), FALSE);
+  g_return_val_if_fail (self->filenode, FALSE);
+
+  filenode = self->filenode;
+  data = g_byte_array_new ();
+  strings = g_byte_array_new ();
+  /* So that 0 is never a valid string */
+  g_byte_array_append (strings, (const guint8 *) "", 1);
+
+  if (filenode->frame_detection)
+    flags |= FILE_FLAG_FRAME_DETECTION;
+  if (filenode->skip_parsers)
+    flags |= FILE_FLAG_SKIP_PARSERS;
+  if (filenode->seekable)
+    flags |= FILE_FLAG_SEEKABLE;
+  if (filenode->tags)
+    flags |= FILE_FLAG_HAS_TAGS;
+
+  GST_VALIDATE_MEDIA_DESCRIPTOR_LOCK (self);
+  _reserve (data, HEADER_SIZE + g_list_length (filenode->streams) *
+      STREAM_RECORD_SIZE);
+  memcpy (data->data, BINARY_MAGIC, BINARY_MAGIC_SIZE);
+  _put_u32 (data, 8, BINARY_VERSION);
+  _put_u64 (data, 16, filenode->duration);
+  _put_u32 (data, 24, flags);
+  _put_u32 (data, 28, filenode->checksum_type);
+  _put_u32 (data, 32, _add_string (strings, filenode->uri));
+  _put_u32 (data, 36, _add_caps (strings, filenode->caps));
+  _put_u32 (data, 40, g_list_length (filenode->streams));
+  _put_u32 (data, 44, filenode->tags ? g_list_length (filenode->tags->tags) :
+      0);
+
+  for (tmp = filenode->streams, offset = HEADER_SIZE; tmp;
+      tmp = tmp->next, offset += STREAM_RECORD_SIZE) {
+    GstValidateMediaStreamNode *snode = tmp->data;
+
+    _put_u32 (data, offset, _add_string (strings, snode->id));
+    _put_u32 (data, offset + 4, _add_caps (strings, snode->caps));
+    _put_u32 (data, offset + 8, _add_string (strings, snode->padname));
+    _put_u32 (data, offset + 12, _add_string (strings, snode->type));
+    _put_u32 (data, offset + 16, g_list_length (snode->segments));
+    _put_u32 (data, offset + 20,
+        snode->tags ? g_list_length (snode->tags->tags) : 0);
+    _put_u32 (data, offset + 24,
+        gst_validate_media_frame_table_get_size (snode->frames));
+    _put_u32 (data, offset + 28,
+        snode->frames ? snode->frames->checksum_size : 0);
+    _put_u32 (data, offset + 32, snode->tags ? STREAM_FLAG_HAS_TAGS : 0);
+
+    for (tmp2 = snode->segments; tmp2; tmp2 = tmp2->next)
+      _append_segment (data, tmp2->data);
+  }
+
+  for (tmp = filenode->streams; tmp; tmp = tmp->next)
+    _append_tags (data, strings,
+        ((GstValidateMediaStreamNode *) tmp->data)->tags);
+  _append_tags (data, strings, filenode->tags);
+
+  _put_u32 (data, 48, data->len);
+  _put_u32 (data, 52, strings->len);
+  g_byte_array_append (data, strings->data, strings->len);
+  _put_u32 (data, 12, data->len);
+
+  for (tmp = filenode->streams, offset = HEADER_SIZE; tmp;
+      tmp = tmp->next, offset += STREAM_RECORD_SIZE) {
+    _reserve (data, GST_ROUND_UP_8 (data->len) - data->len);
+    _put_u64 (data, offset + 40, data->len);
+    _append_frames (data, ((GstValidateMediaStreamNode *) tmp->data)->frames);
+  }
+  GST_VALIDATE_MEDIA_DESCRIPTOR_UNLOCK (self);
+
+  ret = g_file_set_contents (filename, (const gchar *) data->data, data->len,
+      error);
+
+  g_byte_array_unref (strings);
+  g_byte_array_unref (data);
+
+  return ret;
+}
+
+/* Reading */
+typedef struct
+{
+  const guint8 *data;
+  gsize size;
+
+  const gchar *strings;
+  gsize strings_size;
+} BinaryReader;
+
+static guint32
+_get_u32 (BinaryReader * reader, gsize offset)
+{
+  guint32 val;
+
+  memcpy (&val, reader->data + offset, sizeof (val));
+
+  return GUINT32_FROM_LE (val);
+}
+
+static guint64
+_get_u64 (BinaryReader * reader, gsize offset)
+{
+  guint64 val;
+
+  memcpy (&val, reader->data + offset, sizeof (val));
+
+  return GUINT64_FROM_LE (val);
+}
+
+static gdouble
+_get_double (BinaryReader * reader, gsize offset)
+{
+  gdouble val;
+  guint64 bits = _get_u64 (reader, offset);
+
+  memcpy (&val, &bits, sizeof (val));
+
+  return val;
+}
+
+/* The pool is NUL terminated so any offset in it is a valid string */
+static const gchar *
+_get_string (BinaryReader * reader, gsize offset)
+{
+  guint32 string = _get_u32 (reader, offset);
+
+  if (!string || string >= reader->strings_size)
+    return NULL;
+
+  return reader->strings + string;
+}
+
+static GstCaps *
+_get_caps (BinaryReader * reader, gsize offset)
+{
+  const gchar *str = _get_string (reader, offset);
+
+  return str ? gst_caps_from_string (str) : NULL;
+}
+
+static GstValidateSegmentNode *
+_read_segment (BinaryReader * reader, gsize offset)
+{
+  GstValidateSegmentNode *node = g_slice_new0 (GstValidateSegmentNode);
+
+  node->next_frame_id = _get_u64 (reader, offset);
+  node->segment.flags = _get_u32 (reader, offset + 8);
+  node->segment.format = _get_u32 (reader, offset + 12);
+  node->segment.rate = _get_double (reader, offset + 16);
+  node->segment.applied_rate = _get_double (reader, offset + 24);
+  node->segment.base = _get_u64 (reader, offset + 32);
+  node->segment.offset = _get_u64 (reader, offset + 40);
+  node->segment.start = _get_u64 (reader, offset + 48);
+  node->segment.stop = _get_u64 (reader, offset + 56);
+  node->segment.time = _get_u64 (reader, offset + 64);
+  node->segment.position = _get_u64 (reader, offset + 72);
+  node->segment.duration = _get_u64 (reader, offset + 80);
+
+  return node;
+}
+
+static GstValidateMediaTagsNode *
+_read_tags (BinaryReader * reader, gsize * offset, guint n_tags)
+{
+  guint i;
+  GstValidateMediaTagsNode *tagsnode = g_slice_new0 (GstValidateMediaTagsNode);
+
+  for (i = 0; i < n_tags; i++, *offset += TAG_RECORD_SIZE) {
+    const gchar *str = _get_string (reader, *offset);
+    GstValidateMediaTagNode *tagnode = g_slice_new0 (GstValidateMediaTagNode);
+
+    if (str)
+      tagnode->taglist = gst_tag_list_new_from_string (str);
+    if (!tagnode->taglist)
+      tagnode->taglist = gst_tag_list_new_empty ();
+
+    tagsnode->tags = g_list_prepend (tagsnode->tags, tagnode);
+  }
+  tagsnode->tags = g_list_reverse (tagsnode->tags);
+
+  return tagsnode;
+}
+
+static void
+_read_u64_column (BinaryReader * reader, gsize offset, GArray * column,
+    guint n_frames)
+{
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+  g_array_append_vals (column, reader->data + offset, n_frames);
+#else
+  guint i;
+
+  g_array_set_size (column, n_frames);
+  for (i = 0; i < n_frames; i++)
+    g_array_index (column, guint64, i) =
+        _get_u64 (reader, offset + i * sizeof (guint64));
+#endif
+}
+
+static void
+_read_frames (BinaryReader * reader, gsize offset,
+    GstValidateMediaFrameTable * frames, guint n_frames, gsize checksum_size)
+{
+  GArray *columns[N_FRAME_U64_COLUMNS] = { frames->ids, frames->offsets,
+    frames->offset_ends, frames->durations, frames->pts, frames->dts,
+    frames->running_times
+  };
+  guint i;
+
+  for (i = 0; i < N_FRAME_U64_COLUMNS; i++) {
+    _read_u64_column (reader, offset, columns[i], n_frames);
+    offset += n_frames * sizeof (guint64);
+  }
+
+  g_array_append_vals (frames->flags, reader->data + offset, n_frames);
+  offset += n_frames;
+  g_byte_array_append (frames->checksums, reader->data + offset,
+      n_frames * checksum_size);
+  frames->checksum_size = checksum_size;
+}
+
+/* Makes sure the @n records of @record_size bytes at @offset are in the
+ * index and advances @offset past them */
+static gboolean
+_check_records (guint64 * offset, guint64 n, gsize record_size, guint64 end)
+{
+  if (n > (end - MIN (*offset, end)) / record_size)
+    return FALSE;
+
+  *offset += n * record_size;
+
+  return TRUE;
+}
+
+gboolean
+gst_validate_media_descriptor_is_binary (const gchar * data, gsize size)
+{
+  return size >= BINARY_MAGIC_SIZE
+      && !memcmp (data, BINARY_MAGIC, BINARY_MAGIC_SIZE);
+}
+
+/* Loads the binary descriptor @data into @self filenode */
+gboolean
+gst_validate_media_descriptor_parse_binary (GstValidateMediaDescriptor * self,
+    const gchar * data, gsize size, GError ** error)
+{
+  guint i, j, version, n_streams, n_tags, flags, checksum_type;
+  guint64 index_size, offset, segments_offset, tags_offset, strings_offset;
+  guint64 n_segment_records = 0, n_tag_records;
+  GstValidateMediaFileNode *filenode = self->filenode;
+  BinaryReader reader = { (const guint8 *) data, size, NULL, 0 };
+  const gchar *reason = NULL;
+
+  if (!gst_validate_media_descriptor_is_binary (data, size)
+      || size < HEADER_SIZE) {
+    reason = "not a binary media descriptor";
+    goto failed;
+  }
+
+  version = _get_u32 (&reader, 8);
+  if (version != BINARY_VERSION) {
+    g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+        "Unsupported binary media descriptor version %u", version);
+    return FALSE;
+  }
+
+  index_size = _get_u32 (&reader, 12);
+  strings_offset = _get_u32 (&reader, 48);
+  reader.strings_size = _get_u32 (&reader, 52);
+  if (index_size > size || strings_offset + reader.strings_size != index_size
+      || !reader.strings_size || data[index_size - 1] != '\0') {
+    reason = "invalid string pool";
+    goto failed;
+  }
+  reader.strings = data + strings_offset;
+
+  /* Check that all the records are in the index before reading anything */
+  n_streams = _get_u32 (&reader, 40);
+  offset = HEADER_SIZE;
+  if (strings_offset < HEADER_SIZE || !_check_records (&offset, n_streams,
+          STREAM_RECORD_SIZE, strings_offset)) {
+    reason = "truncated stream records";
+    goto failed;
+  }
+
+  n_tags = _get_u32 (&reader, 44);
+  n_tag_records = n_tags;
+  for (i = 0; i < n_streams; i++) {
+    gsize record = HEADER_SIZE + i * STREAM_RECORD_SIZE;
+    guint64 frames_offset = _get_u64 (&reader, record + 40);
+    guint64 n_frames = _get_u32 (&reader, record + 24);
+    guint64 checksum_size = _get_u32 (&reader, record + 28);
+
+    n_segment_records += _get_u32 (&reader, record + 16);
+    n_tag_records += _get_u32 (&reader, record + 20);
+
+    if (checksum_size > GST_VALIDATE_MEDIA_CHECKSUM_MAX_SIZE
+        || frames_offset < index_size || frames_offset > size
+        || n_frames > (size - frames_offset) /
+        (N_FRAME_U64_COLUMNS * sizeof (guint64) + 1 + checksum_size)) {
+      reason = "truncated frames";
+      goto failed;
+    }
+  }
+
+  segments_offset = offset;
+  if (!_check_records (&offset, n_segment_records, SEGMENT_RECORD_SIZE,
+          strings_offset)) {
+    reason = "truncated segment records";
+    goto failed;
+  }
+
+  tags_offset = offset;
+  if (!_check_records (&offset, n_tag_records, TAG_RECORD_SIZE,
+          strings_offset)) {
+    reason = "truncated tag records";
+    goto failed;
+  }
+
+  flags = _get_u32 (&reader, 24);
+  checksum_type = _get_u32 (&reader, 28);
+  if (checksum_type > GST_VALIDATE_MEDIA_CHECKSUM_XXH64) {
+    reason = "unknown checksum type";
+    goto failed;
+  }
+
+  filenode->duration = _get_u64 (&reader, 16);
+  filenode->frame_detection = ! !(flags & FILE_FLAG_FRAME_DETECTION);
+  filenode->skip_parsers = ! !(flags & FILE_FLAG_SKIP_PARSERS);
+  filenode->seekable = ! !(flags & FILE_FLAG_SEEKABLE);
+  filenode->checksum_type = checksum_type;
+  filenode->uri = g_strdup (_get_string (&reader, 32));
+  filenode->caps = _get_caps (&reader, 36);
+
+  offset = tags_offset;
+  for (i = 0; i < n_streams; i++) {
+    gsize record = HEADER_SIZE + i * STREAM_RECORD_SIZE;
+    GstValidateMediaStreamNode *snode =
+        g_slice_new0 (GstValidateMediaStreamNode);
+
+    snode->id = g_strdup (_get_string (&reader, record));
+    snode->caps = _get_caps (&reader, record + 4);
+    snode->padname = g_strdup (_get_string (&reader, record + 8));
+    snode->type = g_strdup (_get_string (&reader, record + 12));
+
+    for (j = 0; j < _get_u32 (&reader, record + 16); j++) {
+      snode->segments = g_list_prepend (snode->segments,
+          _read_segment (&reader, segments_offset));
+      segments_offset += SEGMENT_RECORD_SIZE;
+    }
+    snode->segments = g_list_reverse (snode->segments);
+
+    if (_get_u32 (&reader, record + 32) & STREAM_FLAG_HAS_TAGS)
+      snode->tags = _read_tags (&reader, &offset,
+          _get_u32 (&reader, record + 20));
+    else
+      offset += (gsize) _get_u32 (&reader, record + 20) * TAG_RECORD_SIZE;
+
+    snode->frames = gst_validate_media_frame_table_new ();
+    _read_frames (&reader, _get_u64 (&reader, record + 40), snode->frames,
+        _get_u32 (&reader, record + 24), _get_u32 (&reader, record + 28));
+
+    filenode->streams = g_list_prepend (filenode->streams, snode);
+  }
+  filenode->streams = g_list_reverse (filenode->streams);
+
+  if (flags & FILE_FLAG_HAS_TAGS)
+    filenode->tags = _read_tags (&reader, &offset, n_tags);
+
+  return TRUE;
+
+failed:
+  g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+      "Invalid binary media descriptor: %s", reason);
+  return FALSE;
+}
@@ -20,8 +20,16 @@
  */
 
 #include "media-descriptor-parser.h"
+#include "gst-validate-internal.h"
+#include <gio/gio.h>
 #include <string.h>
 
+/* How much decompressed XML is fed to the markup parser at once */
+#define PARSE_CHUNK_SIZE (64 * 1024)
+
+#define IS_GZIP(data,size) ((size) >= 2 && \
+    (guint8) (data)[0] == 0x1f && (guint8) (data)[1] == 0x8b)
+
 struct _GstValidateMediaDescriptorParserPrivate
 {
   gchar *xmlpath;
@@ -42,19 +50,6 @@ enum
 };
 
 /* Private methods  and callbacks */
-static gint
-compare_frames (GstValidateMediaFrameNode * frm,
-    GstValidateMediaFrameNode * frm1)
-{
-  if (frm->id < frm1->id)
-    return -1;
-
-  else if (frm->id == frm1->id)
-    return 0;
-
-  return 1;
-}
-
 static void
     deserialize_filenode
     (GstValidateMediaFileNode *
@@ -72,6 +67,11 @@ static void
       filenode->duration = g_ascii_strtoull (values[i], NULL, 0);
     else if (g_strcmp0 (names[i], "seekable") == 0)
       filenode->seekable = (g_strcmp0 (values[i], "true") == 0);
+    else if (g_strcmp0 (names[i], "checksum-type") == 0) {
+      if (!gst_validate_media_checksum_type_from_name (values[i],
+              &filenode->checksum_type))
+        GST_WARNING ("Unknown checksum type: %s", values[i]);
+    }
   }
 }
 
@@ -89,8 +89,11 @@ deserialize_streamnode (const gchar ** names, const gchar ** values)
       streamnode->caps = gst_caps_from_string (values[i]);
     else if (g_strcmp0 (names[i], "padname") == 0)
       streamnode->padname = g_strdup (values[i]);
+    else if (g_strcmp0 (names[i], "type") == 0)
+      streamnode->type = g_strdup (values[i]);
   }
 
+  streamnode->frames = gst_validate_media_frame_table_new ();
 
   return streamnode;
 }
@@ -153,13 +156,12 @@ deserialize_tagnode (const gchar ** names, const gchar ** values)
   return tagnode;
 }
 
-static GstValidateMediaFrameNode *
-deserialize_framenode (const gchar ** names, const gchar ** values)
+static void
+deserialize_framenode (GstValidateMediaFrameNode * framenode,
+    const gchar ** names, const gchar ** values)
 {
   gint i;
-
-  GstValidateMediaFrameNode *framenode =
-      g_slice_new0 (GstValidateMediaFrameNode);
+  const gchar *checksum = NULL;
 
 /* *INDENT-OFF* */
 #define IF_SET_UINT64_FIELD(name,fieldname) \
@@ -179,7 +181,7 @@ deserialize_framenode (const gchar ** names, const gchar ** values)
     else IF_SET_UINT64_FIELD ("dts", dts)
     else IF_SET_UINT64_FIELD ("running-time", running_time)
     else if (g_strcmp0 (names[i], "checksum") == 0)
-      framenode->checksum = g_strdup (values[i]);
+      checksum = values[i];
     else if (g_strcmp0 (names[i], "is-keyframe") == 0) {
       if (!g_ascii_strcasecmp (values[i], "true"))
         framenode->is_keyframe = TRUE;
@@ -191,22 +193,9 @@ deserialize_framenode (const gchar ** names, const gchar ** values)
   }
 /* *INDENT-ON* */
 
-  framenode->buf = gst_buffer_new_wrapped (framenode->checksum,
-      strlen (framenode->checksum) + 1);
-
-  GST_BUFFER_OFFSET (framenode->buf) = framenode->offset;
-  GST_BUFFER_OFFSET_END (framenode->buf) = framenode->offset_end;
-  GST_BUFFER_DURATION (framenode->buf) = framenode->duration;
-  GST_BUFFER_PTS (framenode->buf) = framenode->pts;
-  GST_BUFFER_DTS (framenode->buf) = framenode->dts;
-
-  if (framenode->is_keyframe) {
-    GST_BUFFER_FLAG_UNSET (framenode->buf, GST_BUFFER_FLAG_DELTA_UNIT);
-  } else {
-    GST_BUFFER_FLAG_SET (framenode->buf, GST_BUFFER_FLAG_DELTA_UNIT);
-  }
-
-  return framenode;
+  /* Store the checksum in binary form so it can be directly compared */
+  framenode->checksum_size =
+      gst_validate_media_checksum_from_string (checksum, framenode->checksum);
 }
 
 
@@ -218,6 +207,11 @@ on_end_element_cb (GMarkupParseContext * context,
       GST_VALIDATE_MEDIA_DESCRIPTOR_PARSER (user_data)->priv;
 
   if (g_strcmp0 (element_name, "stream") == 0) {
+    GstValidateMediaStreamNode *streamnode =
+        GST_VALIDATE_MEDIA_DESCRIPTOR (user_data)->filenode->streams->data;
+
+    /* Frames are serialized in order, this is a no-op in that case */
+    gst_validate_media_frame_table_sort (streamnode->frames);
     priv->in_stream = FALSE;
   }
 }
@@ -249,11 +243,10 @@ on_start_element_cb (GMarkupParseContext * context,
 
   } else if (g_strcmp0 (element_name, "frame") == 0) {
     GstValidateMediaStreamNode *streamnode = filenode->streams->data;
+    GstValidateMediaFrameNode framenode = { 0, };
 
-    streamnode->cframe = streamnode->frames =
-        g_list_insert_sorted (streamnode->frames,
-        deserialize_framenode (attribute_names, attribute_values),
-        (GCompareFunc) compare_frames);
+    deserialize_framenode (&framenode, attribute_names, attribute_values);
+    gst_validate_media_frame_table_append (streamnode->frames, &framenode);
   } else if (g_strcmp0 (element_name, "tags") == 0) {
     if (priv->in_stream) {
       GstValidateMediaStreamNode *snode = (GstValidateMediaStreamNode *)
@@ -314,23 +307,74 @@ failed:
   return FALSE;
 }
 
+/* Decompresses gzipped XML and parses it chunk by chunk, so that the
+ * decompressed document never has to be held in memory */
+static gboolean
+_set_compressed_content (GstValidateMediaDescriptorParser * parser,
+    const gchar * content, gsize size, GError ** error)
+{
+  gssize read;
+  gchar *chunk;
+  GConverter *decompressor;
+  GInputStream *compressed, *stream;
+  gboolean ret = TRUE;
+  GstValidateMediaDescriptorParserPrivate *priv = parser->priv;
+
+  priv->parsecontext = g_markup_parse_context_new (&content_parser,
+      G_MARKUP_TREAT_CDATA_AS_TEXT, parser, NULL);
+
+  compressed = g_memory_input_stream_new_from_data (content, size, NULL);
+  decompressor = (GConverter *)
+      g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP);
+  stream = g_converter_input_stream_new (compressed, decompressor);
+  g_object_unref (decompressor);
+  g_object_unref (compressed);
+
+  chunk = g_malloc (PARSE_CHUNK_SIZE);
+  while ((read = g_input_stream_read (stream, chunk, PARSE_CHUNK_SIZE, NULL,
+              error)) > 0) {
+    if (!g_markup_parse_context_parse (priv->parsecontext, chunk, read, error)) {
+      ret = FALSE;
+      break;
+    }
+  }
+  if (read < 0)
+    ret = FALSE;
+
+  g_free (chunk);
+  g_object_unref (stream);
+
+  return ret;
+}
+
 static gboolean
 set_xml_path (GstValidateMediaDescriptorParser * parser, const gchar * path,
     GError ** error)
 {
-  gsize xmlsize;
-  gchar *content;
+  gsize size;
+  const gchar *content;
+  GMappedFile *file;
   GError *err = NULL;
   GstValidateMediaDescriptorParserPrivate *priv = parser->priv;
   gboolean result;
 
-  if (!g_file_get_contents (path, &content, &xmlsize, &err))
+  file = g_mapped_file_new (path, FALSE, &err);
+  if (!file)
     goto failed;
 
   priv->xmlpath = g_strdup (path);
 
-  result = _set_content (parser, content, xmlsize, error);
-  g_free (content);
+  /* Empty files can not be mapped */
+  content = g_mapped_file_get_contents (file);
+  size = content ? g_mapped_file_get_length (file) : 0;
+  if (gst_validate_media_descriptor_is_binary (content, size))
+    result = gst_validate_media_descriptor_parse_binary (
+        (GstValidateMediaDescriptor *) parser, content, size, error);
+  else if (IS_GZIP (content, size))
+    result = _set_compressed_content (parser, content, size, error);
+  else
+    result = _set_content (parser, content ? content : "", size, error);
+  g_mapped_file_unref (file);
   return result;
 
 failed:
@@ -21,6 +21,7 @@
 
 #include <gst/validate/validate.h>
 #include "media-descriptor-writer.h"
+#include "gst-validate-internal.h"
 #include <string.h>
 
 struct _GstValidateMediaDescriptorWriterPrivate
@@ -45,6 +46,9 @@ G_DEFINE_TYPE_WITH_PRIVATE (GstValidateMediaDescriptorWriter,
 #define STR_APPEND3(arg) STR_APPEND((arg), 6)
 #define STR_APPEND4(arg) STR_APPEND((arg), 8)
 
+/* How much serialized XML is buffered before being written out */
+#define SERIALIZE_CHUNK_SIZE (64 * 1024)
+
 #define FLAG_IS_SET(writer,flag)       ((writer->priv->flags & (flag)) == (flag))
 
 enum
@@ -115,30 +119,82 @@ static void
 }
 
 /* Private methods */
-static gchar *
-serialize_filenode (GstValidateMediaDescriptorWriter * writer)
+static void
+serialize_frame (GString * res, GstValidateMediaFrameTable * frames, guint i)
+{
+  gchar *checksum;
+  GstValidateMediaFrameNode frame;
+
+  gst_validate_media_frame_table_get (frames, i, &frame);
+  checksum = gst_validate_media_checksum_to_string (frame.checksum,
+      frame.checksum_size);
+
+  g_string_append_printf (res, "%*s <frame duration=\"%" G_GUINT64_FORMAT
+      "\" id=\"%" G_GUINT64_FORMAT "\" is-keyframe=\"%s\" offset=\"%"
+      G_GUINT64_FORMAT "\" offset-end=\"%" G_GUINT64_FORMAT "\" pts=\"%"
+      G_GUINT64_FORMAT "\" dts=\"%" G_GUINT64_FORMAT "\" running-time=\"%"
+      G_GUINT64_FORMAT "\" checksum=\"%s\"/>\n", 6, " ", frame.duration,
+      frame.id, frame.is_keyframe ? "true" : "false", frame.offset,
+      frame.offset_end, frame.pts, frame.dts, frame.running_time, checksum);
+
+  g_free (checksum);
+}
+
+/* Writes what has been serialized so far to @stream, if any, once enough
+ * data is pending or if @force is set */
+static gboolean
+serialize_flush (GString * res, GOutputStream * stream, gboolean force,
+    GCancellable * cancellable, GError ** error)
+{
+  if (!stream || (!force && res->len < SERIALIZE_CHUNK_SIZE))
+    return TRUE;
+
+  if (!g_output_stream_write_all (stream, res->str, res->len, NULL,
+          cancellable, error))
+    return FALSE;
+
+  g_string_truncate (res, 0);
+
+  return TRUE;
+}
+
+/* Serializes the filenode into @res, when @stream is not NULL the XML is
+ * written to it chunk by chunk instead of being accumulated in @res */
+static gboolean
+serialize_filenode (GstValidateMediaDescriptorWriter * writer, GString * res,
+    GOutputStream * stream, GCancellable * cancellable, GError ** error)
 {
-  GString *res;
   gchar *tmpstr, *caps_str;
   GList *tmp, *tmp2;
+  guint i;
   GstValidateMediaTagsNode *tagsnode;
   GstValidateMediaFileNode
       * filenode = ((GstValidateMediaDescriptor *) writer)->filenode;
 
-  tmpstr = g_markup_printf_escaped ("<file duration=\"%" G_GUINT64_FORMAT
-      "\" frame-detection=\"%i\" skip-parsers=\"%i\" uri=\"%s\" seekable=\"%s\">\n",
-      filenode->duration, filenode->frame_detection, filenode->skip_parsers,
-      filenode->uri, filenode->seekable ? "true" : "false");
+  /* Keep MD5 descriptors readable by older versions */
+  if (filenode->checksum_type != GST_VALIDATE_MEDIA_CHECKSUM_MD5)
+    tmpstr = g_markup_printf_escaped ("<file duration=\"%" G_GUINT64_FORMAT
+        "\" frame-detection=\"%i\" skip-parsers=\"%i\" uri=\"%s\" seekable=\"%s\""
+        " checksum-type=\"%s\">\n", filenode->duration,
+        filenode->frame_detection, filenode->skip_parsers, filenode->uri,
+        filenode->seekable ? "true" : "false",
+        gst_validate_media_checksum_type_get_name (filenode->checksum_type));
+  else
+    tmpstr = g_markup_printf_escaped ("<file duration=\"%" G_GUINT64_FORMAT
+        "\" frame-detection=\"%i\" skip-parsers=\"%i\" uri=\"%s\" seekable=\"%s\">\n",
+        filenode->duration, filenode->frame_detection, filenode->skip_parsers,
+        filenode->uri, filenode->seekable ? "true" : "false");
 
   if (filenode->caps)
     caps_str = gst_caps_to_string (filenode->caps);
   else
     caps_str = g_strdup ("");
 
-  res = g_string_new (tmpstr);
+  g_string_append (res, tmpstr);
   g_free (tmpstr);
   tmpstr = g_markup_printf_escaped ("  <streams caps=\"%s\">\n", caps_str);
   g_string_append (res, tmpstr);
+  g_free (tmpstr);
   g_free (caps_str);
   for (tmp = filenode->streams; tmp; tmp = tmp->next) {
     GList *tmp3;
@@ -154,8 +210,12 @@ serialize_filenode (GstValidateMediaDescriptorWriter * writer)
       STR_APPEND4 (((GstValidateSegmentNode *) tmp2->data)->str_open);
     STR_APPEND3 ("</segments>");
 
-    for (tmp2 = snode->frames; tmp2; tmp2 = tmp2->next) {
-      STR_APPEND3 (((GstValidateMediaFrameNode *) tmp2->data)->str_open);
+    /* Frames are only turned into text here to keep adding them cheap */
+    for (i = 0; i < gst_validate_media_frame_table_get_size (snode->frames);
+        i++) {
+      serialize_frame (res, snode->frames, i);
+      if (!serialize_flush (res, stream, FALSE, cancellable, error))
+        return FALSE;
     }
 
     tagsnode = snode->tags;
@@ -183,7 +243,7 @@ serialize_filenode (GstValidateMediaDescriptorWriter * writer)
 
   g_string_append (res, filenode->str_close);
 
-  return g_string_free (res, FALSE);
+  return serialize_flush (res, stream, TRUE, cancellable, error);
 }
 
 /* Should be called with GST_VALIDATE_MEDIA_DESCRIPTOR_LOCK */
@@ -272,8 +332,6 @@ static gboolean
       FALSE);
 
   snode = g_slice_new0 (GstValidateMediaStreamNode);
-  snode->frames = NULL;
-  snode->cframe = NULL;
 
   snode->id = g_strdup (gst_discoverer_stream_info_get_stream_id (info));
   if (snode->id == NULL) {
@@ -289,6 +347,7 @@ static gboolean
     return FALSE;
   }
 
+  snode->frames = gst_validate_media_frame_table_new ();
   caps = gst_discoverer_stream_info_get_caps (info);
   snode->caps = caps;           /* Pass ownership */
   capsstr = gst_caps_to_string (caps);
@@ -305,6 +364,7 @@ static gboolean
     stype = "Unknown";
   }
 
+  snode->type = g_strdup (stype);
   snode->str_open =
       g_markup_printf_escaped
       ("<stream type=\"%s\" caps=\"%s\" id=\"%s\">", stype, capsstr, snode->id);
@@ -355,7 +415,8 @@ _uridecodebin_probe (GstPad * pad, GstPadProbeInfo * info,
 
           gst_event_parse_segment (event, &segment);
           gst_segment_copy_into (segment, &segment_node->segment);
-          segment_node->next_frame_id = g_list_length (streamnode->frames);
+          segment_node->next_frame_id =
+              gst_validate_media_frame_table_get_size (streamnode->frames);
 
           segment_node->str_open =
               g_markup_printf_escaped ("<segment next-frame-id=\"%d\""
@@ -702,6 +763,10 @@ gst_validate_media_descriptor_writer_new_discover (GstValidateRunner * runner,
         gst_discoverer_info_get_seekable (info));
 
     writer->priv->flags = flags;
+    if (FLAG_IS_SET (writer,
+            GST_VALIDATE_MEDIA_DESCRIPTOR_WRITER_FLAGS_FAST_CHECKSUM))
+      ((GstValidateMediaDescriptor *) writer)->filenode->checksum_type =
+          GST_VALIDATE_MEDIA_CHECKSUM_XXH64;
     if (FLAG_IS_SET (writer,
             GST_VALIDATE_MEDIA_DESCRIPTOR_WRITER_FLAGS_HANDLE_GLOGS))
       gst_validate_reporter_set_handle_g_logs (GST_VALIDATE_REPORTER (writer));
@@ -839,14 +904,14 @@ gst_validate_media_descriptor_writer_add_pad (GstValidateMediaDescriptorWriter *
   }
 
   snode = g_slice_new0 (GstValidateMediaStreamNode);
-  snode->frames = NULL;
-  snode->cframe = NULL;
+  snode->frames = gst_validate_media_frame_table_new ();
 
   snode->caps = gst_caps_ref (caps);
   snode->pad = gst_object_ref (pad);
 
   capsstr = gst_caps_to_string (caps);
   padname = gst_pad_get_name (pad);
+  snode->padname = g_strdup (padname);
   snode->str_open =
       g_markup_printf_escaped
       ("<stream padname=\"%s\" caps=\"%s\" id=\"%i\">", padname, capsstr, 0);
@@ -914,10 +979,8 @@ gst_validate_media_descriptor_writer_add_frame (GstValidateMediaDescriptorWriter
 {
   GstValidateMediaStreamNode *streamnode;
   GstMapInfo map;
-  gchar *checksum;
-  guint id;
   GstSegment *segment;
-  GstValidateMediaFrameNode *fnode;
+  GstValidateMediaFrameNode fnode = { 0, };
   GstValidateMediaFileNode *filenode;
 
   g_return_val_if_fail (GST_IS_VALIDATE_MEDIA_DESCRIPTOR_WRITER (writer),
@@ -940,69 +1003,134 @@ gst_validate_media_descriptor_writer_add_frame (GstValidateMediaDescriptorWriter
     return FALSE;
   }
 
-  id = g_list_length (streamnode->frames);
-  fnode = g_slice_new0 (GstValidateMediaFrameNode);
-
   g_assert (gst_buffer_map (buf, &map, GST_MAP_READ));
-  checksum = g_compute_checksum_for_data (G_CHECKSUM_MD5,
-      (const guchar *) map.data, map.size);
+  fnode.checksum_size =
+      gst_validate_media_checksum_compute (filenode->checksum_type, map.data,
+      map.size, fnode.checksum);
   gst_buffer_unmap (buf, &map);
 
-  fnode->id = id;
-  fnode->offset = GST_BUFFER_OFFSET (buf);
-  fnode->offset_end = GST_BUFFER_OFFSET_END (buf);
-  fnode->duration = GST_BUFFER_DURATION (buf);
-  fnode->pts = GST_BUFFER_PTS (buf);
-  fnode->dts = GST_BUFFER_DTS (buf);
+  fnode.id = gst_validate_media_frame_table_get_size (streamnode->frames);
+  fnode.offset = GST_BUFFER_OFFSET (buf);
+  fnode.offset_end = GST_BUFFER_OFFSET_END (buf);
+  fnode.duration = GST_BUFFER_DURATION (buf);
+  fnode.pts = GST_BUFFER_PTS (buf);
+  fnode.dts = GST_BUFFER_DTS (buf);
 
   g_assert (streamnode->segments);
   segment = &((GstValidateSegmentNode *) streamnode->segments->data)->segment;
-  fnode->running_time =
+  fnode.running_time =
       gst_segment_to_running_time (segment, GST_FORMAT_TIME,
       GST_BUFFER_PTS (buf));
-  fnode->is_keyframe =
+  fnode.is_keyframe =
       (GST_BUFFER_FLAG_IS_SET (buf, GST_BUFFER_FLAG_DELTA_UNIT) == FALSE);
 
-  fnode->str_open =
-      g_markup_printf_escaped (" <frame duration=\"%" G_GUINT64_FORMAT
-      "\" id=\"%i\" is-keyframe=\"%s\" offset=\"%" G_GUINT64_FORMAT
-      "\" offset-end=\"%" G_GUINT64_FORMAT "\" pts=\"%" G_GUINT64_FORMAT
-      "\" dts=\"%" G_GUINT64_FORMAT "\" running-time=\"%" G_GUINT64_FORMAT
-      "\" checksum=\"%s\"/>",
-      fnode->duration, id, fnode->is_keyframe ? "true" : "false",
-      fnode->offset, fnode->offset_end, fnode->pts, fnode->dts,
-      fnode->running_time, checksum);
-
-  fnode->str_close = NULL;
+  gst_validate_media_frame_table_append (streamnode->frames, &fnode);
 
-  streamnode->frames = g_list_append (streamnode->frames, fnode);
-
-  g_free (checksum);
   GST_VALIDATE_MEDIA_DESCRIPTOR_UNLOCK (writer);
 
   return TRUE;
 }
 
+/**
+ * gst_validate_media_descriptor_writer_write_to_stream:
+ * @writer: The #GstValidateMediaDescriptorWriter to serialize
+ * @stream: The #GOutputStream to write the serialized descriptor to
+ * @cancellable: (allow-none): a #GCancellable or %NULL
+ * @error: (allow-none): a #GError or %NULL
+ *
+ * Serializes @writer as XML to @stream, writing it chunk by chunk so that
+ * the whole document is never held in memory. @stream is not closed.
+ *
+ * Returns: %TRUE on success, %FALSE otherwise with @error set.
+ */
+gboolean
+    gst_validate_media_descriptor_writer_write_to_stream
+    (GstValidateMediaDescriptorWriter * writer, GOutputStream * stream,
+    GCancellable * cancellable, GError ** error)
+{
+  gboolean ret;
+  GString *res;
+
+  g_return_val_if_fail (GST_IS_VALIDATE_MEDIA_DESCRIPTOR_WRITER (writer),
+      FALSE);
+  g_return_val_if_fail (((GstValidateMediaDescriptor *) writer)->filenode,
+      FALSE);
+  g_return_val_if_fail (G_IS_OUTPUT_STREAM (stream), FALSE);
+
+  res = g_string_sized_new (SERIALIZE_CHUNK_SIZE);
+  ret = serialize_filenode (writer, res, stream, cancellable, error);
+  g_string_free (res, TRUE);
+
+  return ret;
+}
+
+/**
+ * gst_validate_media_descriptor_writer_write:
+ * @writer: The #GstValidateMediaDescriptorWriter to serialize
+ * @filename: The path of the file to write
+ *
+ * Serializes @writer as XML to @filename, replacing it. If @filename ends
+ * with ".gz" the file is gzip compressed, #GstValidateMediaDescriptorParser
+ * reads such files transparently.
+ *
+ * Returns: %TRUE on success, %FALSE otherwise.
+ */
 gboolean
 gst_validate_media_descriptor_writer_write (GstValidateMediaDescriptorWriter *
     writer, const gchar * filename)
 {
-  gboolean ret = FALSE;
-  gchar *serialized;
+  gboolean ret = FALSE, existed;
+  GFile *file;
+  GOutputStream *stream;
+  GCancellable *cancellable;
+  GError *err = NULL;
 
   g_return_val_if_fail (GST_IS_VALIDATE_MEDIA_DESCRIPTOR_WRITER (writer),
       FALSE);
   g_return_val_if_fail (((GstValidateMediaDescriptor *) writer)->filenode,
       FALSE);
 
-  serialized = serialize_filenode (writer);
+  file = g_file_new_for_path (filename);
+  existed = g_file_query_exists (file, NULL);
+  stream = (GOutputStream *) g_file_replace (file, NULL, FALSE,
+      G_FILE_CREATE_REPLACE_DESTINATION, NULL, &err);
+  if (!stream)
+    goto done;
+
+  if (g_str_has_suffix (filename, ".gz")) {
+    GConverter *compressor = (GConverter *)
+        g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP, -1);
+    GOutputStream *compressed =
+        g_converter_output_stream_new (stream, compressor);
+
+    g_object_unref (compressor);
+    g_object_unref (stream);
+    stream = compressed;
+  }
 
+  cancellable = g_cancellable_new ();
+  ret = gst_validate_media_descriptor_writer_write_to_stream (writer, stream,
+      cancellable, &err);
 
-  if (g_file_set_contents (filename, serialized, -1, NULL) == TRUE)
-    ret = TRUE;
+  /* Closing with a cancelled cancellable keeps the previous content of an
+   * existing destination, but a new file is written directly and has to be
+   * removed */
+  if (!ret)
+    g_cancellable_cancel (cancellable);
+  if (!g_output_stream_close (stream, cancellable, ret ? &err : NULL))
+    ret = FALSE;
+  g_object_unref (cancellable);
+  g_object_unref (stream);
 
+  if (!ret && !existed)
+    g_file_delete (file, NULL, NULL);
 
-  g_free (serialized);
+done:
+  g_object_unref (file);
+  if (err) {
+    GST_ERROR ("Could not write %s: %s", filename, err->message);
+    g_error_free (err);
+  }
 
   return ret;
 }
@@ -1011,10 +1139,15 @@ gchar *
 gst_validate_media_descriptor_writer_serialize (GstValidateMediaDescriptorWriter
     * writer)
 {
+  GString *res;
+
   g_return_val_if_fail (GST_IS_VALIDATE_MEDIA_DESCRIPTOR_WRITER (writer),
       FALSE);
   g_return_val_if_fail (((GstValidateMediaDescriptor *) writer)->filenode,
       FALSE);
 
-  return serialize_filenode (writer);
+  res = g_string_new (NULL);
+  serialize_filenode (writer, res, NULL, NULL, NULL);
+
+  return g_string_free (res, FALSE);
 }
@@ -24,6 +24,7 @@
 
 #include <glib.h>
 #include <glib-object.h>
+#include <gio/gio.h>
 #include <gst/gst.h>
 #include <gst/pbutils/pbutils.h>
 #include "media-descriptor.h"
@@ -62,6 +63,7 @@ typedef enum
     GST_VALIDATE_MEDIA_DESCRIPTOR_WRITER_FLAGS_NO_PARSER    = 1 << 1,
     GST_VALIDATE_MEDIA_DESCRIPTOR_WRITER_FLAGS_FULL         = 1 << 2,
     GST_VALIDATE_MEDIA_DESCRIPTOR_WRITER_FLAGS_HANDLE_GLOGS = 1 << 3,
+    GST_VALIDATE_MEDIA_DESCRIPTOR_WRITER_FLAGS_FAST_CHECKSUM = 1 << 4,
 } GstValidateMediaDescriptorWriterFlags;
 
 GST_VALIDATE_API
@@ -100,6 +102,11 @@ GST_VALIDATE_API
 gboolean gst_validate_media_descriptor_writer_write              (GstValidateMediaDescriptorWriter * writer,
                                                          const gchar * filename);
 GST_VALIDATE_API
+gboolean gst_validate_media_descriptor_writer_write_to_stream    (GstValidateMediaDescriptorWriter * writer,
+                                                         GOutputStream * stream,
+                                                         GCancellable * cancellable,
+                                                         GError ** error);
+GST_VALIDATE_API
 gchar * gst_validate_media_descriptor_writer_serialize           (GstValidateMediaDescriptorWriter *writer);
 
 
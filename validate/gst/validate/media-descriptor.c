@@ -22,6 +22,7 @@
 
 #include <string.h>
 #include "media-descriptor.h"
+#include "gst-validate-internal.h"
 
 struct _GstValidateMediaDescriptorPrivate
 {
@@ -33,6 +34,368 @@ G_DEFINE_ABSTRACT_TYPE_WITH_CODE (GstValidateMediaDescriptor,
     G_ADD_PRIVATE (GstValidateMediaDescriptor)
     G_IMPLEMENT_INTERFACE (GST_TYPE_VALIDATE_REPORTER, NULL));
 
+#define XXH64_PRIME1 G_GUINT64_CONSTANT (11400714785074694791)
+#define XXH64_PRIME2 G_GUINT64_CONSTANT (14029467366897019727)
+#define XXH64_PRIME3 G_GUINT64_CONSTANT (1609587929392839161)
+#define XXH64_PRIME4 G_GUINT64_CONSTANT (9650029242287828579)
+#define XXH64_PRIME5 G_GUINT64_CONSTANT (2870177450012600261)
+#define XXH64_ROTL(x,r) (((x) << (r)) | ((x) >> (64 - (r))))
+
+static inline guint64
+xxh64_round (guint64 acc, guint64 input)
+{
+  acc += input * XXH64_PRIME2;
+  acc = XXH64_ROTL (acc, 31);
+
+  return acc * XXH64_PRIME1;
+}
+
+static inline guint64
+xxh64_merge_round (guint64 acc, guint64 val)
+{
+  acc ^= xxh64_round (0, val);
+
+  return acc * XXH64_PRIME1 + XXH64_PRIME4;
+}
+
+/* XXH64 with a 0 seed, see https://github.com/Cyan4973/xxHash */
+static guint64
+xxh64 (const guint8 * data, gsize size)
+{
+  const guint8 *end = data + size;
+  guint64 h;
+
+  if (size >= 32) {
+    const guint8 *limit = end - 32;
+    guint64 v1 = XXH64_PRIME1 + XXH64_PRIME2;
+    guint64 v2 = XXH64_PRIME2;
+    guint64 v3 = 0;
+    guint64 v4 = -XXH64_PRIME1;
+
+    do {
+      v1 = xxh64_round (v1, GST_READ_UINT64_LE (data));
+      v2 = xxh64_round (v2, GST_READ_UINT64_LE (data + 8));
+      v3 = xxh64_round (v3, GST_READ_UINT64_LE (data + 16));
+      v4 = xxh64_round (v4, GST_READ_UINT64_LE (data + 24));
+      data += 32;
+    } while (data <= limit);
+
+    h = XXH64_ROTL (v1, 1) + XXH64_ROTL (v2, 7) + XXH64_ROTL (v3, 12) +
+        XXH64_ROTL (v4, 18);
+    h = xxh64_merge_round (h, v1);
+    h = xxh64_merge_round (h, v2);
+    h = xxh64_merge_round (h, v3);
+    h = xxh64_merge_round (h, v4);
+  } else {
+    h = XXH64_PRIME5;
+  }
+
+  h += size;
+
+  for (; data + 8 <= end; data += 8) {
+    h ^= xxh64_round (0, GST_READ_UINT64_LE (data));
+    h = XXH64_ROTL (h, 27) * XXH64_PRIME1 + XXH64_PRIME4;
+  }
+
+  if (data + 4 <= end) {
+    h ^= (guint64) GST_READ_UINT32_LE (data) * XXH64_PRIME1;
+    h = XXH64_ROTL (h, 23) * XXH64_PRIME2 + XXH64_PRIME3;
+    data += 4;
+  }
+
+  for (; data < end; data++) {
+    h ^= (*data) * XXH64_PRIME5;
+    h = XXH64_ROTL (h, 11) * XXH64_PRIME1;
+  }
+
+  h ^= h >> 33;
+  h *= XXH64_PRIME2;
+  h ^= h >> 29;
+  h *= XXH64_PRIME3;
+  h ^= h >> 32;
+
+  return h;
+}
+
+/* Computes the binary checksum of @data into @checksum which must be at
+ * least GST_VALIDATE_MEDIA_CHECKSUM_MAX_SIZE bytes long.
+ *
+ * Returns: The size of the checksum */
+gsize
+gst_validate_media_checksum_compute (GstValidateMediaChecksumType type,
+    const guint8 * data, gsize size, guint8 * checksum)
+{
+  switch (type) {
+    case GST_VALIDATE_MEDIA_CHECKSUM_XXH64:
+      /* Canonical (big endian) representation, as printed by xxhsum */
+      GST_WRITE_UINT64_BE (checksum, xxh64 (data, size));
+
+      return 8;
+    case GST_VALIDATE_MEDIA_CHECKSUM_MD5:
+    default:
+    {
+      gsize digest_len = GST_VALIDATE_MEDIA_CHECKSUM_MAX_SIZE;
+      GChecksum *cs = g_checksum_new (G_CHECKSUM_MD5);
+
+      g_checksum_update (cs, data, size);
+      g_checksum_get_digest (cs, checksum, &digest_len);
+      g_checksum_free (cs);
+
+      return digest_len;
+    }
+  }
+}
+
+gchar *
+gst_validate_media_checksum_to_string (const guint8 * checksum, gsize size)
+{
+  gsize i;
+  gchar *str = g_malloc (size * 2 + 1);
+
+  for (i = 0; i < size; i++) {
+    str[2 * i] = "0123456789abcdef"[checksum[i] >> 4];
+    str[2 * i + 1] = "0123456789abcdef"[checksum[i] & 0xf];
+  }
+  str[2 * size] = '\0';
+
+  return str;
+}
+
+/* Parses the @str hexadecimal representation into @checksum which must be
+ * at least GST_VALIDATE_MEDIA_CHECKSUM_MAX_SIZE bytes long.
+ *
+ * Returns: The size of the checksum, 0 if @str is invalid */
+gsize
+gst_validate_media_checksum_from_string (const gchar * str, guint8 * checksum)
+{
+  gsize i, size = str ? strlen (str) / 2 : 0;
+
+  if (size > GST_VALIDATE_MEDIA_CHECKSUM_MAX_SIZE) {
+    GST_WARNING ("Checksum too long: %s", str);
+    return 0;
+  }
+
+  for (i = 0; i < size; i++) {
+    gint high = g_ascii_xdigit_value (str[2 * i]);
+    gint low = g_ascii_xdigit_value (str[2 * i + 1]);
+
+    if (high < 0 || low < 0) {
+      GST_WARNING ("Invalid checksum: %s", str);
+      size = 0;
+      break;
+    }
+
+    checksum[i] = (high << 4) | low;
+  }
+
+  return size;
+}
+
+const gchar *
+gst_validate_media_checksum_type_get_name (GstValidateMediaChecksumType type)
+{
+  switch (type) {
+    case GST_VALIDATE_MEDIA_CHECKSUM_XXH64:
+      return "xxh64";
+    case GST_VALIDATE_MEDIA_CHECKSUM_MD5:
+    default:
+      return "md5";
+  }
+}
+
+gboolean
+gst_validate_media_checksum_type_from_name (const gchar * name,
+    GstValidateMediaChecksumType * type)
+{
+  if (!g_strcmp0 (name, "md5"))
+    *type = GST_VALIDATE_MEDIA_CHECKSUM_MD5;
+  else if (!g_strcmp0 (name, "xxh64"))
+    *type = GST_VALIDATE_MEDIA_CHECKSUM_XXH64;
+  else
+    return FALSE;
+
+  return TRUE;
+}
+
+GstValidateMediaFrameTable *
+gst_validate_media_frame_table_new (void)
+{
+  GstValidateMediaFrameTable *table = g_slice_new0 (GstValidateMediaFrameTable);
+
+  table->refcount = 1;
+  table->ids = g_array_new (FALSE, FALSE, sizeof (guint64));
+  table->offsets = g_array_new (FALSE, FALSE, sizeof (guint64));
+  table->offset_ends = g_array_new (FALSE, FALSE, sizeof (guint64));
+  table->durations = g_array_new (FALSE, FALSE, sizeof (guint64));
+  table->pts = g_array_new (FALSE, FALSE, sizeof (guint64));
+  table->dts = g_array_new (FALSE, FALSE, sizeof (guint64));
+  table->running_times = g_array_new (FALSE, FALSE, sizeof (guint64));
+  table->flags = g_array_new (FALSE, FALSE, sizeof (guint8));
+  table->checksums = g_byte_array_new ();
+
+  return table;
+}
+
+GstValidateMediaFrameTable *
+gst_validate_media_frame_table_ref (GstValidateMediaFrameTable * table)
+{
+  g_atomic_int_inc (&table->refcount);
+
+  return table;
+}
+
+void
+gst_validate_media_frame_table_unref (GstValidateMediaFrameTable * table)
+{
+  if (!g_atomic_int_dec_and_test (&table->refcount))
+    return;
+
+  g_array_unref (table->ids);
+  g_array_unref (table->offsets);
+  g_array_unref (table->offset_ends);
+  g_array_unref (table->durations);
+  g_array_unref (table->pts);
+  g_array_unref (table->dts);
+  g_array_unref (table->running_times);
+  g_array_unref (table->flags);
+  g_byte_array_unref (table->checksums);
+  g_slice_free (GstValidateMediaFrameTable, table);
+}
+
+guint
+gst_validate_media_frame_table_get_size (GstValidateMediaFrameTable * table)
+{
+  return table ? table->ids->len : 0;
+}
+
+void
+gst_validate_media_frame_table_append (GstValidateMediaFrameTable * table,
+    const GstValidateMediaFrameNode * frame)
+{
+  guint8 flags = 0;
+  static const guint8 no_checksum[GST_VALIDATE_MEDIA_CHECKSUM_MAX_SIZE] = { 0, };
+
+  /* All the checksums of a stream are computed with the same algorithm */
+  if (!table->ids->len)
+    table->checksum_size = frame->checksum_size;
+
+  if (frame->is_keyframe == GST_VALIDATE_UNKNOWN_BOOL)
+    flags |= GST_VALIDATE_MEDIA_FRAME_KEYFRAME_UNKNOWN;
+  else if (frame->is_keyframe)
+    flags |= GST_VALIDATE_MEDIA_FRAME_KEYFRAME;
+
+  if (frame->checksum_size == table->checksum_size) {
+    g_byte_array_append (table->checksums, frame->checksum,
+        table->checksum_size);
+  } else {
+    GST_WARNING ("Frame %" G_GUINT64_FORMAT " checksum size %"
+        G_GSIZE_FORMAT " != %" G_GSIZE_FORMAT, frame->id,
+        frame->checksum_size, table->checksum_size);
+    flags |= GST_VALIDATE_MEDIA_FRAME_NO_CHECKSUM;
+    g_byte_array_append (table->checksums, no_checksum, table->checksum_size);
+  }
+
+  g_array_append_val (table->ids, frame->id);
+  g_array_append_val (table->offsets, frame->offset);
+  g_array_append_val (table->offset_ends, frame->offset_end);
+  g_array_append_val (table->durations, frame->duration);
+  g_array_append_val (table->pts, frame->pts);
+  g_array_append_val (table->dts, frame->dts);
+  g_array_append_val (table->running_times, frame->running_time);
+  g_array_append_val (table->flags, flags);
+}
+
+void
+gst_validate_media_frame_table_get (GstValidateMediaFrameTable * table,
+    guint i, GstValidateMediaFrameNode * frame)
+{
+  guint8 flags = g_array_index (table->flags, guint8, i);
+
+  frame->id = g_array_index (table->ids, guint64, i);
+  frame->offset = g_array_index (table->offsets, guint64, i);
+  frame->offset_end = g_array_index (table->offset_ends, guint64, i);
+  frame->duration = g_array_index (table->durations, guint64, i);
+  frame->pts = g_array_index (table->pts, guint64, i);
+  frame->dts = g_array_index (table->dts, guint64, i);
+  frame->running_time = g_array_index (table->running_times, guint64, i);
+
+  if (flags & GST_VALIDATE_MEDIA_FRAME_KEYFRAME_UNKNOWN)
+    frame->is_keyframe = GST_VALIDATE_UNKNOWN_BOOL;
+  else
+    frame->is_keyframe = ! !(flags & GST_VALIDATE_MEDIA_FRAME_KEYFRAME);
+
+  if (flags & GST_VALIDATE_MEDIA_FRAME_NO_CHECKSUM) {
+    frame->checksum_size = 0;
+  } else {
+    frame->checksum_size = table->checksum_size;
+    memcpy (frame->checksum, table->checksums->data + i * table->checksum_size,
+        table->checksum_size);
+  }
+}
+
+static gint
+compare_frame_ids (const guint * a, const guint * b, const guint64 * ids)
+{
+  if (ids[*a] < ids[*b])
+    return -1;
+
+  return ids[*a] > ids[*b];
+}
+
+#define REORDER_COLUMN(column,type) G_STMT_START {                           \
+  GArray *sorted = g_array_sized_new (FALSE, FALSE, sizeof (type), n);       \
+  for (i = 0; i < n; i++)                                                    \
+    g_array_append_val (sorted, g_array_index (column, type, order[i]));     \
+  g_array_unref (column);                                                    \
+  column = sorted;                                                           \
+} G_STMT_END
+
+/* Sorts the frames by id, they normally are already sorted */
+void
+gst_validate_media_frame_table_sort (GstValidateMediaFrameTable * table)
+{
+  guint i, n = gst_validate_media_frame_table_get_size (table);
+  guint *order;
+  GByteArray *checksums;
+
+  for (i = 1; i < n; i++) {
+    if (g_array_index (table->ids, guint64, i - 1) >
+        g_array_index (table->ids, guint64, i))
+      break;
+  }
+
+  if (i >= n)
+    return;
+
+  order = g_new (guint, n);
+  for (i = 0; i < n; i++)
+    order[i] = i;
+  /* Stable, as g_list_insert_sorted() was */
+  g_qsort_with_data (order, n, sizeof (guint),
+      (GCompareDataFunc) compare_frame_ids, table->ids->data);
+
+  REORDER_COLUMN (table->ids, guint64);
+  REORDER_COLUMN (table->offsets, guint64);
+  REORDER_COLUMN (table->offset_ends, guint64);
+  REORDER_COLUMN (table->durations, guint64);
+  REORDER_COLUMN (table->pts, guint64);
+  REORDER_COLUMN (table->dts, guint64);
+  REORDER_COLUMN (table->running_times, guint64);
+  REORDER_COLUMN (table->flags, guint8);
+
+  checksums = g_byte_array_sized_new (n * table->checksum_size);
+  for (i = 0; i < n; i++)
+    g_byte_array_append (checksums,
+        table->checksums->data + order[i] * table->checksum_size,
+        table->checksum_size);
+  g_byte_array_unref (table->checksums);
+  table->checksums = checksums;
+
+  g_free (order);
+}
+
+#undef REORDER_COLUMN
+
 static inline void
 free_tagnode (GstValidateMediaTagNode * tagnode)
 {
@@ -53,18 +416,6 @@ free_tagsnode (GstValidateMediaTagsNode * tagsnode)
   g_slice_free (GstValidateMediaTagsNode, tagsnode);
 }
 
-static inline void
-free_framenode (GstValidateMediaFrameNode * framenode)
-{
-  g_free (framenode->str_open);
-  g_free (framenode->str_close);
-
-  if (framenode->buf)
-    gst_buffer_unref (framenode->buf);
-
-  g_slice_free (GstValidateMediaFrameNode, framenode);
-}
-
 static inline void
 free_segmentnode (GstValidateSegmentNode * segmentnode)
 {
@@ -80,7 +431,8 @@ free_streamnode (GstValidateMediaStreamNode * streamnode)
   if (streamnode->caps)
     gst_caps_unref (streamnode->caps);
 
-  g_list_free_full (streamnode->frames, (GDestroyNotify) free_framenode);
+  if (streamnode->frames)
+    gst_validate_media_frame_table_unref (streamnode->frames);
   g_list_free_full (streamnode->segments, (GDestroyNotify) free_segmentnode);
 
   if (streamnode->pad)
@@ -90,6 +442,7 @@ free_streamnode (GstValidateMediaStreamNode * streamnode)
     free_tagsnode (streamnode->tags);
 
   g_free (streamnode->padname);
+  g_free (streamnode->type);
   g_free (streamnode->id);
   g_free (streamnode->str_open);
   g_free (streamnode->str_close);
@@ -476,29 +829,24 @@ static gboolean
 compare_frames_list (GstValidateMediaDescriptor * ref,
     GstValidateMediaStreamNode * rstream, GstValidateMediaStreamNode * cstream)
 {
-  GList *rframes, *cframes;
+  guint i;
+  guint n_rframes = gst_validate_media_frame_table_get_size (rstream->frames);
+  guint n_cframes = gst_validate_media_frame_table_get_size (cstream->frames);
 
-  if (g_list_length (rstream->frames) != g_list_length (cstream->frames)) {
+  if (n_rframes != n_cframes) {
     GST_VALIDATE_REPORT (ref, FILE_FRAMES_INCORRECT,
         "Stream reference has %i frames, compared one has %i frames",
-        g_list_length (rstream->frames), g_list_length (cstream->frames));
+        n_rframes, n_cframes);
     return FALSE;
   }
 
-  for (rframes = rstream->frames, cframes = cstream->frames; rframes;
-      rframes = g_list_next (rframes), cframes = g_list_next (cframes)) {
-    GstValidateMediaFrameNode *rframe, *cframe;
-
-    if (cframes == NULL) {
-      /* The list was checked to be of the same size */
-      g_assert_not_reached ();
-      return FALSE;
-    }
+  for (i = 0; i < n_rframes; i++) {
+    GstValidateMediaFrameNode rframe, cframe;
 
-    rframe = rframes->data;
-    cframe = cframes->data;
+    gst_validate_media_frame_table_get (rstream->frames, i, &rframe);
+    gst_validate_media_frame_table_get (cstream->frames, i, &cframe);
 
-    if (!compare_frames (ref, rstream, rframe, cframe)) {
+    if (!compare_frames (ref, rstream, &rframe, &cframe)) {
       return FALSE;
     }
   }
@@ -620,14 +968,75 @@ gst_validate_media_descriptor_detects_frames (GstValidateMediaDescriptor * self)
   return self->filenode->frame_detection;
 }
 
+/* Returns: (transfer full): The frames of the stream corresponding
+ * to @pad */
+GstValidateMediaFrameTable *
+gst_validate_media_descriptor_get_frame_table (GstValidateMediaDescriptor *
+    self, GstPad * pad)
+{
+  GList *tmpstream;
+  GstValidateMediaFrameTable *res = NULL;
+  GstCaps *pad_caps = gst_pad_get_current_caps (pad);
+
+  g_return_val_if_fail (GST_IS_VALIDATE_MEDIA_DESCRIPTOR (self), NULL);
+  g_return_val_if_fail (self->filenode, NULL);
+
+  for (tmpstream = self->filenode->streams;
+      tmpstream; tmpstream = tmpstream->next) {
+    GstValidateMediaStreamNode
+        * streamnode = (GstValidateMediaStreamNode *) tmpstream->data;
+
+    if (streamnode->pad == pad || (!streamnode->pad
+            && gst_caps_is_subset (pad_caps, streamnode->caps))) {
+      if (streamnode->frames)
+        res = gst_validate_media_frame_table_ref (streamnode->frames);
+      break;
+    }
+  }
+
+  if (pad_caps)
+    gst_caps_unref (pad_caps);
+
+  return res;
+}
+
+static GstBuffer *
+_frame_table_get_buffer (GstValidateMediaFrameTable * table, guint i)
+{
+  GstBuffer *buf;
+  GstValidateMediaFrameNode frame;
+
+  gst_validate_media_frame_table_get (table, i, &frame);
+
+  buf = gst_buffer_new_wrapped (g_memdup (frame.checksum,
+          frame.checksum_size), frame.checksum_size);
+  GST_BUFFER_OFFSET (buf) = frame.offset;
+  GST_BUFFER_OFFSET_END (buf) = frame.offset_end;
+  GST_BUFFER_DURATION (buf) = frame.duration;
+  GST_BUFFER_PTS (buf) = frame.pts;
+  GST_BUFFER_DTS (buf) = frame.dts;
+
+  if (frame.is_keyframe) {
+    GST_BUFFER_FLAG_UNSET (buf, GST_BUFFER_FLAG_DELTA_UNIT);
+  } else {
+    GST_BUFFER_FLAG_SET (buf, GST_BUFFER_FLAG_DELTA_UNIT);
+  }
+
+  return buf;
+}
+
 /**
  * gst_validate_media_descriptor_get_buffers: (skip):
+ *
+ * Gets the frames as buffers holding their metadata and binary checksum.
+ * Creates a buffer per frame, prefer working with the frame table.
  */
 gboolean
 gst_validate_media_descriptor_get_buffers (GstValidateMediaDescriptor * self,
     GstPad * pad, GCompareFunc compare_func, GList ** bufs)
 {
-  GList *tmpstream, *tmpframe;
+  GList *tmpstream;
+  guint i;
   gboolean check = (pad == NULL), ret = FALSE;
   GstCaps *pad_caps = gst_pad_get_current_caps (pad);
 
@@ -648,18 +1057,16 @@ gst_validate_media_descriptor_get_buffers (GstValidateMediaDescriptor * self,
 
     if (check) {
       ret = TRUE;
-      for (tmpframe = streamnode->frames; tmpframe; tmpframe = tmpframe->next) {
+      for (i = 0; i < gst_validate_media_frame_table_get_size
+          (streamnode->frames); i++) {
         if (compare_func)
           *bufs =
               g_list_insert_sorted (*bufs,
-              gst_buffer_ref ((
-                      (GstValidateMediaFrameNode
-                          *) tmpframe->data)->buf), compare_func);
+              _frame_table_get_buffer (streamnode->frames, i), compare_func);
         else
           *bufs =
               g_list_prepend (*bufs,
-              gst_buffer_ref ((
-                      (GstValidateMediaFrameNode *) tmpframe->data)->buf));
+              _frame_table_get_buffer (streamnode->frames, i));
       }
 
       if (pad != NULL)
@@ -687,7 +1094,7 @@ gst_validate_media_descriptor_has_frame_info (GstValidateMediaDescriptor * self)
     GstValidateMediaStreamNode
         * streamnode = (GstValidateMediaStreamNode *) tmpstream->data;
 
-    if (g_list_length (streamnode->frames))
+    if (gst_validate_media_frame_table_get_size (streamnode->frames))
       return TRUE;
   }
 
@@ -31,6 +31,24 @@ G_BEGIN_DECLS
 
 #define GST_VALIDATE_UNKNOWN_UINT64 (G_MAXUINT64 - 2)
 #define GST_VALIDATE_UNKNOWN_BOOL (G_MAXUINT32 - 2)
+
+/**
+ * GstValidateMediaChecksumType:
+ * @GST_VALIDATE_MEDIA_CHECKSUM_MD5: MD5, used by descriptors not specifying
+ * any checksum type
+ * @GST_VALIDATE_MEDIA_CHECKSUM_XXH64: 64 bits xxHash, a non cryptographic
+ * hash a lot cheaper to compute on big raw frames
+ *
+ * The algorithm used to compute the frames checksums.
+ */
+typedef enum
+{
+  GST_VALIDATE_MEDIA_CHECKSUM_MD5 = 0,
+  GST_VALIDATE_MEDIA_CHECKSUM_XXH64,
+} GstValidateMediaChecksumType;
+
+/* Size of the biggest binary checksum */
+#define GST_VALIDATE_MEDIA_CHECKSUM_MAX_SIZE 16
 typedef struct
 {
   /* Children */
@@ -57,6 +75,7 @@ typedef struct
   gboolean frame_detection;
   gboolean skip_parsers;
   gboolean seekable;
+  GstValidateMediaChecksumType checksum_type;
 
   GstCaps *caps;
 
@@ -76,11 +95,51 @@ typedef struct
   gchar *str_close;
 } GstValidateMediaTagNode;
 
+/**
+ * GstValidateMediaFrameFlags:
+ * @GST_VALIDATE_MEDIA_FRAME_KEYFRAME: The frame is a keyframe
+ * @GST_VALIDATE_MEDIA_FRAME_KEYFRAME_UNKNOWN: Whether the frame is a keyframe
+ * is unknown
+ * @GST_VALIDATE_MEDIA_FRAME_NO_CHECKSUM: The frame has no checksum
+ */
+typedef enum
+{
+  GST_VALIDATE_MEDIA_FRAME_KEYFRAME = 1 << 0,
+  GST_VALIDATE_MEDIA_FRAME_KEYFRAME_UNKNOWN = 1 << 1,
+  GST_VALIDATE_MEDIA_FRAME_NO_CHECKSUM = 1 << 2,
+} GstValidateMediaFrameFlags;
+
+/**
+ * GstValidateMediaFrameTable:
+ *
+ * The frames of a stream stored column by column, frame number @i being
+ * described by the @i-th element of each column. Frames are read and
+ * appended as #GstValidateMediaFrameNode rows.
+ */
+typedef struct
+{
+  /*< private >*/
+  gint refcount;
+
+  /* guint64 columns */
+  GArray *ids;
+  GArray *offsets;
+  GArray *offset_ends;
+  GArray *durations;
+  GArray *pts;
+  GArray *dts;
+  GArray *running_times;
+  /* guint8 column of GstValidateMediaFrameFlags */
+  GArray *flags;
+  /* checksum_size bytes per frame */
+  GByteArray *checksums;
+  gsize checksum_size;
+} GstValidateMediaFrameTable;
+
 typedef struct
 {
   /* Children */
-  /* GstValidateMediaFrameNode */
-  GList *frames;
+  GstValidateMediaFrameTable *frames;
 
   /* GstValidateMediaTagsNode */
   GstValidateMediaTagsNode *tags;
@@ -90,15 +149,16 @@ typedef struct
   GList * segments;
   gchar *id;
   gchar *padname;
+  gchar *type;
 
   /* Testing infos */
   GstPad *pad;
-  GList *cframe;
 
   gchar *str_open;
   gchar *str_close;
 } GstValidateMediaStreamNode;
 
+/* A row of a #GstValidateMediaFrameTable */
 typedef struct
 {
   /* Attributes */
@@ -110,11 +170,9 @@ typedef struct
   GstClockTime running_time;
   gboolean is_keyframe;
 
-  GstBuffer *buf;
-
-  gchar *checksum;
-  gchar *str_open;
-  gchar *str_close;
+  /* Binary checksum of the frame, 0 sized if unknown */
+  guint8 checksum[GST_VALIDATE_MEDIA_CHECKSUM_MAX_SIZE];
+  gsize checksum_size;
 } GstValidateMediaFrameNode;
 
 typedef struct
@@ -188,5 +246,8 @@ gboolean gst_validate_media_descriptor_get_seekable (GstValidateMediaDescriptor
 GST_VALIDATE_API
 GList *gst_validate_media_descriptor_get_pads (GstValidateMediaDescriptor *
     self);
+GST_VALIDATE_API
+gboolean gst_validate_media_descriptor_write_binary (GstValidateMediaDescriptor *
+    self, const gchar * filename, GError ** error);
 G_END_DECLS
 #endif
@@ -217,14 +217,352 @@ gst_validate_plugin_get_config (GstPlugin * plugin)
   return plugin_conf;
 }
 
+/* The content of the plugin directories is cached so that we only need to
+ * walk them again when a directory changed, and only try to load new or
+ * modified files. Plugins still need to be loaded by each process as their
+ * plugin_init function is what registers their action types, checks... */
+#define PLUGINS_CACHE_VERSION 1
+#define PLUGINS_CACHE_TYPE "(ua(sa(sx)a(sxxb)))"
+#define PLUGINS_SCAN_DEPTH 10
+
+#ifndef S_ISDIR
+#define S_ISDIR(mode) (((mode) & S_IFMT) == S_IFDIR)
+#endif
+
+typedef struct
+{
+  GstRegistry *registry;
+
+  /* Root path -> "(a(sx)a(sxxb))" GVariant from the cache file */
+  GHashTable *roots;
+  GVariantBuilder builder;
+  gboolean changed;
+
+  /* Basenames of the plugins loaded so far */
+  GHashTable *loaded;
+} PluginsScanContext;
+
+static gchar *
+_plugins_cache_get_path (void)
+{
+  const gchar *path = g_getenv ("GST_VALIDATE_REGISTRY");
+
+  if (path)
+    return g_strdup (path);
+
+  return g_build_filename (g_get_user_cache_dir (),
+      "gstreamer-" GST_API_VERSION, "validate-registry.bin", NULL);
+}
+
+static void
+_plugins_cache_load (PluginsScanContext * context, const gchar * path)
+{
+  gchar *data;
+  gsize size;
+  guint version;
+  GVariant *cache, *root;
+  GVariantIter *iter;
+  const gchar *root_path;
+
+  if (!g_file_get_contents (path, &data, &size, NULL))
+    return;
+
+  cache = g_variant_ref_sink (g_variant_new_from_data (G_VARIANT_TYPE
+          (PLUGINS_CACHE_TYPE), data, size, FALSE, g_free, data));
+
+  g_variant_get (cache, "(ua(sa(sx)a(sxxb)))", &version, &iter);
+  if (version != PLUGINS_CACHE_VERSION) {
+    GST_INFO ("Ignoring plugins cache %s with version %u", path, version);
+    goto done;
+  }
+
+  while ((root = g_variant_iter_next_value (iter))) {
+    g_variant_get_child (root, 0, "&s", &root_path);
+    g_hash_table_insert (context->roots, (gpointer) root_path, root);
+  }
+
+done:
+  g_variant_iter_free (iter);
+  /* The roots hold references on the cache data */
+  g_variant_unref (cache);
+}
+
+static void
+_plugins_cache_save (PluginsScanContext * context, const gchar * path)
+{
+  GVariant *cache;
+  gchar *dirname;
+  GError *err = NULL;
+
+  cache = g_variant_ref_sink (g_variant_new ("(u@a(sa(sx)a(sxxb)))",
+          PLUGINS_CACHE_VERSION, g_variant_builder_end (&context->builder)));
+
+  dirname = g_path_get_dirname (path);
+  g_mkdir_with_parents (dirname, 0700);
+  g_free (dirname);
+
+  /* Written atomically as other processes might be reading it */
+  if (!g_file_set_contents (path, g_variant_get_data (cache),
+          g_variant_get_size (cache), &err)) {
+    GST_INFO ("Could not write plugins cache %s: %s", path, err->message);
+    g_clear_error (&err);
+  }
+
+  g_variant_unref (cache);
+}
+
+static gint64
+_get_mtime (const gchar * path, gboolean * is_dir, gint64 * size)
+{
+  GStatBuf status;
+
+  if (g_stat (path, &status) < 0)
+    return -1;
+
+  if (is_dir)
+    *is_dir = S_ISDIR (status.st_mode);
+  if (size)
+    *size = status.st_size;
+
+  return status.st_mtime;
+}
+
+static gboolean
+_load_plugin (PluginsScanContext * context, const gchar * filename)
+{
+  GstPlugin *plugin, *loaded;
+  GError *err = NULL;
+  gchar *basename = g_path_get_basename (filename);
+
+  /* Plugins found first take precedence */
+  if (g_hash_table_contains (context->loaded, basename)) {
+    GST_DEBUG ("Plugin %s already loaded, ignoring %s", basename, filename);
+    g_free (basename);
+
+    return TRUE;
+  }
+
+  /* The validate plugins directory usually lives inside a GStreamer plugins
+   * directory, the default registry then knows about our plugins, without
+   * ever loading them as they have no features */
+  plugin = gst_registry_lookup (gst_registry_get (), filename);
+  if (plugin) {
+    GList *features =
+        gst_registry_get_feature_list_by_plugin (gst_registry_get (),
+        gst_plugin_get_name (plugin));
+
+    if (features) {
+      GST_INFO ("%s is a GStreamer plugin, not loading it as a validate plugin",
+          filename);
+      gst_plugin_feature_list_free (features);
+      gst_object_unref (plugin);
+      g_free (basename);
+
+      return TRUE;
+    }
+
+    loaded = gst_plugin_load (plugin);
+    gst_object_unref (plugin);
+    plugin = loaded;
+  } else {
+    plugin = gst_plugin_load_file (filename, &err);
+  }
+
+  if (!plugin) {
+    GST_DEBUG ("Could not load %s: %s", filename,
+        err ? err->message : "unknown error");
+    g_clear_error (&err);
+    g_free (basename);
+
+    return FALSE;
+  }
+
+  /* Loaded plugins are in the default registry */
+  gst_registry_remove_plugin (gst_registry_get (), plugin);
+  gst_registry_add_plugin (context->registry, plugin);
+  gst_object_unref (plugin);
+  g_hash_table_add (context->loaded, basename);
+
+  return TRUE;
+}
+
+static gboolean
+_can_open_module (const gchar * filename)
+{
+  GModule *module = g_module_open (filename, G_MODULE_BIND_LAZY);
+
+  if (!module) {
+    GST_INFO ("Could not open %s, trying again next time: %s", filename,
+        g_module_error ());
+
+    return FALSE;
+  }
+
+  g_module_close (module);
+
+  return TRUE;
+}
+
+static void
+_scan_plugin_file (PluginsScanContext * context, GHashTable * cached_files,
+    const gchar * filename, GVariantBuilder * files)
+{
+  GVariant *cached;
+  gint64 mtime, size, cached_mtime = -1, cached_size = -1;
+  gboolean is_plugin = TRUE;
+
+  mtime = _get_mtime (filename, NULL, &size);
+  if (mtime < 0) {
+    context->changed = TRUE;
+
+    return;
+  }
+
+  cached = cached_files ? g_hash_table_lookup (cached_files, filename) : NULL;
+  if (cached)
+    g_variant_get (cached, "(&sxxb)", NULL, &cached_mtime, &cached_size,
+        &is_plugin);
+
+  if (mtime != cached_mtime || size != cached_size) {
+    context->changed = TRUE;
+    is_plugin = TRUE;
+  }
+
+  /* Only remember files that are not plugins at all, not the ones that
+   * could not be opened as their dependencies might be found next time */
+  if (is_plugin && !_load_plugin (context, filename)
+      && _can_open_module (filename)) {
+    context->changed = TRUE;
+    is_plugin = FALSE;
+  }
+
+  g_variant_builder_add (files, "(sxxb)", filename, mtime, size, is_plugin);
+}
+
+static void
+_scan_plugins_dir (PluginsScanContext * context, GHashTable * cached_files,
+    const gchar * path, gint depth, GVariantBuilder * dirs,
+    GVariantBuilder * files)
+{
+  GDir *dir;
+  gboolean is_dir = FALSE;
+  const gchar *name;
+  gint64 mtime = _get_mtime (path, &is_dir, NULL);
+
+  /* Missing directories are recorded too, so we notice they appear */
+  g_variant_builder_add (dirs, "(sx)", path, is_dir ? mtime : -1);
+  if (!is_dir || !(dir = g_dir_open (path, 0, NULL)))
+    return;
+
+  while ((name = g_dir_read_name (dir))) {
+    gchar *filename;
+
+    if (name[0] == '.')
+      continue;
+
+    filename = g_build_filename (path, name, NULL);
+    if (g_file_test (filename, G_FILE_TEST_IS_DIR)) {
+      if (depth > 0)
+        _scan_plugins_dir (context, cached_files, filename, depth - 1, dirs,
+            files);
+    } else if (g_str_has_suffix (name, "." G_MODULE_SUFFIX)
+#ifdef __APPLE__
+        || g_str_has_suffix (name, ".dylib")
+#endif
+        ) {
+      _scan_plugin_file (context, cached_files, filename, files);
+    }
+    g_free (filename);
+  }
+
+  g_dir_close (dir);
+}
+
+static void
+gst_validate_scan_plugins_path (PluginsScanContext * context,
+    const gchar * path)
+{
+  GVariantIter iter;
+  GVariant *root, *child, *cached_dirs = NULL, *cached_files = NULL;
+  GVariantBuilder dirs, files;
+  GHashTable *cached_files_table = NULL;
+  const gchar *name;
+  gboolean up_to_date = FALSE;
+
+  g_variant_builder_init (&dirs, G_VARIANT_TYPE ("a(sx)"));
+  g_variant_builder_init (&files, G_VARIANT_TYPE ("a(sxxb)"));
+
+  root = g_hash_table_lookup (context->roots, path);
+  if (root) {
+    gint64 mtime;
+
+    g_variant_get (root, "(&s@a(sx)@a(sxxb))", NULL, &cached_dirs,
+        &cached_files);
+
+    up_to_date = TRUE;
+    g_variant_iter_init (&iter, cached_dirs);
+    while (up_to_date && g_variant_iter_next (&iter, "(&sx)", &name, &mtime)) {
+      gboolean is_dir = FALSE;
+      gint64 cur_mtime = _get_mtime (name, &is_dir, NULL);
+
+      up_to_date = (is_dir ? cur_mtime : -1) == mtime;
+    }
+
+    cached_files_table = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+        (GDestroyNotify) g_variant_unref);
+    g_variant_iter_init (&iter, cached_files);
+    while ((child = g_variant_iter_next_value (&iter))) {
+      g_variant_get_child (child, 0, "&s", &name);
+      g_hash_table_insert (cached_files_table, (gpointer) name, child);
+    }
+  }
+
+  if (up_to_date) {
+    GST_DEBUG ("Using cached content of %s", path);
+
+    /* Files might still have been replaced */
+    g_variant_iter_init (&iter, cached_files);
+    while (g_variant_iter_next (&iter, "(&sxxb)", &name, NULL, NULL, NULL))
+      _scan_plugin_file (context, cached_files_table, name, &files);
+    g_variant_builder_clear (&dirs);
+    g_variant_builder_add (&context->builder, "(s@a(sx)@a(sxxb))", path,
+        cached_dirs, g_variant_builder_end (&files));
+  } else {
+    GST_DEBUG ("Scanning %s", path);
+    context->changed = TRUE;
+    _scan_plugins_dir (context, cached_files_table, path, PLUGINS_SCAN_DEPTH,
+        &dirs, &files);
+    g_variant_builder_add (&context->builder, "(s@a(sx)@a(sxxb))", path,
+        g_variant_builder_end (&dirs), g_variant_builder_end (&files));
+  }
+
+  if (cached_files_table)
+    g_hash_table_unref (cached_files_table);
+  if (cached_dirs)
+    g_variant_unref (cached_dirs);
+  if (cached_files)
+    g_variant_unref (cached_files);
+
+  /* What is left in the roots table is saved back as is */
+  if (root)
+    g_hash_table_remove (context->roots, path);
+}
+
 static void
 gst_validate_init_plugins (void)
 {
-  GstRegistry *registry;
   const gchar *plugin_path;
-
-  gst_registry_fork_set_enabled (FALSE);
-  registry = gst_validate_registry_get ();
+  gchar *cache_path = _plugins_cache_get_path ();
+  PluginsScanContext context = { NULL, };
+
+  context.registry = gst_validate_registry_get ();
+  context.roots = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+      (GDestroyNotify) g_variant_unref);
+  context.loaded = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+      NULL);
+  g_variant_builder_init (&context.builder,
+      G_VARIANT_TYPE ("a(sa(sx)a(sxxb))"));
+  _plugins_cache_load (&context, cache_path);
 
   plugin_path = g_getenv ("GST_VALIDATE_PLUGIN_PATH");
   if (plugin_path) {
@@ -234,7 +572,7 @@ gst_validate_init_plugins (void)
     GST_DEBUG ("GST_VALIDATE_PLUGIN_PATH set to %s", plugin_path);
     list = g_strsplit (plugin_path, G_SEARCHPATH_SEPARATOR_S, 0);
     for (i = 0; list[i]; i++) {
-      gst_registry_scan_path (registry, list[i]);
+      gst_validate_scan_plugins_path (&context, list[i]);
     }
     g_strfreev (list);
   } else {
@@ -250,7 +588,7 @@ gst_validate_init_plugins (void)
         "gstreamer-" GST_API_VERSION, "plugins", NULL);
 
     GST_DEBUG ("scanning home plugins %s", home_plugins);
-    gst_registry_scan_path (registry, home_plugins);
+    gst_validate_scan_plugins_path (&context, home_plugins);
     g_free (home_plugins);
 
     /* add the main (installed) library path */
@@ -269,16 +607,35 @@ gst_validate_init_plugins (void)
 
       GST_DEBUG ("scanning DLL dir %s", dir);
 
-      gst_registry_scan_path (registry, dir);
+      gst_validate_scan_plugins_path (&context, dir);
 
       g_free (dir);
       g_free (base_dir);
     }
 #else
-    gst_registry_scan_path (registry, VALIDATEPLUGINDIR);
+    gst_validate_scan_plugins_path (&context, VALIDATEPLUGINDIR);
 #endif
   }
-  gst_registry_fork_set_enabled (TRUE);
+
+  /* Roots that were not scanned this time are kept in the cache as other
+   * processes might use another GST_VALIDATE_PLUGIN_PATH */
+  if (context.changed) {
+    GVariantBuilder *builder = &context.builder;
+    GHashTableIter iter;
+    GVariant *root;
+
+    g_hash_table_iter_init (&iter, context.roots);
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer *) & root))
+      g_variant_builder_add_value (builder, root);
+
+    _plugins_cache_save (&context, cache_path);
+  } else {
+    g_variant_builder_clear (&context.builder);
+  }
+
+  g_hash_table_unref (context.roots);
+  g_hash_table_unref (context.loaded);
+  g_free (cache_path);
 }
 
 /**
@@ -318,6 +675,8 @@ gst_validate_init (void)
 void
 gst_validate_deinit (void)
 {
+  gst_validate_printf_flush ();
+
   g_mutex_lock (&_gst_validate_registry_mutex);
   _free_plugin_config (core_config);
   gst_validate_deinit_runner ();
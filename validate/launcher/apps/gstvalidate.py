@@ -19,6 +19,7 @@
 import argparse
 import os
 import copy
+import pickle
 import sys
 import time
 import urllib.parse
@@ -26,6 +27,7 @@ import shlex
 import socket
 import subprocess
 import configparser
+import concurrent.futures as conc
 from launcher.loggable import Loggable
 
 from launcher.baseclasses import GstValidateTest, Test, \
@@ -35,7 +37,7 @@ from launcher.baseclasses import GstValidateTest, Test, \
 
 from launcher.utils import path2url, url2path, DEFAULT_TIMEOUT, which, \
     GST_SECOND, Result, Protocols, mkdir, printc, Colors, get_data_file, \
-    kill_subprocess
+    kill_subprocess, is_windows
 
 #
 # Private global variables     #
@@ -444,6 +446,11 @@ class GstValidateLaunchTest(GstValidateTest):
         self.pipeline_desc = pipeline_desc
         self.media_descriptor = media_descriptor
 
+    def can_use_worker(self):
+        return bool(self.options.use_workers and not self.options.gdb and
+                    not self.options.valgrind and not self.options.redirect_logs and
+                    not is_windows())
+
     def build_arguments(self):
         GstValidateTest.build_arguments(self)
         self.add_arguments(*shlex.split(self.pipeline_desc))
@@ -709,6 +716,7 @@ class GstValidateTestManager(GstValidateBaseTestManager):
         self._run_defaults = True
         self._is_populated = False
         self._default_generators_registered = False
+        self._media_infos_info = None
 
     def init(self):
         for command, name in [
@@ -824,86 +832,176 @@ not been tested and explicitely activated if you set use --wanted-tests ALL""")
         except configparser.NoOptionError as e:
             self.debug("Exception: %s for %s", e, media_info)
 
-    def _discover_file(self, uri, fpath):
+    def _get_media_infos_info_path(self):
+        return os.path.join(self.options.privatedir,
+                            self.name + '-media-infos.dat')
+
+    def _load_media_infos_info(self):
+        """
+        Loads the size and modification time the media files had when their
+        media info got generated, keyed by media info path
+        """
+        if self._media_infos_info is not None:
+            return self._media_infos_info
+
+        try:
+            with open(self._get_media_infos_info_path(), 'rb') as f:
+                self._media_infos_info = pickle.load(f)
+        except (FileNotFoundError, EOFError, pickle.UnpicklingError):
+            self._media_infos_info = {}
+
+        return self._media_infos_info
+
+    def _save_media_infos_info(self):
+        with open(self._get_media_infos_info_path(), 'wb') as f:
+            pickle.dump(self._media_infos_info, f)
+
+    def _get_media_stat(self, fpath):
+        try:
+            st = os.stat(fpath)
+        except OSError:
+            return None
+
+        return st.st_mtime, st.st_size
+
+    def _media_info_up_to_date(self, fpath, media_info):
+        if not os.path.isfile(media_info):
+            return False
+
+        stat = self._get_media_stat(fpath)
+        return stat is not None and \
+            self._load_media_infos_info().get(media_info) == stat
+
+    def _generate_media_infos(self, pending):
+        """
+        Runs the media check processes for the (uri, fpath, media_info,
+        include_frames, is_push) in @pending, using as many concurrent jobs
+        as tests
+        """
+        if not pending:
+            return
+
+        num_jobs = min(self.options.num_jobs, len(pending))
+        printc("Generating %d media infos using %d jobs" % (len(pending),
+                                                            num_jobs),
+               Colors.OKBLUE)
+
+        media_infos_info = self._load_media_infos_info()
+        futures = {}
+        with conc.ThreadPoolExecutor(max_workers=num_jobs) as executor:
+            for uri, fpath, media_info, include_frames, is_push in pending:
+                future = executor.submit(GstValidateMediaDescriptor.new_from_uri,
+                                         uri, False, include_frames, is_push,
+                                         media_info)
+                futures[future] = (uri, fpath, media_info)
+
+            for i, future in enumerate(conc.as_completed(futures), 1):
+                uri, fpath, media_info = futures[future]
+                if future.result():
+                    printc("[%d/%d] Generated %s" % (i, len(futures), media_info),
+                           Colors.OKGREEN)
+                    stat = self._get_media_stat(fpath)
+                    if stat is not None:
+                        media_infos_info[media_info] = stat
+                else:
+                    printc("[%d/%d] Could not generate %s" % (i, len(futures),
+                                                              media_info),
+                           Colors.FAIL)
+
+        self._save_media_infos_info()
+
+        # Add the medias in a stable order, whatever the job that finished first
+        for future, (uri, fpath, media_info) in futures.items():
+            media_descriptor = future.result()
+            if media_descriptor:
+                self._add_media(media_descriptor, uri)
+            else:
+                self.warning("Could not get any descriptor for %s" % uri)
+
+    def _discover_file(self, uri, fpath, pending):
         for ext in (GstValidateMediaDescriptor.MEDIA_INFO_EXT,
                 GstValidateMediaDescriptor.PUSH_MEDIA_INFO_EXT):
-            try:
-                is_push = False
-                media_info = "%s.%s" % (fpath, ext)
-                if ext == GstValidateMediaDescriptor.PUSH_MEDIA_INFO_EXT:
-                    if not os.path.exists(media_info):
-                        continue
-                    is_push = True
-                    uri = "push" + uri
-                args = GstValidateBaseTestManager.MEDIA_CHECK_COMMAND.split(" ")
-
-                args.append(uri)
-                if os.path.isfile(media_info) and not self.options.update_media_info:
-                    self._add_media(media_info, uri)
-                    continue
-                elif fpath.endswith(GstValidateMediaDescriptor.STREAM_INFO_EXT):
-                    self._add_media(fpath)
-                    continue
-                elif not self.options.generate_info and not self.options.update_media_info and not self.options.validate_uris:
-                    continue
-                elif self.options.update_media_info and not os.path.isfile(media_info):
-                    self.info(
-                        "%s not present. Use --generate-media-info", media_info)
-                    continue
-                elif os.path.islink(media_info):
-                    self.info(
-                        "%s is a symlink, not updating and hopefully the actual file gets updated!", media_info)
+            is_push = False
+            media_info = "%s.%s" % (fpath, ext)
+            # Use the gzipped media info when there is no plain one
+            gz_media_info = "%s.%s" % (media_info,
+                                       GstValidateMediaDescriptor.GZIP_EXT)
+            if not os.path.exists(media_info) and os.path.exists(gz_media_info):
+                media_info = gz_media_info
+            if ext == GstValidateMediaDescriptor.PUSH_MEDIA_INFO_EXT:
+                if not os.path.exists(media_info):
                     continue
+                is_push = True
+                uri = "push" + uri
+            if os.path.isfile(media_info) and not self.options.update_media_info:
+                self._add_media(media_info, uri)
+                continue
+            elif fpath.endswith(GstValidateMediaDescriptor.STREAM_INFO_EXT):
+                self._add_media(fpath)
+                continue
+            elif not self.options.generate_info and not self.options.update_media_info and not self.options.validate_uris:
+                continue
+            elif self.options.update_media_info and not os.path.isfile(media_info):
+                self.info(
+                    "%s not present. Use --generate-media-info", media_info)
+                continue
+            elif os.path.islink(media_info):
+                self.info(
+                    "%s is a symlink, not updating and hopefully the actual file gets updated!", media_info)
+                continue
+            elif self._media_info_up_to_date(fpath, media_info):
+                self.debug("%s did not change, not updating", fpath)
+                self._add_media(media_info, uri)
+                continue
 
-                include_frames = 0
-                if self.options.update_media_info:
-                    include_frames = 2
-                elif self.options.generate_info_full:
-                    include_frames = 1
+            include_frames = 0
+            if self.options.update_media_info:
+                include_frames = 2
+            elif self.options.generate_info_full:
+                include_frames = 1
 
-                media_descriptor = GstValidateMediaDescriptor.new_from_uri(
-                    uri, True, include_frames, is_push)
-                if media_descriptor:
-                    self._add_media(media_descriptor, uri)
-                else:
-                    self.warning("Could not get any descriptor for %s" % uri)
+            pending.append((uri, fpath, media_info, include_frames,
+                            is_push))
 
-            except subprocess.CalledProcessError as e:
-                if self.options.generate_info:
-                    printc("Result: Failed", Colors.FAIL)
-                else:
-                    self.error("Exception: %s", e)
-                return False
         return True
 
     def _list_uris(self):
         if self._uris:
             return self._uris
 
+        pending = []
         if self.options.validate_uris:
             for uri in self.options.validate_uris:
-                self._discover_file(uri, uri)
+                self._discover_file(uri, uri, pending)
+            self._generate_media_infos(pending)
             return self._uris
 
         if not self.args:
             if isinstance(self.options.paths, str):
                 self.options.paths = [os.path.join(self.options.paths)]
 
+            media_info_exts = tuple(
+                "%s%s" % (ext, gz)
+                for ext in (GstValidateMediaDescriptor.MEDIA_INFO_EXT,
+                            GstValidateMediaDescriptor.PUSH_MEDIA_INFO_EXT)
+                for gz in ("", "." + GstValidateMediaDescriptor.GZIP_EXT))
             for path in self.options.paths:
                 if os.path.isfile(path):
                     path = os.path.abspath(path)
-                    self._discover_file(path2url(path), path)
+                    self._discover_file(path2url(path), path, pending)
                 else:
                     for root, dirs, files in os.walk(path):
                         for f in files:
                             fpath = os.path.abspath(os.path.join(root, f))
                             if os.path.isdir(fpath) or \
-                                    fpath.endswith(GstValidateMediaDescriptor.MEDIA_INFO_EXT) or\
+                                    fpath.endswith(media_info_exts) or \
                                     fpath.endswith(ScenarioManager.FILE_EXTENSION):
                                 continue
                             else:
-                                self._discover_file(path2url(fpath), fpath)
+                                self._discover_file(path2url(fpath), fpath,
+                                                    pending)
 
+        self._generate_media_infos(pending)
         self.debug("Uris found: %s", self._uris)
 
         return self._uris
@@ -24,6 +24,10 @@ import os
 import sys
 import re
 import copy
+import datetime
+import gzip
+import heapq
+import itertools
 import shlex
 import socketserver
 import struct
@@ -297,6 +301,18 @@ class Test(Loggable):
         """
         return Result.NOT_RUN
 
+    def get_deadline(self):
+        """
+        Returns the time at which process_update needs to be called next to
+        notice that the test timed out, the value returned by
+        get_current_value is only checked at that time.
+        """
+        deadline = self.last_change_ts + self.timeout
+        if self.hard_timeout:
+            deadline = min(deadline, self.start_ts + self.hard_timeout)
+
+        return deadline
+
     def process_update(self):
         """
         Returns True when process has finished running or has timed out.
@@ -310,6 +326,12 @@ class Test(Loggable):
         if self.process.returncode is not None:
             return True
 
+        # Checked every time, get_deadline() relies on it
+        if self.hard_timeout and time.time() - self.start_ts > self.hard_timeout:
+            self.set_result(
+                Result.TIMEOUT, "Hard timeout reached: %d secs" % self.hard_timeout)
+            return True
+
         val = self.get_current_value()
 
         self.debug("Got value: %s" % val)
@@ -340,10 +362,6 @@ class Test(Loggable):
                                 self.timeout,
                                 "timeout")
                 return True
-        elif self.hard_timeout and time.time() - self.start_ts > self.hard_timeout:
-            self.set_result(
-                Result.TIMEOUT, "Hard timeout reached: %d secs" % self.hard_timeout)
-            return True
         else:
             self.last_change_ts = time.time()
             self.last_val = val
@@ -359,6 +377,13 @@ class Test(Loggable):
     def run_external_checks(self):
         pass
 
+    def can_use_worker(self):
+        """
+        Returns whether the test can be run in a GstValidateWorker instead
+        of its own process.
+        """
+        return False
+
     def thread_wrapper(self):
         def enable_sigint():
             # Restore the SIGINT handler for the child process (gdb) to ensure
@@ -370,17 +395,24 @@ class Test(Loggable):
         else:
             preexec_fn = None
 
-        self.process = subprocess.Popen(self.command,
-                                        stderr=self.out,
-                                        stdout=self.out,
-                                        env=self.proc_env,
-                                        cwd=self.workdir,
-                                        preexec_fn=preexec_fn)
-        self.process.wait()
+        if self.can_use_worker():
+            worker = GstValidateWorker.get(self.command[0], self.proc_env,
+                                           self.workdir)
+            self.process = GstValidateWorkerProcess(worker)
+            self.process.run(self.get_uuid(), self.logfile, self.proc_env,
+                             self.command[1:])
+        else:
+            self.process = subprocess.Popen(self.command,
+                                            stderr=self.out,
+                                            stdout=self.out,
+                                            env=self.proc_env,
+                                            cwd=self.workdir,
+                                            preexec_fn=preexec_fn)
+            self.process.wait()
         if self.result is not Result.TIMEOUT:
             if self.process.returncode == 0:
                 self.run_external_checks()
-            self.queue.put(None)
+            self.queue.put(self)
 
     def get_valgrind_suppression_file(self, subdir, name):
         p = get_data_file(subdir, name)
@@ -585,54 +617,264 @@ class GstValidateTCPServer(socketserver.ThreadingMixIn, socketserver.TCPServer):
     pass
 
 
+class GstValidateWorker(Loggable):
+    """
+    A `gst-validate-1.0 --worker` process running tests one after the other,
+    saving the process startup and GStreamer initialization for each test.
+    """
+
+    # The environment can't be safely modified once the worker threads are
+    # running, so tests share a worker only when they need the same one,
+    # apart from these variables which the worker sets up for each test
+    TEST_ENV_VARIABLES = ['GST_VALIDATE_UUID', 'GST_VALIDATE_SCENARIO']
+    UUID_PREFIX = 'worker-'
+
+    _idle_workers = []
+    _lock = threading.Lock()
+
+    def __init__(self, application, env, workdir):
+        Loggable.__init__(self)
+
+        self.application = application
+        self.env = self.get_worker_env(env)
+        self.workdir = workdir
+        env = dict(self.env)
+        env['GST_VALIDATE_UUID'] = self.UUID_PREFIX + str(uuid.uuid4())
+        self.process = subprocess.Popen([application, '--worker'],
+                                        stdin=subprocess.PIPE,
+                                        stdout=subprocess.PIPE,
+                                        env=env, cwd=workdir,
+                                        universal_newlines=True)
+        self.debug("Started worker %d", self.process.pid)
+
+    @classmethod
+    def is_worker_uuid(cls, uuid):
+        return uuid.startswith(cls.UUID_PREFIX)
+
+    @classmethod
+    def get_worker_env(cls, env):
+        return {name: value for name, value in env.items()
+                if name not in cls.TEST_ENV_VARIABLES}
+
+    def can_run(self, application, env, workdir):
+        return application == self.application and \
+            workdir == self.workdir and \
+            self.get_worker_env(env) == self.env
+
+    @classmethod
+    def get(cls, application, env, workdir):
+        """
+        Returns an idle worker able to run a test with @env, starting a
+        new one if needed.
+        """
+        unused = None
+        with cls._lock:
+            for worker in cls._idle_workers:
+                if worker.can_run(application, env, workdir):
+                    cls._idle_workers.remove(worker)
+                    return worker
+
+            # Do not let idle workers pile up when tests use different
+            # environments
+            if cls._idle_workers:
+                unused = cls._idle_workers.pop(0)
+
+        if unused:
+            unused.stop()
+
+        return cls(application, env, workdir)
+
+    def release(self):
+        """
+        Makes the worker available for the next tests, unless it died while
+        running the previous one.
+        """
+        if self.process.poll() is not None:
+            return
+
+        with self._lock:
+            self._idle_workers.append(self)
+
+    @classmethod
+    def stop_all(cls):
+        with cls._lock:
+            workers = cls._idle_workers
+            cls._idle_workers = []
+
+        for worker in workers:
+            worker.stop()
+
+    def stop(self):
+        self.debug("Stopping worker %d", self.process.pid)
+        self.process.stdin.close()
+        self.process.wait()
+        self.process.stdout.close()
+
+    def run(self, test_uuid, logfile, env, args):
+        """
+        Runs a test, logging into @logfile, and returns its return code,
+        which is the worker process one if it died meanwhile.
+        """
+        line = [test_uuid, logfile]
+        if env.get('GST_VALIDATE_SCENARIO'):
+            line += ['--set-scenario', env['GST_VALIDATE_SCENARIO']]
+        line += args
+
+        try:
+            self.process.stdin.write(' '.join(shlex.quote(arg) for arg in line) + '\n')
+            self.process.stdin.flush()
+            for res in self.process.stdout:
+                res = res.split()
+                if len(res) == 3 and res[0] == 'done' and res[1] == test_uuid:
+                    return int(res[2])
+        except OSError:
+            pass
+
+        return self.process.wait()
+
+
+class GstValidateWorkerProcess(object):
+    """
+    Exposes a test running in a GstValidateWorker the way a subprocess.Popen
+    would.
+    """
+
+    def __init__(self, worker):
+        self.worker = worker
+        self.pid = worker.process.pid
+        self.returncode = None
+        self._done = threading.Event()
+
+    def run(self, test_uuid, logfile, env, args):
+        try:
+            self.returncode = self.worker.run(test_uuid, logfile, env, args)
+        finally:
+            self.worker.release()
+            self._done.set()
+
+    def poll(self):
+        return self.returncode
+
+    def wait(self, timeout=None):
+        self._done.wait(timeout)
+        return self.returncode
+
+    def communicate(self):
+        self.wait()
+        return None, None
+
+    def send_signal(self, sig):
+        # The worker can't be reused once the test it runs gets killed
+        self.worker.process.send_signal(sig)
+
+    def kill(self):
+        self.send_signal(signal.SIGKILL)
+
+
 class GstValidateListener(socketserver.BaseRequestHandler):
+    # Frames are prefixed with their length, the high bit set meaning that
+    # the frame is using the compact binary encoding (see
+    # gst-validate-report.c) instead of JSON.
+    BINARY_FLAG = 0x80000000
+    BINARY_POSITION = 1
+    BINARY_ACTION = 2
+    BINARY_ACTION_DONE = 3
+
     def handle(self):
         """Implements BaseRequestHandler handle method"""
         test = None
+        identified = False
+        data = bytearray()
         while True:
-            raw_len = self.request.recv(4)
-            if raw_len == b'':
-                return
-            msglen = struct.unpack('>I', raw_len)[0]
-            msg = self.request.recv(msglen).decode()
-            if msg == '':
+            chunk = self.request.recv(65536)
+            if not chunk:
                 return
+            data += chunk
+
+            # Handle all the complete frames we have received so far
+            offset = 0
+            while len(data) - offset >= 4:
+                header = struct.unpack_from('>I', data, offset)[0]
+                msglen = header & ~self.BINARY_FLAG
+                if len(data) - offset - 4 < msglen:
+                    break
 
-            obj = json.loads(msg)
+                start = offset + 4
+                offset = start + msglen
+                if header & self.BINARY_FLAG:
+                    if not identified:
+                        return
+                    if test is not None:
+                        self.handle_binary(test, data, start)
+                    continue
 
-            if test is None:
-                # First message must contain the uuid
+                obj = json.loads(data[start:offset].decode())
+                # First message must contain the uuid, workers then send
+                # the uuid of each test they start
                 uuid = obj.get("uuid", None)
-                if uuid is None:
-                    return
-                # Find test from launcher
-                for t in self.server.launcher.tests:
-                    if uuid == t.get_uuid():
-                        test = t
-                        break
-                if test is None:
-                    self.server.launcher.error(
-                        "Could not find test for UUID %s" % uuid)
+                if uuid is not None:
+                    identified = True
+                    test = None
+                    if GstValidateWorker.is_worker_uuid(uuid):
+                        continue
+
+                    test = self.server.launcher.get_test_by_uuid(uuid)
+                    if test is None:
+                        self.server.launcher.error(
+                            "Could not find test for UUID %s" % uuid)
+                        return
+                elif not identified:
                     return
 
-            obj_type = obj.get("type", '')
-            if obj_type == 'position':
-                test.set_position(obj['position'], obj['duration'],
-                                  obj['speed'])
-            elif obj_type == 'buffering':
-                test.set_position(obj['position'], 100)
-            elif obj_type == 'action':
-                test.add_action_execution(obj)
-                # Make sure that action is taken into account when checking if process
-                # is updating
-                test.position += 1
-            elif obj_type == 'action-done':
-                # Make sure that action end is taken into account when checking if process
-                # is updating
-                test.position += 1
-                test.actions_infos[-1]['execution-duration'] = obj['execution-duration']
-            elif obj_type == 'report':
-                test.add_report(obj)
+                if test is not None:
+                    self.handle_message(test, obj)
+            del data[:offset]
+
+    def _unpack_string(self, data, offset):
+        strlen = struct.unpack_from('>I', data, offset)[0]
+        offset += 4
+        return data[offset:offset + strlen].decode(), offset + strlen
+
+    def handle_binary(self, test, data, offset):
+        msg_type = data[offset]
+        offset += 1
+        if msg_type == self.BINARY_POSITION:
+            position, duration, speed = struct.unpack_from('>qqd', data, offset)
+            test.set_position(position, duration, speed)
+        elif msg_type == self.BINARY_ACTION:
+            playback_time = struct.unpack_from('>q', data, offset)[0]
+            action_type, offset = self._unpack_string(data, offset + 8)
+            args = self._unpack_string(data, offset)[0]
+            self.handle_message(test, {'type': 'action',
+                                       'action-type': action_type,
+                                       'playback-time': playback_time,
+                                       'args': args})
+        elif msg_type == self.BINARY_ACTION_DONE:
+            duration = struct.unpack_from('>d', data, offset)[0]
+            action_type = self._unpack_string(data, offset + 8)[0]
+            self.handle_message(test, {'type': 'action-done',
+                                       'action-type': action_type,
+                                       'execution-duration': duration})
+
+    def handle_message(self, test, obj):
+        obj_type = obj.get("type", '')
+        if obj_type == 'position':
+            test.set_position(obj['position'], obj['duration'],
+                              obj['speed'])
+        elif obj_type == 'buffering':
+            test.set_position(obj['position'], 100)
+        elif obj_type == 'action':
+            test.add_action_execution(obj)
+            # Make sure that action is taken into account when checking if process
+            # is updating
+            test.position += 1
+        elif obj_type == 'action-done':
+            # Make sure that action end is taken into account when checking if process
+            # is updating
+            test.position += 1
+            test.actions_infos[-1]['execution-duration'] = obj['execution-duration']
+        elif obj_type == 'report':
+            test.add_report(obj)
 
 
 class GstValidateTest(Test):
@@ -1405,8 +1647,14 @@ class _TestsLauncher(Loggable):
 
         self.queue = queue.Queue()
         self.jobs = []
+        # Heap of [deadline, counter, test] entries, the test being set to
+        # None once it is not running anymore
+        self._deadlines = []
+        self._deadline_entries = {}
+        self._deadline_counter = itertools.count()
         self.total_num_tests = 0
         self.server = None
+        self._tests_by_uuid = {}
 
     def _list_app_dirs(self):
         app_dirs = []
@@ -1656,8 +1904,43 @@ class _TestsLauncher(Loggable):
                 raise RuntimeError("Unexpected new test in testsuite.")
 
             self.tests.extend(tests)
+
+        if self.options.shard_count:
+            self.tests = self._shard_tests(self.tests)
+
         return sorted(list(self.tests), key=lambda t: t.classname)
 
+    def _shard_tests(self, tests):
+        """
+        Returns the tests of the shard selected with --shard-index. Tests are
+        dealt longest first, each one to the least loaded shard, so that
+        shards take about the same time. The partition only depends on the
+        test names and on the durations file when set with --tests-durations,
+        without it all tests weigh the same and are dealt round robin.
+        """
+        durations = {}
+        if self.options.tests_durations:
+            durations = self._load_durations(self.options.tests_durations)
+        known = [durations[test.classname] for test in tests
+                 if test.classname in durations]
+        mean = sum(known) / len(known) if known else 1
+
+        def weight(test):
+            return durations.get(test.classname, mean)
+
+        tests = sorted(tests, key=lambda test: test.classname)
+        tests.sort(key=weight, reverse=True)
+
+        shard_tests = []
+        loads = [(0, i) for i in range(self.options.shard_count)]
+        for test in tests:
+            load, shard = heapq.heappop(loads)
+            if shard == self.options.shard_index:
+                shard_tests.append(test)
+            heapq.heappush(loads, (load + weight(test), shard))
+
+        return shard_tests
+
     def _tester_needed(self, tester):
         for testsuite in self.options.testsuites:
             if tester.name in testsuite.TEST_MANAGER:
@@ -1675,6 +1958,15 @@ class _TestsLauncher(Loggable):
 
         self.server.serve_forever(poll_interval=0.05)
 
+    def get_test_by_uuid(self, uuid):
+        test = self._tests_by_uuid.get(uuid)
+        if test is None:
+            # Tests list changed since we last indexed it
+            self._tests_by_uuid = {t.get_uuid(): t for t in self.tests}
+            test = self._tests_by_uuid.get(uuid)
+
+        return test
+
     def _start_server(self):
         self.info("Starting TCP Server")
         ready = threading.Event()
@@ -1682,7 +1974,7 @@ class _TestsLauncher(Loggable):
                                               kwargs={'ready': ready})
         self.server_thread.start()
         ready.wait()
-        os.environ["GST_VALIDATE_SERVER"] = "tcp://localhost:%s" % self.serverport
+        os.environ["GST_VALIDATE_SERVER"] = "tcp://localhost:%s?protocol=binary" % self.serverport
 
     def _stop_server(self):
         if self.server:
@@ -1691,18 +1983,43 @@ class _TestsLauncher(Loggable):
             self.server.server_close()
             self.server = None
 
+    def _schedule_deadline(self, test):
+        entry = [test.get_deadline(), next(self._deadline_counter), test]
+        self._deadline_entries[test] = entry
+        heapq.heappush(self._deadlines, entry)
+
+    def _job_done(self, test):
+        self.jobs.remove(test)
+        self._deadline_entries.pop(test)[2] = None
+
+        return test
+
     def test_wait(self):
         while True:
-            # Check process every second for timeout
+            # Wait until a test exits or the next deadline is reached
+            while self._deadlines and self._deadlines[0][2] is None:
+                heapq.heappop(self._deadlines)
+            timeout = None
+            if self._deadlines:
+                timeout = min(max(self._deadlines[0][0] - time.time(), 0),
+                              threading.TIMEOUT_MAX)
+
             try:
-                self.queue.get(timeout=1)
+                test = self.queue.get(timeout=timeout)
+                if test in self._deadline_entries and test.process_update():
+                    return self._job_done(test)
             except queue.Empty:
                 pass
 
-            for test in self.jobs:
+            now = time.time()
+            while self._deadlines and self._deadlines[0][0] <= now:
+                test = heapq.heappop(self._deadlines)[2]
+                if test is None:
+                    continue
+
                 if test.process_update():
-                    self.jobs.remove(test)
-                    return test
+                    return self._job_done(test)
+                self._schedule_deadline(test)
 
     def tests_wait(self):
         try:
@@ -1724,9 +2041,59 @@ class _TestsLauncher(Loggable):
         test.test_start(self.queue)
 
         self.jobs.append(test)
+        self._schedule_deadline(test)
 
         return True
 
+    def _get_durations_path(self):
+        """
+        Returns the path of the file in which the durations of the tests are
+        recorded, the file set with --tests-durations is never written so
+        that every shard reads the same content
+        """
+        return os.path.join(self.options.privatedir, "tests-durations.json")
+
+    def _load_durations(self, path):
+        """
+        Returns the durations, in seconds, the tests took the last time they
+        ran, keyed by test name
+        """
+        try:
+            with open(path) as f:
+                return json.load(f)
+        except (FileNotFoundError, ValueError):
+            return {}
+
+    def _save_durations(self, durations):
+        path = self._get_durations_path()
+        with open(path + ".tmp", "w") as f:
+            json.dump(durations, f, indent=1, sort_keys=True)
+        os.replace(path + ".tmp", path)
+
+    def _schedule_tests(self, tests, alone_tests, num_jobs, durations):
+        """
+        Sorts @tests so that the longest ones start first, which keeps the
+        slots busy until the end, and returns the predicted time it will
+        take to run @tests on @num_jobs slots and then @alone_tests.
+        Tests which never ran are expected to take the mean duration.
+        """
+        known = [durations[test.classname] for test in tests + alone_tests
+                 if test.classname in durations]
+        mean = sum(known) / len(known) if known else 0
+
+        def expected_duration(test):
+            return durations.get(test.classname, mean)
+
+        tests.sort(key=expected_duration, reverse=True)
+
+        # Simulate the run, each test starting on the first free slot
+        slots = [0.0] * num_jobs
+        for test in tests:
+            heapq.heapreplace(slots, slots[0] + expected_duration(test))
+
+        return max(slots, default=0) + sum(expected_duration(test)
+                                           for test in alone_tests)
+
     def _run_tests(self):
         cur_test_num = 0
 
@@ -1745,14 +2112,32 @@ class _TestsLauncher(Loggable):
                 alone_tests.append(test)
 
         max_num_jobs = min(self.options.num_jobs, len(tests))
-        jobs_running = 0
+        recorded = self._load_durations(self._get_durations_path())
+        durations = recorded
+        if self.options.tests_durations:
+            durations = self._load_durations(self.options.tests_durations)
 
         # if order of test execution doesn't matter, shuffle
         # the order to optimize cpu usage
         if self.options.shuffle:
             random.shuffle(tests)
             random.shuffle(alone_tests)
+        elif durations:
+            predicted = self._schedule_tests(tests, alone_tests, max_num_jobs,
+                                             durations)
+            printc("Predicted completion time: %s (in %s)" % (
+                time.strftime("%H:%M:%S", time.localtime(time.time() + predicted)),
+                datetime.timedelta(seconds=int(predicted))), Colors.OKBLUE)
+
+        try:
+            return self._run_scheduled_tests(tests, alone_tests, max_num_jobs,
+                                             recorded)
+        finally:
+            self._save_durations(recorded)
+            GstValidateWorker.stop_all()
 
+    def _run_scheduled_tests(self, tests, alone_tests, max_num_jobs, durations):
+        jobs_running = 0
         current_test_num = 1
         for num_jobs, tests in [(max_num_jobs, tests), (1, alone_tests)]:
             tests_left = list(tests)
@@ -1769,6 +2154,8 @@ class _TestsLauncher(Loggable):
                 current_test_num += 1
                 res = test.test_end()
                 self.reporter.after_test(test)
+                if res not in [Result.NOT_RUN, Result.SKIPPED]:
+                    durations[test.classname] = test.time_taken
                 if res != Result.PASSED and (self.options.forever or
                                              self.options.fatal_error):
                     return False
@@ -2174,13 +2561,25 @@ class GstValidateMediaDescriptor(MediaDescriptor):
     MEDIA_INFO_EXT = "media_info"
     PUSH_MEDIA_INFO_EXT = "media_info.push"
     STREAM_INFO_EXT = "stream_info"
+    # Appended to the media info extensions for gzipped media infos
+    GZIP_EXT = "gz"
+
+    # Binary media infos, see gst/validate/media-descriptor-binary.c
+    BINARY_MAGIC = b"\x89GSTVMI\n"
+    GZIP_MAGIC = b"\x1f\x8b"
+    BINARY_VERSION = 1
+    BINARY_HEADER = struct.Struct("<IIQ8I")
+    BINARY_STREAM_RECORD = struct.Struct("<10IQ")
+    BINARY_FILE_FLAG_FRAME_DETECTION = 1 << 0
+    BINARY_FILE_FLAG_SKIP_PARSERS = 1 << 1
+    BINARY_FILE_FLAG_SEEKABLE = 1 << 2
 
     def __init__(self, xml_path):
         super(GstValidateMediaDescriptor, self).__init__()
 
         self._xml_path = xml_path
         try:
-            media_xml = ET.parse(xml_path).getroot()
+            media_xml = self.parse(xml_path)
         except xml.etree.ElementTree.ParseError:
             printc("Could not parse %s" % xml_path,
                    Colors.FAIL)
@@ -2191,6 +2590,87 @@ class GstValidateMediaDescriptor(MediaDescriptor):
         self.set_protocol(urllib.parse.urlparse(
             urllib.parse.urlparse(self.get_uri()).scheme).scheme)
 
+    @staticmethod
+    def is_binary(path):
+        with open(path, "rb") as f:
+            return f.read(len(GstValidateMediaDescriptor.BINARY_MAGIC)) == \
+                GstValidateMediaDescriptor.BINARY_MAGIC
+
+    @staticmethod
+    def parse(path):
+        """
+        Returns the root element of the media info at @path, binary media
+        infos are presented as an XML tree holding only what their index
+        describes, the frames are never read. Gzipped XML media infos are
+        decompressed on the fly.
+        """
+        cls = GstValidateMediaDescriptor
+        with open(path, "rb") as f:
+            magic = f.read(len(cls.BINARY_MAGIC))
+            f.seek(0)
+            if magic.startswith(cls.GZIP_MAGIC):
+                with gzip.GzipFile(fileobj=f) as gz:
+                    return ET.parse(gz).getroot()
+
+            if magic != cls.BINARY_MAGIC:
+                return ET.parse(f).getroot()
+
+            f.seek(len(cls.BINARY_MAGIC))
+
+            header = f.read(cls.BINARY_HEADER.size)
+            if len(header) != cls.BINARY_HEADER.size:
+                raise xml.etree.ElementTree.ParseError(
+                    "%s: truncated binary media info" % path)
+
+            version, index_size, duration, flags, _checksum_type, uri, caps, \
+                n_streams, _n_tags, strings_offset, strings_size = \
+                cls.BINARY_HEADER.unpack(header)
+            if version != cls.BINARY_VERSION:
+                raise xml.etree.ElementTree.ParseError(
+                    "%s: unsupported binary media info version %d" % (path,
+                                                                      version))
+
+            start = len(cls.BINARY_MAGIC) + cls.BINARY_HEADER.size
+            index = f.read(max(index_size - start, 0))
+
+        strings_offset -= start
+        strings = index[strings_offset:strings_offset + strings_size]
+        if len(strings) != strings_size or \
+                n_streams * cls.BINARY_STREAM_RECORD.size > strings_offset:
+            raise xml.etree.ElementTree.ParseError(
+                "%s: truncated binary media info" % path)
+
+        def get_string(offset):
+            if not offset or offset >= len(strings):
+                return None
+            return strings[offset:strings.index(b"\0", offset)].decode()
+
+        def set_attributes(element, **attributes):
+            for name, value in attributes.items():
+                if value is not None:
+                    element.set(name.replace("_", "-"), value)
+            return element
+
+        root = set_attributes(
+            ET.Element("file"), uri=get_string(uri), duration=str(duration),
+            frame_detection=str(int(bool(
+                flags & cls.BINARY_FILE_FLAG_FRAME_DETECTION))),
+            skip_parsers=str(int(bool(
+                flags & cls.BINARY_FILE_FLAG_SKIP_PARSERS))),
+            seekable="true" if flags & cls.BINARY_FILE_FLAG_SEEKABLE else "false")
+        streams = set_attributes(ET.SubElement(root, "streams"),
+                                 caps=get_string(caps) or "")
+        for i in range(n_streams):
+            record = cls.BINARY_STREAM_RECORD.unpack_from(
+                index, i * cls.BINARY_STREAM_RECORD.size)
+            set_attributes(ET.SubElement(streams, "stream"),
+                           id=get_string(record[0]),
+                           caps=get_string(record[1]),
+                           padname=get_string(record[2]),
+                           type=get_string(record[3]))
+
+        return root
+
     def skip_parsers(self):
         return self._skip_parsers
 
@@ -2225,27 +2705,34 @@ class GstValidateMediaDescriptor(MediaDescriptor):
             self._track_types.append(stream.attrib["type"])
 
     @staticmethod
-    def new_from_uri(uri, verbose=False, include_frames=False, is_push=False):
+    def new_from_uri(uri, verbose=False, include_frames=False, is_push=False,
+                     descriptor_path=None):
         """
             include_frames = 0 # Never
             include_frames = 1 # always
             include_frames = 2 # if previous file included them
 
+            The media info is written next to the media unless
+            @descriptor_path is set, it is gzipped if that path ends
+            with .gz
         """
         media_path = utils.url2path(uri)
 
-        ext = GstValidateMediaDescriptor.PUSH_MEDIA_INFO_EXT if is_push else \
-            GstValidateMediaDescriptor.MEDIA_INFO_EXT
-        descriptor_path = "%s.%s" % (media_path, ext)
+        if descriptor_path is None:
+            ext = GstValidateMediaDescriptor.PUSH_MEDIA_INFO_EXT if is_push else \
+                GstValidateMediaDescriptor.MEDIA_INFO_EXT
+            descriptor_path = "%s.%s" % (media_path, ext)
         args = GstValidateBaseTestManager.MEDIA_CHECK_COMMAND.split(" ")
         args.append(uri)
         if include_frames == 2:
             try:
-                media_xml = ET.parse(descriptor_path).getroot()
+                media_xml = GstValidateMediaDescriptor.parse(descriptor_path)
 
                 include_frames = bool(int(media_xml.attrib["frame-detection"]))
                 if bool(int(media_xml.attrib.get("skip-parsers"))):
                     args.append("--skip-parsers")
+                if GstValidateMediaDescriptor.is_binary(descriptor_path):
+                    args.append("--binary")
             except FileNotFoundError:
                 pass
         else:
@@ -2284,13 +2771,21 @@ class GstValidateMediaDescriptor(MediaDescriptor):
     def need_clock_sync(self):
         return Protocols.needs_clock_sync(self.get_protocol())
 
+    def _get_uncompressed_path(self):
+        gz_ext = "." + self.GZIP_EXT
+        if self._xml_path.endswith(gz_ext):
+            return self._xml_path[:-len(gz_ext)]
+
+        return self._xml_path
+
     def get_media_filepath(self):
+        xml_path = self._get_uncompressed_path()
         if self.get_protocol() == Protocols.FILE:
-            return self._xml_path.replace("." + self.MEDIA_INFO_EXT, "")
+            return xml_path.replace("." + self.MEDIA_INFO_EXT, "")
         elif self.get_protocol() == Protocols.PUSHFILE:
-            return self._xml_path.replace("." + self.PUSH_MEDIA_INFO_EXT, "")
+            return xml_path.replace("." + self.PUSH_MEDIA_INFO_EXT, "")
         else:
-            return self._xml_path.replace("." + self.STREAM_INFO_EXT, "")
+            return xml_path.replace("." + self.STREAM_INFO_EXT, "")
 
     def get_caps(self):
         return self._caps
@@ -2305,7 +2800,7 @@ class GstValidateMediaDescriptor(MediaDescriptor):
         return self._duration
 
     def set_protocol(self, protocol):
-        if self._xml_path.endswith(GstValidateMediaDescriptor.PUSH_MEDIA_INFO_EXT):
+        if self._get_uncompressed_path().endswith(self.PUSH_MEDIA_INFO_EXT):
             self._protocol = Protocols.PUSHFILE
         else:
             self._protocol = protocol
@@ -197,12 +197,17 @@ class LauncherConfig(Loggable):
         self.gdb = False
         self.no_display = False
         self.xunit_file = None
+        self.merge_xunit = []
+        self.shard_index = None
+        self.shard_count = None
+        self.tests_durations = None
         self.main_dir = utils.DEFAULT_MAIN_DIR
         self.output_dir = None
         self.logsdir = None
         self.privatedir = None
         self.redirect_logs = False
         self.num_jobs = multiprocessing.cpu_count()
+        self.use_workers = False
         self.dest = None
         self._using_default_paths = False
         # paths passed with --media-path, and not defined by a testsuite
@@ -296,6 +301,22 @@ class LauncherConfig(Loggable):
         if self.generate_info_full is True:
             self.generate_info = True
 
+        if self.shard_index is not None or self.shard_count is not None:
+            if self.shard_index is None or self.shard_count is None:
+                printc("--shard-index and --shard-count must be used together",
+                       Colors.FAIL, True)
+                return False
+
+            if self.shard_count < 1 or not 0 <= self.shard_index < self.shard_count:
+                printc("--shard-index must be between 0 and --shard-count - 1",
+                       Colors.FAIL, True)
+                return False
+
+        if self.merge_xunit and not self.xunit_file:
+            printc("--merge-xunit needs --xunit-file to be set",
+                   Colors.FAIL, True)
+            return False
+
         if self.sync_all is True or self.force_sync is True:
             self.sync = True
 
@@ -437,7 +458,9 @@ Note that all testsuite should be inside python modules, so the directory should
                         help="Set it in order to generate the missing .media_infos files")
     parser.add_argument("--update-media-info", dest="update_media_info",
                         action="store_true",
-                        help="Set it in order to update existing .media_infos files")
+                        help="Set it in order to update existing .media_infos files, "
+                        "media files which did not change since their .media_info was "
+                        "generated by the launcher are skipped")
     parser.add_argument(
         "-G", "--generate-media-info-with-frame-detection", dest="generate_info_full",
         action="store_true",
@@ -476,7 +499,28 @@ Note that all testsuite should be inside python modules, so the directory should
     parser.add_argument('--shuffle', dest="shuffle", action="store_true",
                         help="Runs the test in a random order. Can help speed up the overall"
                              " test time by running synchronized and unsynchronized tests"
-                             " at the same time")
+                             " at the same time. By default tests are run longest first,"
+                             " using the durations recorded during previous runs")
+    parser.add_argument('--tests-durations', dest="tests_durations",
+                        metavar="FILE",
+                        help="A file with the durations of the tests, used to schedule"
+                             " tests and balance shards instead of the durations recorded"
+                             " in the launcher private directory (tests-durations.json)."
+                             " It is only read, so it can be shared by all the shards")
+    parser.add_argument('--shard-index', dest="shard_index", type=int,
+                        help="Only run the tests of the shard with that index, starting"
+                             " from 0, see --shard-count")
+    parser.add_argument('--shard-count', dest="shard_count", type=int,
+                        help="Split the tests in that many shards, to run them on"
+                             " several machines. When --tests-durations is set, shards"
+                             " are balanced so that they take about the same time,"
+                             " all machines need to use the same durations file in"
+                             " that case")
+    parser.add_argument('--merge-xunit', dest="merge_xunit", action="append",
+                        metavar="FILE",
+                        help="Merge the given xunit file, for example from a shard,"
+                             " into the file set with --xunit-file instead of running"
+                             " tests. Can be used several times")
     dir_group = parser.add_argument_group(
         "Directories and files to be used by the launcher")
     dir_group.add_argument("-M", "--main-dir", dest="main_dir",
@@ -501,9 +545,18 @@ Note that all testsuite should be inside python modules, so the directory should
                            default=False, action='store_true',
                            help="Redirect logs to stdout.")
     dir_group.add_argument("-j", "--jobs", dest="num_jobs",
-                           help="Number of tests to execute simultaneously"
+                           help="Number of tests to execute simultaneously, also used"
+                           " to generate media infos in parallel"
                            " (Defaults to number of cores of the processor)",
                            type=int)
+    dir_group.add_argument("--workers", dest="use_workers",
+                           default=False, action='store_true',
+                           help="Run the gst-validate tests in long lived"
+                           " 'gst-validate-1.0 --worker' processes, running tests"
+                           " one after the other, instead of starting a process per test."
+                           " Only tests using the same environment, apart from the"
+                           " scenario, share a worker, and a worker gets replaced"
+                           " when a test crashes it.")
     dir_group.add_argument("--ignore-numfailures", dest="ignore_numfailures",
                            help="Ignore the number of failed test in exit code",
                            default=False, action='store_true')
@@ -556,6 +609,10 @@ Note that all testsuite should be inside python modules, so the directory should
     if not options.cleanup():
         exit(1)
 
+    if options.merge_xunit:
+        reporters.merge_xunit_files(options.merge_xunit, options.xunit_file)
+        return 0
+
     if options.remote_assets_url and options.sync and not os.path.exists(options.clone_dir):
         if not download_assets(options):
             exit(1)
@@ -25,6 +25,7 @@ import time
 import codecs
 import datetime
 import tempfile
+import xml.etree.ElementTree as ET
 from .loggable import Loggable
 from xml.sax import saxutils
 from .utils import Result, printc, Colors
@@ -243,3 +244,23 @@ class XunitReporter(Reporter):
             if isinstance(s, str):
                 s = s.decode(self.encoding, 'replace')
         return s
+
+
+def merge_xunit_files(paths, output):
+    """Merges the xunit files written by XunitReporter at @paths, for
+    example by the different shards of a run, into @output."""
+    stats = {'tests': 0, 'errors': 0, 'failures': 0, 'skipped': 0}
+    testcases = []
+    for path in paths:
+        testsuite = ET.parse(path).getroot()
+        for stat in stats:
+            stats[stat] += int(testsuite.get(stat, 0))
+        testcases.extend(testsuite)
+
+    testsuite = ET.Element('testsuite', name='gst-validate-launcher')
+    for stat, value in stats.items():
+        testsuite.set(stat, str(value))
+    testsuite.extend(testcases)
+
+    ET.ElementTree(testsuite).write(output, encoding=XunitReporter.encoding,
+                                    xml_declaration=True)
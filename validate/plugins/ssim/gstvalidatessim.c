@@ -73,6 +73,14 @@
  *    used to configure the following configuration expressions. In practice this
  *    means that it will change the default values for the other configuration
  *    expressions.
+ *  - dump-threads: (default 2): The number of threads encoding and writing
+ *    the image files, outside of the streaming thread
+ *  - dump-queue-size: (default 4): The maximum number of frames waiting to
+ *    be written
+ *  - dump-policy: (default "block"): What to do when the dump queue is full,
+ *    "block" waits for room in the streaming thread, "drop" does not dump
+ *    the frame and "sample" drops frames but still waits for room to dump
+ *    one frame out of dump-queue-size, so that the stream stays covered
  *
  * # Example #
  *
@@ -146,8 +154,27 @@ typedef struct
   gchar *path;
   GstClockTime position;
   guint width, height;
+
+  /* Order in which the frame was queued for dumping */
+  guint seqnum;
 } Frame;
 
+typedef enum
+{
+  DUMP_POLICY_BLOCK,
+  DUMP_POLICY_DROP,
+  DUMP_POLICY_SAMPLE,
+} DumpPolicy;
+
+/* A frame waiting to be written by a dump thread */
+typedef struct
+{
+  Frame frame;
+
+  GstBuffer *buffer;
+  GstVideoInfo info;
+} DumpJob;
+
 static void
 free_frame (Frame * frame)
 {
@@ -167,16 +194,29 @@ struct _ValidateSsimOverridePrivate
   GstVideoInfo in_info;
   GstVideoInfo out_info;
 
+  /* Written frames, protected by dump_lock */
   GArray *frames;
   GstClockTime recurrence;
   GstClockTime last_dump_position;
 
+  GThreadPool *dump_pool;
+  GMutex dump_lock;
+  GCond dump_cond;
+  guint n_pending_dumps;
+  guint max_pending_dumps;
+  DumpPolicy dump_policy;
+  guint n_dropped_dumps;
+  guint n_consecutive_drops;
+
   /* Always used in the streaming thread */
   gboolean needs_reconfigure;
   GstVideoFormat save_format;
   const gchar *ext;
   GstVideoFormat ref_format;
   const gchar *ref_ext;
+  /* Names of the dumped or being dumped files */
+  GHashTable *filenames;
+  guint dump_seqnum;
 };
 
 
@@ -195,6 +235,26 @@ G_DEFINE_TYPE_WITH_PRIVATE (ValidateSsimOverride, validate_ssim_override,
     GST_TYPE_VALIDATE_OVERRIDE)
 /*  *INDENT-ON* */
 
+static void _dump_frame (DumpJob * job, ValidateSsimOverride * self);
+
+static gint
+_sort_frames (Frame * a, Frame * b)
+{
+  return a->seqnum < b->seqnum ? -1 : a->seqnum > b->seqnum;
+}
+
+static void
+_flush_dumps (ValidateSsimOverride * self)
+{
+  g_mutex_lock (&self->priv->dump_lock);
+  while (self->priv->n_pending_dumps)
+    g_cond_wait (&self->priv->dump_cond, &self->priv->dump_lock);
+
+  /* Dump threads may finish out of order */
+  g_array_sort (self->priv->frames, (GCompareFunc) _sort_frames);
+  g_mutex_unlock (&self->priv->dump_lock);
+}
+
 static void
 runner_stopping (GstValidateRunner * runner, ValidateSsimOverride * self)
 {
@@ -209,6 +269,12 @@ runner_stopping (GstValidateRunner * runner, ValidateSsimOverride * self)
       gst_structure_get_string (self->priv->config,
       "reference-images-dir");
 
+  _flush_dumps (self);
+
+  if (self->priv->n_dropped_dumps)
+    gst_validate_printf (self, "%d frames were not dumped as the dump queue"
+        " was full\n", self->priv->n_dropped_dumps);
+
   if (!compared_files_dir) {
     return;
   }
@@ -281,7 +347,8 @@ _runner_set (GObject * object, GParamSpec * pspec, gpointer user_data)
 static ValidateSsimOverride *
 validate_ssim_override_new (GstStructure * config)
 {
-  const gchar *format;
+  const gchar *format, *policy;
+  gint dump_threads = 2, dump_queue_size = 4;
   ValidateSsimOverride *self = g_object_new (VALIDATE_SSIM_OVERRIDE_TYPE, NULL);
 
   self->priv->outdir =
@@ -348,6 +415,28 @@ validate_ssim_override_new (GstStructure * config)
   gst_validate_utils_get_clocktime (config, "check-recurrence",
       &self->priv->recurrence);
 
+  gst_structure_get_int (config, "dump-threads", &dump_threads);
+  gst_structure_get_int (config, "dump-queue-size", &dump_queue_size);
+  self->priv->max_pending_dumps = MAX (dump_queue_size, 1);
+
+  policy = gst_structure_get_string (config, "dump-policy");
+  if (!policy || !g_strcmp0 (policy, "block")) {
+    self->priv->dump_policy = DUMP_POLICY_BLOCK;
+  } else if (!g_strcmp0 (policy, "drop")) {
+    self->priv->dump_policy = DUMP_POLICY_DROP;
+  } else if (!g_strcmp0 (policy, "sample")) {
+    self->priv->dump_policy = DUMP_POLICY_SAMPLE;
+  } else {
+    GST_ERROR ("Unknown dump policy: %s", policy);
+
+    gst_object_unref (self);
+
+    return NULL;
+  }
+
+  self->priv->dump_pool = g_thread_pool_new ((GFunc) _dump_frame, self,
+      MAX (dump_threads, 1), FALSE, NULL);
+
   g_signal_connect (self, "notify::validate-runner", G_CALLBACK (_runner_set),
       NULL);
 
@@ -417,6 +506,10 @@ _finalize (GObject * object)
 {
   ValidateSsimOverridePrivate *priv = VALIDATE_SSIM_OVERRIDE (object)->priv;
 
+  /* Waits for the pending dumps */
+  if (priv->dump_pool)
+    g_thread_pool_free (priv->dump_pool, FALSE, TRUE);
+
   if (priv->converter)
     gst_video_converter_free (priv->converter);
 
@@ -426,6 +519,9 @@ _finalize (GObject * object)
   g_free (priv->outdir);
   g_free (priv->result_outdir);
   g_array_unref (priv->frames);
+  g_hash_table_unref (priv->filenames);
+  g_mutex_clear (&priv->dump_lock);
+  g_cond_clear (&priv->dump_cond);
 
   if (priv->config)
     gst_structure_free (priv->config);
@@ -470,6 +566,11 @@ validate_ssim_override_init (ValidateSsimOverride * self)
   self->priv->needs_reconfigure = TRUE;
   self->priv->frames = g_array_new (TRUE, TRUE, sizeof (Frame));
   g_array_set_clear_func (self->priv->frames, (GDestroyNotify) free_frame);
+  self->priv->filenames = g_hash_table_new_full (g_str_hash, g_str_equal,
+      g_free, NULL);
+
+  g_mutex_init (&self->priv->dump_lock);
+  g_cond_init (&self->priv->dump_cond);
 }
 
 static gboolean
@@ -531,15 +632,7 @@ _set_videoconvert (ValidateSsimOverride * o,
 static gboolean
 has_frame (ValidateSsimOverride * self, gchar * name)
 {
-  guint i;
-  GArray *frames = self->priv->frames;
-
-  for (i = 0; i < frames->len; ++i) {
-    if (g_strcmp0 (g_array_index (frames, Frame, i).path, name) == 0)
-      return TRUE;
-  }
-
-  return FALSE;
+  return g_hash_table_contains (self->priv->filenames, name);
 }
 
 
@@ -643,13 +736,82 @@ _save_frame (ValidateSsimOverride * self, GstVideoFrame * frame,
   return res;
 }
 
+/* Called from the dump threads */
+static void
+_dump_frame (DumpJob * job, ValidateSsimOverride * self)
+{
+  GstVideoFrame frame;
+  gboolean saved = FALSE;
+  ValidateSsimOverridePrivate *priv = self->priv;
+
+  if (!gst_video_frame_map (&frame, &job->info, job->buffer, GST_MAP_READ)) {
+    GST_VALIDATE_REPORT (self, SSIM_CONVERSION_ERROR,
+        "Could not map the buffer %p", job->buffer);
+  } else {
+    saved = _save_frame (self, &frame, job->frame.path);
+    gst_video_frame_unmap (&frame);
+  }
+  gst_buffer_unref (job->buffer);
+
+  g_mutex_lock (&priv->dump_lock);
+  if (saved)
+    g_array_append_val (priv->frames, job->frame);
+  else
+    free_frame (&job->frame);
+
+  priv->n_pending_dumps--;
+  g_cond_broadcast (&priv->dump_cond);
+  g_mutex_unlock (&priv->dump_lock);
+
+  g_slice_free (DumpJob, job);
+}
+
+/* Makes room in the dump queue according to the dump policy, returns %FALSE
+ * if the frame should not be dumped */
+static gboolean
+_reserve_dump (ValidateSsimOverride * self)
+{
+  gboolean res = TRUE;
+  ValidateSsimOverridePrivate *priv = self->priv;
+
+  g_mutex_lock (&priv->dump_lock);
+  if (priv->n_pending_dumps >= priv->max_pending_dumps) {
+    if (priv->dump_policy == DUMP_POLICY_DROP ||
+        (priv->dump_policy == DUMP_POLICY_SAMPLE &&
+            priv->n_consecutive_drops + 1 < priv->max_pending_dumps)) {
+      res = FALSE;
+    } else {
+      while (priv->n_pending_dumps >= priv->max_pending_dumps)
+        g_cond_wait (&priv->dump_cond, &priv->dump_lock);
+    }
+  }
+
+  if (res) {
+    priv->n_pending_dumps++;
+    priv->n_consecutive_drops = 0;
+  } else {
+    priv->n_dropped_dumps++;
+    priv->n_consecutive_drops++;
+  }
+  g_mutex_unlock (&priv->dump_lock);
+
+  return res;
+}
+
+static void
+_release_dump (ValidateSsimOverride * self)
+{
+  g_mutex_lock (&self->priv->dump_lock);
+  self->priv->n_pending_dumps--;
+  g_cond_broadcast (&self->priv->dump_cond);
+  g_mutex_unlock (&self->priv->dump_lock);
+}
+
 static void
 _handle_buffer (GstValidateOverride * override,
     GstValidatePadMonitor * pad_monitor, GstBuffer * buffer)
 {
-  gchar *outname = NULL;
-  GstVideoFrame frame;
-  Frame iframe;
+  DumpJob *job;
 
   ValidateSsimOverride *o = VALIDATE_SSIM_OVERRIDE (override);
   ValidateSsimOverridePrivate *priv = o->priv;
@@ -672,15 +834,23 @@ _handle_buffer (GstValidateOverride * override,
     priv->needs_reconfigure = !_set_videoconvert (o, pad_monitor);
   }
 
+  if (!_reserve_dump (o)) {
+    GST_LOG_OBJECT (override, "Dump queue full, not dumping buffer: %"
+        GST_TIME_FORMAT, GST_TIME_ARGS (position));
+
+    return;
+  }
+
+  job = g_slice_new0 (DumpJob);
   if (priv->converter) {
-    GstVideoFrame inframe;
+    GstVideoFrame inframe, frame;
     GstBuffer *outbuf;
 
     if (!gst_video_frame_map (&inframe, &priv->in_info, buffer, GST_MAP_READ)) {
       GST_VALIDATE_REPORT (o, SSIM_CONVERSION_ERROR,
           "Could not map the videoframe %p", buffer);
 
-      return;
+      goto fail;
     }
 
     outbuf = gst_buffer_new_allocate (NULL, priv->out_info.size, NULL);
@@ -688,32 +858,39 @@ _handle_buffer (GstValidateOverride * override,
       GST_VALIDATE_REPORT (o, SSIM_CONVERSION_ERROR,
           "Could not map the outbuffer %p", outbuf);
 
+      gst_video_frame_unmap (&inframe);
       gst_buffer_unref (outbuf);
-      return;
+      goto fail;
     }
-    gst_buffer_unref (outbuf);
     gst_video_converter_frame (priv->converter, &inframe, &frame);
     gst_video_frame_unmap (&inframe);
+    gst_video_frame_unmap (&frame);
+
+    job->buffer = outbuf;
+    job->info = priv->out_info;
   } else {
-    if (!gst_video_frame_map (&frame, &priv->in_info, buffer, GST_MAP_WRITE)) {
-      GST_VALIDATE_REPORT (o, SSIM_CONVERSION_ERROR,
-          "Could not map the buffer %p", buffer);
-      return;
-    }
+    /* Encoding and writing happen in a dump thread, which only reads
+     * the buffer */
+    job->buffer = gst_buffer_ref (buffer);
+    job->info = priv->in_info;
   }
 
-  outname = _get_filename (o, pad_monitor, position);
-  if (_save_frame (o, &frame, outname)) {
-    priv->last_dump_position = position;
+  job->frame.path = _get_filename (o, pad_monitor, position);
+  job->frame.position = position;
+  job->frame.width = priv->in_info.width;
+  job->frame.height = priv->in_info.height;
+  job->frame.seqnum = priv->dump_seqnum++;
 
-    iframe.position = position;
-    iframe.path = outname;
-    iframe.width = priv->in_info.width;
-    iframe.height = priv->in_info.height;
-    g_array_append_val (priv->frames, iframe);
-  }
+  g_hash_table_add (priv->filenames, g_strdup (job->frame.path));
+  priv->last_dump_position = position;
+
+  g_thread_pool_push (priv->dump_pool, job, NULL);
 
-  gst_video_frame_unmap (&frame);
+  return;
+
+fail:
+  g_slice_free (DumpJob, job);
+  _release_dump (o);
 }
 
 static void
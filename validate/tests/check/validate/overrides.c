@@ -92,6 +92,60 @@ GST_START_TEST (check_text_overrides)
 
 GST_END_TEST;
 
+static GstValidateMonitor *
+_create_monitor (GstValidateRunner * runner, const gchar * factoryname,
+    const gchar * name)
+{
+  GstElement *element = gst_element_factory_make (factoryname, name);
+  GstValidateMonitor *monitor =
+      gst_validate_monitor_factory_create (GST_OBJECT (element), runner, NULL);
+
+  gst_object_unref (element);
+
+  return monitor;
+}
+
+GST_START_TEST (check_name_overrides)
+{
+  GstValidateMonitor *monitor;
+  GstValidateRunner *runner = gst_validate_runner_new ();
+  GstValidateOverride *substring = gst_validate_override_new ();
+  GstValidateOverride *exact = gst_validate_override_new ();
+  GstValidateOverride *prefix = gst_validate_override_new ();
+  GstValidateOverride *regex = gst_validate_override_new ();
+
+  gst_validate_override_register_by_name ("queue", substring);
+  gst_validate_override_register_by_name ("^myqueue$", exact);
+  gst_validate_override_register_by_name ("^my.*", prefix);
+  gst_validate_override_register_by_name ("[0-9]$", regex);
+
+  monitor = _create_monitor (runner, "queue", "myqueue");
+  fail_unless_equals_int (monitor->overrides.length, 3);
+  fail_unless (g_queue_peek_nth (&monitor->overrides, 0) == substring);
+  fail_unless (g_queue_peek_nth (&monitor->overrides, 1) == exact);
+  fail_unless (g_queue_peek_nth (&monitor->overrides, 2) == prefix);
+  gst_object_unref (monitor);
+
+  monitor = _create_monitor (runner, "queue", "myqueue2");
+  fail_unless_equals_int (monitor->overrides.length, 3);
+  fail_unless (g_queue_peek_nth (&monitor->overrides, 0) == substring);
+  fail_unless (g_queue_peek_nth (&monitor->overrides, 1) == prefix);
+  fail_unless (g_queue_peek_nth (&monitor->overrides, 2) == regex);
+  gst_object_unref (monitor);
+
+  monitor = _create_monitor (runner, "identity", "notmine");
+  fail_unless_equals_int (monitor->overrides.length, 0);
+  gst_object_unref (monitor);
+
+  gst_object_unref (substring);
+  gst_object_unref (exact);
+  gst_object_unref (prefix);
+  gst_object_unref (regex);
+  gst_object_unref (runner);
+}
+
+GST_END_TEST;
+
 
 static Suite *
 gst_validate_suite (void)
@@ -107,6 +161,7 @@ gst_validate_suite (void)
   g_setenv ("GST_VALIDATE_REPORTING_DETAILS", "all", TRUE);
   gst_validate_init ();
   tcase_add_test (tc_chain, check_text_overrides);
+  tcase_add_test (tc_chain, check_name_overrides);
   gst_validate_deinit ();
 
   return s;
@@ -17,7 +17,9 @@
  * Boston, MA 02110-1301, USA.
  */
 
+#include <unistd.h>
 #include <gio/gio.h>
+#include <glib/gstdio.h>
 #include <gst/validate/validate.h>
 #include <gst/validate/gst-validate-pad-monitor.h>
 #include <gst/validate/media-descriptor-parser.h>
@@ -525,6 +527,21 @@ static const gchar * media_info =
 "    </stream>"
 "  </streams>"
 "</file>";
+
+/* Checksums are the reference XXH64 vectors with a 0 seed */
+static const gchar * media_info_xxh64 =
+"<file duration='10031000000' frame-detection='1' uri='file:///I/am/so/fake.fakery' seekable='true' checksum-type='xxh64'>"
+"  <streams caps='video/quicktime'>"
+"    <stream type='video' caps='video/x-raw'>"
+"       <frame duration='1' id='0' is-keyframe='true'  offset='18446744073709551615' offset-end='18446744073709551615' pts='0'  dts='0' checksum='ef46db3751d8e999'/>"  /* empty */
+"       <frame duration='1' id='1' is-keyframe='false' offset='18446744073709551615' offset-end='18446744073709551615' pts='1'  dts='1' checksum='44bc2cf5ad770999'/>" /* abc */
+"       <frame duration='1' id='2' is-keyframe='false' offset='18446744073709551615' offset-end='18446744073709551615' pts='2'  dts='2' checksum='fbcea83c8a378bf1'/>" /* 39 bytes, goes through the stripes loop */
+"       <frame duration='1' id='3' is-keyframe='false' offset='18446744073709551615' offset-end='18446744073709551615' pts='3'  dts='3' checksum='44bc2cf5ad770999'/>" /* gonna fail */
+"      <tags>"
+"      </tags>"
+"    </stream>"
+"  </streams>"
+"</file>";
 /* *INDENT-ON* */
 
 typedef struct _BufferDesc
@@ -559,8 +576,38 @@ _create_buffer (BufferDesc * bdesc)
   return buffer;
 }
 
+/* Round trips @mdesc through the binary format */
+static GstValidateMediaDescriptor *
+_convert_to_binary (GstValidateRunner * runner,
+    GstValidateMediaDescriptor * mdesc)
+{
+  gint fd;
+  gchar *path;
+  GError *err = NULL;
+  GstValidateMediaDescriptor *binary;
+
+  fd = g_file_open_tmp ("validate-XXXXXX.media_info", &path, &err);
+  fail_unless (fd >= 0, "Could not create temporary file: %s",
+      err ? err->message : "");
+  close (fd);
+
+  fail_unless (gst_validate_media_descriptor_write_binary (mdesc, path, &err));
+  binary = (GstValidateMediaDescriptor *)
+      gst_validate_media_descriptor_parser_new (runner, path, &err);
+  fail_unless (binary != NULL, "Could not parse binary media info: %s",
+      err ? err->message : "");
+  fail_unless (gst_validate_media_descriptors_compare (mdesc, binary));
+
+  g_unlink (path);
+  g_free (path);
+  gst_object_unref (mdesc);
+
+  return binary;
+}
+
 static void
-_check_media_info (GstSegment * segment, BufferDesc * bufs)
+_check_media_info (const gchar * xml, GstSegment * segment, BufferDesc * bufs,
+    gboolean binary)
 {
   GstEvent *segev;
   GstBuffer *buffer;
@@ -579,8 +626,9 @@ _check_media_info (GstSegment * segment, BufferDesc * bufs)
   runner = gst_validate_runner_new ();
 
   mdesc = (GstValidateMediaDescriptor *)
-      gst_validate_media_descriptor_parser_new_from_xml (runner, media_info,
-      &err);
+      gst_validate_media_descriptor_parser_new_from_xml (runner, xml, &err);
+  if (binary)
+    mdesc = _convert_to_binary (runner, mdesc);
 
   decoder = fake_decoder_new ();
   monitor = _start_monitoring_element (decoder, runner);
@@ -648,19 +696,26 @@ _check_media_info (GstSegment * segment, BufferDesc * bufs)
   gst_object_unref (monitor);
 }
 
-#define MEDIA_INFO_TEST(name,segment_start,bufs) \
-GST_START_TEST(media_info_##name) { \
+#define MEDIA_INFO_TEST(name,xml,segment_start,bufs) \
+static void \
+_check_media_info_##name (gboolean binary) { \
   if (segment_start >= 0) { \
     GstSegment segment; \
     gst_segment_init (&segment, GST_FORMAT_TIME); \
     segment.start = segment_start; \
-     _check_media_info (&segment, (bufs)); \
+     _check_media_info ((xml), &segment, (bufs), binary); \
   } else \
-     _check_media_info (NULL, (bufs)); \
+     _check_media_info ((xml), NULL, (bufs), binary); \
+} \
+GST_START_TEST(media_info_##name) { \
+  _check_media_info_##name (FALSE); \
+} GST_END_TEST; \
+GST_START_TEST(media_info_binary_##name) { \
+  _check_media_info_##name (TRUE); \
 } GST_END_TEST
 
 /* *INDENT-OFF* */
-MEDIA_INFO_TEST (1, -1,
+MEDIA_INFO_TEST (1, media_info, -1,
       ((BufferDesc []) {
       {
         .content = "buffer1",
@@ -698,7 +753,7 @@ MEDIA_INFO_TEST (1, -1,
     }));
 
 /* Segment start is 2, the first buffer is expected (first Keyframe) */
-MEDIA_INFO_TEST (2, 2,
+MEDIA_INFO_TEST (2, media_info, 2,
       ((BufferDesc []) {
       {
         .content = "buffer2", /* Wrong checksum */
@@ -712,7 +767,7 @@ MEDIA_INFO_TEST (2, 2,
     }));
 
 /* Segment start is 2, the first buffer is expected (first Keyframe) */
-MEDIA_INFO_TEST (3, 2,
+MEDIA_INFO_TEST (3, media_info, 2,
       ((BufferDesc []) {
       { /*  The right first buffer */
         .content = "buffer1",
@@ -726,7 +781,7 @@ MEDIA_INFO_TEST (3, 2,
     }));
 
 /* Segment start is 6, the 4th buffer is expected (first Keyframe) */
-MEDIA_INFO_TEST (4, 6,
+MEDIA_INFO_TEST (4, media_info, 6,
       ((BufferDesc []) {
       { /*  The right fourth buffer */
         .content = "buffer4",
@@ -740,7 +795,7 @@ MEDIA_INFO_TEST (4, 6,
     }));
 
 /* Segment start is 6, the 4th buffer is expected (first Keyframe) */
-MEDIA_INFO_TEST (5, 6,
+MEDIA_INFO_TEST (5, media_info, 6,
       ((BufferDesc []) {
       { /*  The sixth buffer... all wrong! */
         .content = "buffer6",
@@ -752,6 +807,43 @@ MEDIA_INFO_TEST (5, 6,
       },
       { NULL}
     }));
+
+MEDIA_INFO_TEST (xxh64, media_info_xxh64, -1,
+      ((BufferDesc []) {
+      {
+        .content = "",
+        .pts = 0,
+        .dts = 0,
+        .duration = 1,
+        .keyframe = TRUE,
+        .num_issues = 0
+      },
+      {
+        .content = "abc",
+        .pts = 1,
+        .dts = 1,
+        .duration = 1,
+        .keyframe = FALSE,
+        .num_issues = 0
+      },
+      {
+        .content = "Nobody inspects the spammish repetition",
+        .pts = 2,
+        .dts = 2,
+        .duration = 1,
+        .keyframe = FALSE,
+        .num_issues = 0
+      },
+      {
+        .content = "abd",
+        .pts = 3,
+        .dts = 3,
+        .duration = 1,
+        .keyframe = FALSE,
+        .num_issues = 1
+      },
+      { NULL}
+    }));
 /* *INDENT-ON* */
 
 GST_START_TEST (caps_events)
@@ -1073,6 +1165,13 @@ gst_validate_suite (void)
   tcase_add_test (tc_chain, media_info_3);
   tcase_add_test (tc_chain, media_info_4);
   tcase_add_test (tc_chain, media_info_5);
+  tcase_add_test (tc_chain, media_info_xxh64);
+  tcase_add_test (tc_chain, media_info_binary_1);
+  tcase_add_test (tc_chain, media_info_binary_2);
+  tcase_add_test (tc_chain, media_info_binary_3);
+  tcase_add_test (tc_chain, media_info_binary_4);
+  tcase_add_test (tc_chain, media_info_binary_5);
+  tcase_add_test (tc_chain, media_info_binary_xxh64);
 
   tcase_add_test (tc_chain, flow_aggregation_ok_ok_error_ok);
   tcase_add_test (tc_chain, flow_aggregation_eos_eos_eos_ok);
@@ -0,0 +1,79 @@
+/* GstValidate
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <glib/gstdio.h>
+#include <gst/validate/validate.h>
+
+GST_START_TEST (check_plugin_in_gst_plugin_path)
+{
+  GstPlugin *plugin;
+  GstValidateActionType *type;
+  gchar *tmpdir, *registry;
+
+  /* As if the directory was in GST_PLUGIN_PATH */
+  gst_registry_scan_path (gst_registry_get (), VALIDATE_FAULT_INJECTION_DIR);
+  plugin = gst_registry_find_plugin (gst_registry_get (),
+      "validatefaultinjection");
+  fail_unless (plugin != NULL);
+  gst_object_unref (plugin);
+
+  tmpdir = g_dir_make_tmp ("validate-plugins-XXXXXX", NULL);
+  fail_unless (tmpdir != NULL);
+  registry = g_build_filename (tmpdir, "validate-registry.bin", NULL);
+  fail_unless (g_setenv ("GST_VALIDATE_REGISTRY", registry, TRUE));
+  fail_unless (g_setenv ("GST_VALIDATE_PLUGIN_PATH",
+          VALIDATE_FAULT_INJECTION_DIR, TRUE));
+  g_unsetenv ("GST_VALIDATE_CONFIG");
+
+  gst_validate_init ();
+
+  /* Registered from the plugin_init function */
+  type = gst_validate_get_action_type ("corrupt-socket-recv");
+  fail_unless (type != NULL,
+      "The validate plugin was not loaded as it is a GStreamer plugin too");
+  gst_mini_object_unref (GST_MINI_OBJECT (type));
+
+  /* It now belongs to the validate registry */
+  plugin = gst_registry_find_plugin (gst_registry_get (),
+      "validatefaultinjection");
+  fail_unless (plugin == NULL);
+
+  gst_validate_deinit ();
+
+  g_unlink (registry);
+  g_rmdir (tmpdir);
+  g_free (registry);
+  g_free (tmpdir);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_validate_suite (void)
+{
+  Suite *s = suite_create ("plugins");
+  TCase *tc_chain = tcase_create ("plugins");
+  suite_add_tcase (s, tc_chain);
+
+  tcase_add_test (tc_chain, check_plugin_in_gst_plugin_path);
+
+  return s;
+}
+
+GST_CHECK_MAIN (gst_validate);
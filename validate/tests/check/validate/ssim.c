@@ -0,0 +1,225 @@
+/* GstValidate
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <glib/gstdio.h>
+#include "../../../gst-libs/gst/video/gssim.h"
+#include "../../../gst-libs/gst/video/gstvalidatessim.h"
+
+#define SSIM_TOLERANCE 1e-3
+
+static void
+_fill_planes (guint8 * org, guint8 * mod, gint width, gint height)
+{
+  gint x, y;
+  GRand *rand = g_rand_new_with_seed (42);
+
+  for (y = 0; y < height; y++) {
+    for (x = 0; x < width; x++) {
+      gint v = (x * 3 + y * 5 + g_rand_int_range (rand, 0, 40)) & 0xff;
+
+      org[y * width + x] = v;
+      mod[y * width + x] = CLAMP (v + g_rand_int_range (rand, -10, 11), 0,
+          255);
+    }
+  }
+
+  g_rand_free (rand);
+}
+
+static void
+_check_engines (gint width, gint height)
+{
+  Gssim *ssim = gssim_new ();
+  guint8 *org = g_malloc (width * height);
+  guint8 *mod = g_malloc (width * height);
+  guint8 *ref_out = g_malloc (width * height);
+  guint8 *out = g_malloc (width * height);
+  gfloat ref_mean, ref_lowest, ref_highest;
+  GssimEngine engines[] = { GSSIM_ENGINE_SCALAR, GSSIM_ENGINE_SSE4_1,
+    GSSIM_ENGINE_AVX2, GSSIM_ENGINE_AUTO
+  };
+  guint i;
+  gint j;
+
+  _fill_planes (org, mod, width, height);
+  gssim_configure (ssim, width, height);
+
+  fail_unless (gssim_set_engine (ssim, GSSIM_ENGINE_REFERENCE));
+  gssim_compare (ssim, org, mod, ref_out, &ref_mean, &ref_lowest,
+      &ref_highest);
+
+  for (i = 0; i < G_N_ELEMENTS (engines); i++) {
+    gfloat mean, lowest, highest;
+
+    /* SIMD engines are not available on every CPU */
+    if (!gssim_set_engine (ssim, engines[i]))
+      continue;
+
+    fail_if (gssim_get_engine (ssim) == GSSIM_ENGINE_AUTO);
+    gssim_compare (ssim, org, mod, out, &mean, &lowest, &highest);
+
+    fail_unless (ABS (ref_mean - mean) < SSIM_TOLERANCE,
+        "%dx%d engine %d: mean %f != %f", width, height, engines[i], mean,
+        ref_mean);
+    fail_unless (ABS (ref_lowest - lowest) < SSIM_TOLERANCE,
+        "%dx%d engine %d: lowest %f != %f", width, height, engines[i], lowest,
+        ref_lowest);
+    fail_unless (ABS (ref_highest - highest) < SSIM_TOLERANCE,
+        "%dx%d engine %d: highest %f != %f", width, height, engines[i],
+        highest, ref_highest);
+
+    for (j = 0; j < width * height; j++)
+      fail_unless (ABS (ref_out[j] - out[j]) <= 1,
+          "%dx%d engine %d: pixel %d is %d instead of %d", width, height,
+          engines[i], j, out[j], ref_out[j]);
+  }
+
+  g_free (org);
+  g_free (mod);
+  g_free (ref_out);
+  g_free (out);
+  gst_object_unref (ssim);
+}
+
+GST_START_TEST (check_engines_match_reference)
+{
+  /* Odd sizes so that the vectorised kernels have tails to handle */
+  _check_engines (67, 45);
+  _check_engines (320, 240);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (check_engines_match_reference_small)
+{
+  /* Smaller than the window, every position is clipped */
+  _check_engines (5, 3);
+  _check_engines (12, 11);
+}
+
+GST_END_TEST;
+
+#define N_FRAMES 8
+#define FRAME_SIZE 32
+
+static gchar *
+_write_frame (const gchar * dir, gint i, gboolean inverted)
+{
+  gint j;
+  gchar *name, *path;
+  guint8 data[FRAME_SIZE * FRAME_SIZE];
+
+  for (j = 0; j < FRAME_SIZE * FRAME_SIZE; j++) {
+    data[j] = (j * 7 + i * 13) & 0xff;
+    if (inverted)
+      data[j] = 0xff - data[j];
+  }
+
+  name = g_strdup_printf ("%02d.%dx%d.GRAY8", i, FRAME_SIZE, FRAME_SIZE);
+  path = g_build_filename (dir, name, NULL);
+  fail_unless (g_file_set_contents (path, (gchar *) data, sizeof (data),
+          NULL));
+  g_free (name);
+
+  return path;
+}
+
+/* Compares @ref_dir with @dir using @jobs jobs and returns the message of
+ * the only report the runner got */
+static gchar *
+_compare_directories (const gchar * ref_dir, const gchar * dir, guint jobs)
+{
+  gfloat mean, lowest, highest;
+  GList *reports;
+  GstValidateReport *report;
+  gchar *message;
+  GstValidateRunner *runner = gst_validate_runner_new ();
+  GstValidateSsim *ssim = gst_validate_ssim_new (runner, 0.95, 0.0);
+
+  gst_validate_ssim_set_jobs (ssim, jobs);
+  fail_if (gst_validate_ssim_compare_image_files (ssim, ref_dir, dir, &mean,
+          &lowest, &highest, NULL));
+
+  /* Repeated issues are only reported once, whatever the number of jobs */
+  reports = gst_validate_runner_get_reports (runner);
+  fail_unless_equals_int (g_list_length (reports), 1);
+  report = reports->data;
+  fail_unless (report->issue->issue_id ==
+      g_quark_from_string ("ssim::image-not-similar-enough"));
+  fail_unless_equals_int (report->level, GST_VALIDATE_REPORT_LEVEL_CRITICAL);
+  fail_unless (report->reporter == GST_VALIDATE_REPORTER (ssim));
+  fail_unless_equals_int (gst_validate_reporter_get_reports_count
+      (GST_VALIDATE_REPORTER (ssim)), 1);
+  message = g_strdup (report->message);
+
+  g_list_free_full (reports, (GDestroyNotify) gst_validate_report_unref);
+  gst_object_unref (ssim);
+  gst_object_unref (runner);
+
+  return message;
+}
+
+GST_START_TEST (check_parallel_directories)
+{
+  gint i;
+  gchar *message, *parallel_message;
+  GList *files = NULL;
+  gchar *ref_dir = g_dir_make_tmp ("validate-ssim-ref-XXXXXX", NULL);
+  gchar *dir = g_dir_make_tmp ("validate-ssim-XXXXXX", NULL);
+
+  fail_unless (ref_dir && dir);
+  for (i = 0; i < N_FRAMES; i++) {
+    files = g_list_prepend (files, _write_frame (ref_dir, i, FALSE));
+    files = g_list_prepend (files, _write_frame (dir, i, i % 3 == 1));
+  }
+
+  message = _compare_directories (ref_dir, dir, 1);
+  parallel_message = _compare_directories (ref_dir, dir, 4);
+
+  /* The first failing frame gets reported in both cases */
+  fail_unless (g_strrstr (message, "01.32x32.GRAY8") != NULL, "%s", message);
+  fail_unless_equals_string (parallel_message, message);
+
+  g_free (message);
+  g_free (parallel_message);
+  g_list_foreach (files, (GFunc) g_unlink, NULL);
+  g_list_free_full (files, g_free);
+  g_rmdir (ref_dir);
+  g_rmdir (dir);
+  g_free (ref_dir);
+  g_free (dir);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_validate_suite (void)
+{
+  Suite *s = suite_create ("ssim");
+  TCase *tc_chain = tcase_create ("ssim");
+  suite_add_tcase (s, tc_chain);
+
+  tcase_add_test (tc_chain, check_engines_match_reference);
+  tcase_add_test (tc_chain, check_engines_match_reference_small);
+  tcase_add_test (tc_chain, check_parallel_directories);
+
+  return s;
+}
+
+GST_CHECK_MAIN (gst_validate);
@@ -0,0 +1,172 @@
+/* GstValidate
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/validate/validate.h>
+#include <gst/validate/gst-validate-utils.h>
+#include <gst/check/gstcheck.h>
+
+typedef struct
+{
+  gdouble position;
+  gint position_lookups;
+  gint duration_lookups;
+} Variables;
+
+static int
+_get_variable (const gchar * name, double *value, gpointer user_data)
+{
+  Variables *variables = user_data;
+
+  if (!g_strcmp0 (name, "position")) {
+    variables->position_lookups++;
+    *value = variables->position;
+
+    return TRUE;
+  } else if (!g_strcmp0 (name, "duration")) {
+    variables->duration_lookups++;
+    *value = 10.0;
+
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+GST_START_TEST (test_expression_compile_once)
+{
+  gint i;
+  gchar *error = NULL;
+  Variables variables = { 0, };
+  GstValidateExpression *expression =
+      gst_validate_expression_compile ("max(position * 2, 1) - 2 ^ 3 ^ 2 / 64",
+      &error);
+
+  fail_unless (expression != NULL);
+  fail_unless (error == NULL);
+
+  for (i = 0; i < 100; i++) {
+    variables.position = i;
+    fail_unless_equals_float (gst_validate_expression_evaluate (expression,
+            _get_variable, &variables, &error), MAX (i * 2, 1) - 8);
+    fail_unless (error == NULL);
+  }
+  fail_unless_equals_int (variables.position_lookups, 100);
+
+  gst_validate_expression_free (expression);
+
+  /* Constant expressions do not need any variable function */
+  expression = gst_validate_expression_compile ("-(2 + 3) * 4", NULL);
+  fail_unless (expression != NULL);
+  fail_unless_equals_float (gst_validate_expression_evaluate (expression,
+          NULL, NULL, NULL), -20);
+  gst_validate_expression_free (expression);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_expression_variables_looked_up_once)
+{
+  Variables variables = { 3.5, };
+  GstValidateExpression *expression =
+      gst_validate_expression_compile
+      ("position + position * duration - duration / 2 + min(position, 1)",
+      NULL);
+
+  fail_unless (expression != NULL);
+  fail_unless_equals_float (gst_validate_expression_evaluate (expression,
+          _get_variable, &variables, NULL), 34.5);
+  fail_unless_equals_int (variables.position_lookups, 1);
+  fail_unless_equals_int (variables.duration_lookups, 1);
+
+  /* Values are not kept between evaluations */
+  variables.position = 1;
+  fail_unless_equals_float (gst_validate_expression_evaluate (expression,
+          _get_variable, &variables, NULL), 7.0);
+  fail_unless_equals_int (variables.position_lookups, 2);
+  fail_unless_equals_int (variables.duration_lookups, 2);
+
+  gst_validate_expression_free (expression);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_expression_unknown_variable)
+{
+  gchar *error = NULL;
+  Variables variables = { 0, };
+  GstValidateExpression *expression =
+      gst_validate_expression_compile ("position + unknown", &error);
+
+  /* Variables are only looked up when evaluating */
+  fail_unless (expression != NULL);
+  fail_unless (error == NULL);
+
+  fail_unless_equals_float (gst_validate_expression_evaluate (expression,
+          _get_variable, &variables, &error), -1.0);
+  fail_unless (error != NULL);
+  fail_unless (strstr (error, "unknown") != NULL, "%s", error);
+  g_free (error);
+
+  fail_unless_equals_float (gst_validate_expression_evaluate (expression,
+          NULL, NULL, &error), -1.0);
+  fail_unless (error != NULL);
+  g_free (error);
+
+  gst_validate_expression_free (expression);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_expression_malformed)
+{
+  guint i;
+  const gchar *malformed[] = { "", "1 +", "(1", "min(1)", "2 * * 3",
+    "unknown_function(1, 2)"
+  };
+
+  for (i = 0; i < G_N_ELEMENTS (malformed); i++) {
+    gchar *error = NULL;
+
+    fail_unless (gst_validate_expression_compile (malformed[i],
+            &error) == NULL, "'%s' compiled", malformed[i]);
+    fail_unless (error != NULL, "No error for '%s'", malformed[i]);
+    g_free (error);
+
+    /* The error is optional */
+    fail_unless (gst_validate_expression_compile (malformed[i], NULL) == NULL);
+  }
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_validate_suite (void)
+{
+  Suite *s = suite_create ("utils");
+  TCase *tc_chain = tcase_create ("expressions");
+  suite_add_tcase (s, tc_chain);
+
+  tcase_add_test (tc_chain, test_expression_compile_once);
+  tcase_add_test (tc_chain, test_expression_variables_looked_up_once);
+  tcase_add_test (tc_chain, test_expression_unknown_variable);
+  tcase_add_test (tc_chain, test_expression_malformed);
+
+  return s;
+}
+
+GST_CHECK_MAIN (gst_validate);
@@ -38,6 +38,7 @@ main (int argc, char **argv)
   gchar *outfolder = NULL;
   gfloat mssim = 0, lowest = 1, highest = -1;
   gdouble min_avg_similarity = 0.95, min_lowest_similarity = -1.0;
+  gint jobs = 1;
 
   GOptionEntry options[] = {
     {"min-avg-similarity", 'a', 0, G_OPTION_ARG_DOUBLE,
@@ -57,6 +58,10 @@ main (int argc, char **argv)
           " images with the structural difference between"
           " the reference frame and the failed one",
         NULL},
+    {"jobs", 'j', 0, G_OPTION_ARG_INT, &jobs,
+          "The number of frames to compare in parallel when comparing"
+          " directories, 0 means as many as there are processors",
+        NULL},
     {NULL}
   };
 
@@ -79,7 +84,7 @@ main (int argc, char **argv)
     return -1;
   }
 
-  if (argc != 3) {
+  if (argc != 3 || jobs < 0) {
     gchar *help = g_option_context_get_help (ctx, FALSE, NULL);
     g_printerr ("%s", help);
     g_free (help);
@@ -94,6 +99,7 @@ main (int argc, char **argv)
   runner = gst_validate_runner_new ();
   ssim =
       gst_validate_ssim_new (runner, min_avg_similarity, min_lowest_similarity);
+  gst_validate_ssim_set_jobs (ssim, jobs);
 
   gst_validate_ssim_compare_image_files (ssim, argv[1], argv[2], &mssim,
       &lowest, &highest, outfolder);
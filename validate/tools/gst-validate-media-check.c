@@ -45,7 +45,10 @@ main (int argc, gchar ** argv)
   GError *err = NULL;
   gboolean full = FALSE;
   gboolean skip_parsers = FALSE;
+  gboolean fast_checksum = FALSE;
+  gboolean binary = FALSE;
   gchar *output_file = NULL;
+  gchar *convert_file = NULL;
   gchar *expected_file = NULL;
   gchar *output = NULL;
   GstValidateMediaDescriptorWriterFlags writer_flags =
@@ -68,6 +71,18 @@ main (int argc, gchar ** argv)
     {"skip-parsers", 's', 0, G_OPTION_ARG_NONE,
           &skip_parsers, "Do not plug a parser after demuxer.",
         NULL},
+    {"fast-checksum", 0, 0, G_OPTION_ARG_NONE,
+          &fast_checksum, "Use a fast non cryptographic hash (xxHash64) "
+          "instead of MD5 for the frames checksums",
+        NULL},
+    {"binary", 'b', 0, G_OPTION_ARG_NONE,
+          &binary, "Write the output file in the binary format, "
+          "a lot faster to load than XML",
+        NULL},
+    {"convert", 0, 0, G_OPTION_ARG_FILENAME,
+          &convert_file, "Convert the given media info file to the binary "
+          "format, in place unless an output file is set, no URI is needed",
+        NULL},
     {NULL}
   };
 
@@ -92,6 +107,22 @@ main (int argc, gchar ** argv)
   gst_init (&argc, &argv);
   gst_validate_init ();
 
+  if (convert_file) {
+    g_option_context_free (ctx);
+    reference =
+        gst_validate_media_descriptor_parser_new (NULL, convert_file, &err);
+
+    if (reference == NULL || !gst_validate_media_descriptor_write_binary (
+            (GstValidateMediaDescriptor *) reference,
+            output_file ? output_file : convert_file, &err)) {
+      g_print ("Could not convert %s: %s\n", convert_file,
+          err ? err->message : "unknown error");
+      g_clear_error (&err);
+      ret = 1;
+    }
+    goto out;
+  }
+
   if (argc != 2) {
     gchar *msg = g_option_context_get_help (ctx, TRUE, NULL);
     g_printerr ("%s\n", msg);
@@ -120,6 +151,10 @@ main (int argc, gchar ** argv)
             (GstValidateMediaDescriptor *)
             reference))
       full = TRUE;              /* Reference has frame info, activate to do comparison */
+
+    /* Generate checksums comparable with the reference ones */
+    fast_checksum = ((GstValidateMediaDescriptor *) reference)->
+        filenode->checksum_type == GST_VALIDATE_MEDIA_CHECKSUM_XXH64;
   }
 
   if (full)
@@ -128,6 +163,9 @@ main (int argc, gchar ** argv)
   if (skip_parsers)
     writer_flags |= GST_VALIDATE_MEDIA_DESCRIPTOR_WRITER_FLAGS_NO_PARSER;
 
+  if (fast_checksum)
+    writer_flags |= GST_VALIDATE_MEDIA_DESCRIPTOR_WRITER_FLAGS_FAST_CHECKSUM;
+
 
   writer =
       gst_validate_media_descriptor_writer_new_discover (runner, argv[1],
@@ -139,7 +177,14 @@ main (int argc, gchar ** argv)
   }
 
   if (output_file) {
-    if (!gst_validate_media_descriptor_writer_write (writer, output_file)) {
+    if (binary) {
+      if (!gst_validate_media_descriptor_write_binary (
+              (GstValidateMediaDescriptor *) writer, output_file, NULL)) {
+        ret = 1;
+        goto out;
+      }
+    } else if (!gst_validate_media_descriptor_writer_write (writer,
+            output_file)) {
       ret = 1;
       goto out;
     }
@@ -163,6 +208,7 @@ out:
 
   g_free (output_file);
   g_free (expected_file);
+  g_free (convert_file);
 
   if (reference) {
     gst_validate_reporter_purge_reports (GST_VALIDATE_REPORTER (reference));
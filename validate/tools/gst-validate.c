@@ -39,6 +39,9 @@
 
 #ifdef G_OS_UNIX
 #include <glib-unix.h>
+#include <glib/gstdio.h>
+#include <fcntl.h>
+#include <unistd.h>
 #endif
 #include <locale.h>             /* for LC_ALL */
 
@@ -278,6 +281,13 @@ _execute_set_subtitles (GstValidateScenario * scenario,
 static void
 _register_playbin_actions (void)
 {
+  static gboolean registered = FALSE;
+
+  /* Workers run several playbin pipelines */
+  if (registered)
+    return;
+  registered = TRUE;
+
 /* *INDENT-OFF* */
   gst_validate_register_action_type ("set-subtitle", "validate-launcher", _execute_set_subtitles,
       (GstValidateActionParameter []) {
@@ -301,8 +311,15 @@ _register_playbin_actions (void)
 /* *INDENT-ON* */
 }
 
-int
-main (int argc, gchar ** argv)
+#ifdef G_OS_UNIX
+static int run_worker (void);
+#endif
+
+/* Runs the test described by the command line arguments in @argv. In
+ * worker mode, GStreamer is already initialized and this is called for
+ * each test */
+static int
+run_test (int argc, gchar ** argv, gboolean in_worker)
 {
   GError *err = NULL;
   gchar *scenario = NULL, *configs = NULL, *media_info = NULL,
@@ -315,6 +332,7 @@ main (int argc, gchar ** argv)
 
 #ifdef G_OS_UNIX
   guint signal_watch_id;
+  gboolean worker = FALSE;
 #endif
   int rep_err;
 
@@ -346,6 +364,17 @@ main (int argc, gchar ** argv)
           " description). Specify multiple ones using ':' as separator."
           " This option overrides the GST_VALIDATE_SCENARIO environment variable.",
         NULL},
+#ifdef G_OS_UNIX
+    {"worker", '\0', 0, G_OPTION_ARG_NONE, &worker,
+          "Run the tests described on the standard input one after the other,"
+          " one per line, as used by gst-validate-launcher."
+          " Lines are shell quoted 'UUID LOGFILE ARGUMENTS' where ARGUMENTS"
+          " are the usual gst-validate arguments and LOGFILE is the file where"
+          " the test output goes, '-' meaning stderr. All the tests run with"
+          " the environment of the worker."
+          " 'done UUID RETURN-VALUE' is printed once a test is over.",
+        NULL},
+#endif
     {NULL}
   };
   GOptionContext *ctx;
@@ -354,9 +383,10 @@ main (int argc, gchar ** argv)
   GstValidateMonitor *monitor;
   GstBus *bus;
 
-  setlocale (LC_ALL, "");
+  ret = 0;
+  buffering = FALSE;
+  is_live = FALSE;
 
-  g_set_prgname ("gst-validate-" GST_API_VERSION);
   ctx = g_option_context_new ("PIPELINE-DESCRIPTION");
   g_option_context_add_main_entries (ctx, options, NULL);
   g_option_context_set_summary (ctx, "Runs a gst launch pipeline, adding "
@@ -367,16 +397,31 @@ main (int argc, gchar ** argv)
 
   if (argc == 1) {
     g_print ("%s", g_option_context_get_help (ctx, FALSE, NULL));
-    exit (1);
+    g_option_context_free (ctx);
+    return 1;
   }
 
   if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
     g_printerr ("Error initializing: %s\n", err->message);
     g_option_context_free (ctx);
     g_clear_error (&err);
-    exit (1);
+    return 1;
   }
 
+#ifdef G_OS_UNIX
+  if (worker && !in_worker) {
+    g_option_context_free (ctx);
+    gst_init (&argc, &argv);
+    gst_validate_init ();
+
+    ret = run_worker ();
+
+    gst_validate_deinit ();
+    gst_deinit ();
+    return ret;
+  }
+#endif
+
   if (scenario || configs) {
     gchar *scenarios;
 
@@ -385,14 +430,21 @@ main (int argc, gchar ** argv)
     else
       scenarios = g_strdup (configs);
 
-    g_setenv ("GST_VALIDATE_SCENARIO", scenarios, TRUE);
+    /* The environment can't be safely modified once GstValidate threads
+     * are running */
+    if (in_worker)
+      gst_validate_set_scenarios (scenarios);
+    else
+      g_setenv ("GST_VALIDATE_SCENARIO", scenarios, TRUE);
     g_free (scenarios);
     g_free (scenario);
     g_free (configs);
   }
 
-  gst_init (&argc, &argv);
-  gst_validate_init ();
+  if (!in_worker) {
+    gst_init (&argc, &argv);
+    gst_validate_init ();
+  }
 
   if (list_scenarios || output_file) {
     if (gst_validate_list_scenarios (argv + 1, argc - 1, output_file))
@@ -414,7 +466,7 @@ main (int argc, gchar ** argv)
   if (argc == 1) {
     g_print ("%s", g_option_context_get_help (ctx, FALSE, NULL));
     g_option_context_free (ctx);
-    exit (1);
+    return 1;
   }
 
   g_option_context_free (ctx);
@@ -422,7 +474,7 @@ main (int argc, gchar ** argv)
   runner = gst_validate_runner_new ();
   if (!runner) {
     g_printerr ("Failed to setup Validate Runner\n");
-    exit (1);
+    return 1;
   }
 
   /* Create the pipeline */
@@ -436,7 +488,7 @@ main (int argc, gchar ** argv)
     g_clear_error (&err);
     g_object_unref (runner);
 
-    exit (1);
+    return 1;
   } else if (err) {
     g_printerr ("Erroneous pipeline: %s\n",
         err->message ? err->message : "unknown reason");
@@ -478,7 +530,7 @@ main (int argc, gchar ** argv)
           media_info, err ? err->message : "Unknown error");
 
       g_free (media_info);
-      exit (1);
+      return 1;
     }
 
     gst_validate_monitor_set_media_descriptor (monitor,
@@ -551,7 +603,125 @@ exit:
   g_print ("\n=======> Test %s (Return value: %i)\n\n",
       ret == 0 ? "PASSED" : "FAILED", ret);
 
-  gst_validate_deinit ();
-  gst_deinit ();
+  if (!in_worker) {
+    gst_validate_deinit ();
+    gst_deinit ();
+  }
+
   return ret;
 }
+
+#ifdef G_OS_UNIX
+/* Runs the test described by a worker line, see the --worker option */
+static int
+run_worker_test (gint nargs, gchar ** args)
+{
+  gint i, res, fd, stdout_fd, stderr_fd;
+  gchar **test_argv;
+  gint test_argc = 0;
+  const gchar *uuid, *logfile;
+
+  if (nargs < 3) {
+    g_printerr ("Invalid test description\n");
+    return 1;
+  }
+
+  uuid = args[0];
+  logfile = args[1];
+
+  test_argv = g_new0 (gchar *, nargs);
+  test_argv[test_argc++] = (gchar *) g_get_prgname ();
+  for (i = 2; i < nargs; i++)
+    test_argv[test_argc++] = args[i];
+
+  fflush (stdout);
+  fflush (stderr);
+  if (g_strcmp0 (logfile, "-"))
+    fd = g_open (logfile, O_WRONLY | O_CREAT | O_APPEND, 0666);
+  else
+    fd = dup (STDERR_FILENO);
+  stdout_fd = dup (STDOUT_FILENO);
+  stderr_fd = dup (STDERR_FILENO);
+  if (fd >= 0) {
+    dup2 (fd, STDOUT_FILENO);
+    dup2 (fd, STDERR_FILENO);
+    close (fd);
+  }
+
+  gst_validate_report_start_test (uuid);
+  res = run_test (test_argc, test_argv, TRUE);
+  /* The next test may not set any scenario */
+  gst_validate_set_scenarios (NULL);
+
+  /* Everything printed during the test goes to its log */
+  gst_validate_printf_flush ();
+  fflush (stdout);
+  fflush (stderr);
+  dup2 (stdout_fd, STDOUT_FILENO);
+  dup2 (stderr_fd, STDERR_FILENO);
+  close (stdout_fd);
+  close (stderr_fd);
+
+  g_free (test_argv);
+
+  return res;
+}
+
+static int
+run_worker (void)
+{
+  gchar *line;
+  FILE *control;
+  GError *err = NULL;
+  GIOChannel *input = g_io_channel_unix_new (STDIN_FILENO);
+
+  /* Tests output is redirected, keep the original stdout to report the
+   * tests results */
+  control = fdopen (dup (STDOUT_FILENO), "w");
+  /* Paths and arguments are not necessarily UTF-8 */
+  g_io_channel_set_encoding (input, NULL, NULL);
+
+  while (g_io_channel_read_line (input, &line, NULL, NULL,
+          &err) == G_IO_STATUS_NORMAL) {
+    gint nargs, res;
+    gchar **args;
+
+    g_strchomp (line);
+
+    if (!g_shell_parse_argv (line, &nargs, &args, &err)) {
+      g_printerr ("Could not parse test description '%s': %s\n", line,
+          err->message);
+      g_clear_error (&err);
+      g_free (line);
+      continue;
+    }
+
+    res = run_worker_test (nargs, args);
+    fprintf (control, "done %s %d\n", args[0], res);
+    fflush (control);
+
+    g_strfreev (args);
+    g_free (line);
+  }
+
+  if (err) {
+    g_printerr ("Could not read test description: %s\n", err->message);
+    g_clear_error (&err);
+  }
+
+  fclose (control);
+  g_io_channel_unref (input);
+
+  return 0;
+}
+#endif
+
+int
+main (int argc, gchar ** argv)
+{
+  setlocale (LC_ALL, "");
+
+  g_set_prgname ("gst-validate-" GST_API_VERSION);
+
+  return run_test (argc, argv, FALSE);
+}